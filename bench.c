@@ -0,0 +1,560 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "leptjson.h"
+
+/* 生成确定的测试数据: 同样的记录分别以缩进和紧凑两种格式输出, 比较空白对解析速度的影响 */
+
+typedef struct {
+    char *s;
+    size_t len, cap;
+} buffer;
+
+static void buffer_put(buffer *b, const char *s, size_t len) {
+
+    if (b->len + len + 1 > b->cap) {
+        while (b->len + len + 1 > b->cap)
+            b->cap = b->cap ? b->cap + (b->cap >> 1) : 4096;
+        b->s = (char *) realloc(b->s, b->cap);
+    }
+    memcpy(b->s + b->len, s, len);
+    b->len += len;
+    b->s[b->len] = '\0';
+}
+
+#define PUTS(b, s) buffer_put(b, s, strlen(s))
+
+static void newline(buffer *b, int indent, int depth) {
+
+    if (indent == 0)
+        return;
+    buffer_put(b, "\n", 1);
+    for (int i = 0; i < indent * depth; i++)
+        buffer_put(b, " ", 1);
+}
+
+static void key(buffer *b, int indent, int depth, const char *k, int first) {
+
+    if (!first)
+        PUTS(b, ",");
+    newline(b, indent, depth);
+    PUTS(b, "\"");
+    PUTS(b, k);
+    PUTS(b, indent ? "\": " : "\":");
+}
+
+static void record(buffer *b, int indent, int depth, unsigned i) {
+
+    char tmp[64];
+    PUTS(b, "{");
+    key(b, indent, depth + 1, "id", 1);
+    sprintf(tmp, "%u", i);
+    PUTS(b, tmp);
+    key(b, indent, depth + 1, "name", 0);
+    sprintf(tmp, "\"user_%u\"", i * 2654435761u % 100000);
+    PUTS(b, tmp);
+    key(b, indent, depth + 1, "score", 0);
+    sprintf(tmp, "%u.%02u", i % 1000, i % 100);
+    PUTS(b, tmp);
+    key(b, indent, depth + 1, "active", 0);
+    PUTS(b, i % 3 ? "true" : "false");
+    key(b, indent, depth + 1, "tags", 0);
+    PUTS(b, "[");
+    for (unsigned t = 0; t < 3; t++) {
+        if (t)
+            PUTS(b, ",");
+        newline(b, indent, depth + 2);
+        sprintf(tmp, "\"tag%u\"", (i + t) % 17);
+        PUTS(b, tmp);
+    }
+    newline(b, indent, depth + 1);
+    PUTS(b, "]");
+    key(b, indent, depth + 1, "address", 0);
+    PUTS(b, "{");
+    key(b, indent, depth + 2, "city", 1);
+    PUTS(b, "\"Springfield\"");
+    key(b, indent, depth + 2, "zip", 0);
+    sprintf(tmp, "\"%05u\"", i % 99991);
+    PUTS(b, tmp);
+    newline(b, indent, depth + 1);
+    PUTS(b, "}");
+    newline(b, indent, depth);
+    PUTS(b, "}");
+}
+
+/* NDJSON: 每行一条紧凑的记录 */
+static void generate_lines(buffer *b, unsigned count) {
+
+    for (unsigned i = 0; i < count; i++) {
+        record(b, 0, 0, i);
+        PUTS(b, "\n");
+    }
+}
+
+/* 日志: 字符串很长, 偶尔有需要转义的字符 */
+static void generate_text(buffer *b, unsigned count) {
+
+    char tmp[64];
+    PUTS(b, "[");
+    for (unsigned i = 0; i < count; i++) {
+        PUTS(b, i ? ",{\"level\":\"info\",\"msg\":\"" : "{\"level\":\"info\",\"msg\":\"");
+        sprintf(tmp, "request %u served from cache in %u us", i, i * 7 % 1000);
+        PUTS(b, tmp);
+        PUTS(b, " by worker pool; upstream returned \\\"ok\\\" after retry with backoff policy default\\n");
+        PUTS(b, "\"}");
+    }
+    PUTS(b, "]");
+}
+
+static void generate(buffer *b, int indent, unsigned count) {
+
+    PUTS(b, "[");
+    for (unsigned i = 0; i < count; i++) {
+        if (i)
+            PUTS(b, ",");
+        newline(b, indent, 1);
+        record(b, indent, 1, i);
+    }
+    newline(b, indent, 0);
+    PUTS(b, "]");
+}
+
+/* 地理数据: 几乎全是带小数的坐标 */
+static void generate_geo(buffer *b, unsigned count) {
+
+    char tmp[64];
+    unsigned seed = 12345;
+    PUTS(b, "{\"type\":\"FeatureCollection\",\"features\":[");
+    for (unsigned i = 0; i < count; i++) {
+        PUTS(b, i ? ",{\"type\":\"Feature\",\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[["
+                  : "{\"type\":\"Feature\",\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[[");
+        for (unsigned j = 0; j < 32; j++) {
+            seed = seed * 1103515245u + 12345u;
+            sprintf(tmp, j ? ",[%.7f,%.7f]" : "[%.7f,%.7f]",
+                    -180.0 + (seed >> 8) % 3600000 * 1e-4, -90.0 + (seed >> 4) % 1800000 * 1e-4);
+            PUTS(b, tmp);
+        }
+        sprintf(tmp, "]]},\"properties\":{\"id\":%u}}", i);
+        PUTS(b, tmp);
+    }
+    PUTS(b, "]}");
+}
+
+/* 深层嵌套: 数组和对象交替嵌套 depth 层 */
+static void generate_deep(buffer *b, unsigned count, unsigned depth) {
+
+    PUTS(b, "[");
+    for (unsigned i = 0; i < count; i++) {
+        if (i)
+            PUTS(b, ",");
+        for (unsigned d = 0; d < depth; d++)
+            PUTS(b, d % 2 ? "{\"a\":" : "[");
+        PUTS(b, "1");
+        for (unsigned d = depth; d-- > 0;)
+            PUTS(b, d % 2 ? "}" : "]");
+    }
+    PUTS(b, "]");
+}
+
+/* 宽对象: 每个对象有 width 个成员, 会建立哈希索引 */
+static void generate_wide(buffer *b, unsigned count, unsigned width) {
+
+    char tmp[64];
+    PUTS(b, "[");
+    for (unsigned i = 0; i < count; i++) {
+        PUTS(b, i ? ",{" : "{");
+        for (unsigned j = 0; j < width; j++) {
+            sprintf(tmp, j ? ",\"field_%u\":%u" : "\"field_%u\":%u", j, i ^ j);
+            PUTS(b, tmp);
+        }
+        PUTS(b, "}");
+    }
+    PUTS(b, "]");
+}
+
+static double now() {
+
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#define BENCH_SECONDS 0.5 //每项至少运行这么久
+
+typedef struct {
+    const char *name;
+    buffer b;
+} corpus;
+
+static int machine; //-m: 每行一项, 用制表符分隔, 方便在两次构建之间 diff
+static const char *filter; //只运行 "op/corpus" 包含这个子串的项
+
+static int selected(const char *op, const corpus *c) {
+
+    char name[64];
+    snprintf(name, sizeof(name), "%s/%s", op, c->name);
+    return filter == NULL || strstr(name, filter) != NULL;
+}
+
+/* MB/s 按 bytes 计算, 一般是 JSON 文本的长度 */
+static void report(const char *op, const corpus *c, size_t bytes, unsigned iterations, double elapsed) {
+
+    if (machine)
+        printf("%s\t%s\t%zu\t%u\t%.0f\t%.1f\n", op, c->name, bytes, iterations,
+               elapsed * 1e9 / iterations, bytes * (double) iterations / elapsed / 1e6);
+    else
+        printf("%-10s %-9s %10zu bytes %10.1f MB/s %12.0f ns/op\n", op, c->name, bytes,
+               bytes * (double) iterations / elapsed / 1e6, elapsed * 1e9 / iterations);
+    fflush(stdout);
+}
+
+static void parse(const corpus *c, lept_value *v) {
+
+    lept_init(v);
+    if (lept_parse_n(v, c->b.s, c->b.len) != LEPT_PARSE_OK) {
+        fprintf(stderr, "%s: parse error\n", c->name);
+        exit(1);
+    }
+}
+
+/* threads 为 1 时是 lept_parse_n */
+static void bench_parse(const char *op, const corpus *c, unsigned threads) {
+
+    lept_value v;
+    unsigned iterations = 0;
+    double start = now(), elapsed;
+    if (!selected(op, c))
+        return;
+    do {
+        lept_init(&v);
+        if (lept_parse_parallel(&v, c->b.s, c->b.len, threads) != LEPT_PARSE_OK) {
+            fprintf(stderr, "%s: parse error\n", c->name);
+            exit(1);
+        }
+        lept_free(&v);
+        iterations++;
+    } while ((elapsed = now() - start) < BENCH_SECONDS);
+    report(op, c, c->b.len, iterations, elapsed);
+}
+
+/* 同一个工作区反复解析和 stringify, 和 parse + stringify 的普通调用比较 */
+static void bench_workspace(const char *op, const corpus *c) {
+
+    lept_workspace *w;
+    lept_value v;
+    const char *json;
+    size_t length;
+    unsigned iterations = 0;
+    double start = now(), elapsed;
+    if (!selected(op, c))
+        return;
+    w = lept_workspace_new(0, 0);
+    do {
+        if (lept_workspace_parse(w, &v, c->b.s, c->b.len) != LEPT_PARSE_OK) {
+            fprintf(stderr, "%s: parse error\n", c->name);
+            exit(1);
+        }
+        lept_workspace_stringify(w, &v, &json, &length);
+        lept_free(&v);
+        iterations++;
+    } while ((elapsed = now() - start) < BENCH_SECONDS);
+    report(op, c, c->b.len, iterations, elapsed);
+    lept_workspace_free(w);
+}
+
+static void bench_roundtrip(const char *op, const corpus *c) {
+
+    lept_value v;
+    char *json;
+    size_t length;
+    unsigned iterations = 0;
+    double start = now(), elapsed;
+    if (!selected(op, c))
+        return;
+    do {
+        parse(c, &v);
+        lept_stringify(&v, &json, &length);
+        free(json);
+        lept_free(&v);
+        iterations++;
+    } while ((elapsed = now() - start) < BENCH_SECONDS);
+    report(op, c, c->b.len, iterations, elapsed);
+}
+
+/* 只计 lept_free 的时间 */
+static void bench_free(const char *op, const corpus *c) {
+
+    lept_value v;
+    unsigned iterations = 0;
+    double start = now(), elapsed = 0.0, t;
+    if (!selected(op, c))
+        return;
+    do {
+        parse(c, &v);
+        t = now();
+        lept_free(&v);
+        elapsed += now() - t;
+        iterations++;
+    } while (now() - start < BENCH_SECONDS);
+    report(op, c, c->b.len, iterations, elapsed);
+}
+
+/* 用访问函数遍历整棵树; find 为 1 时对象的每个成员都再按 key 查找一次 */
+static double walk(const lept_value *v, int find) {
+
+    double sum = 0.0;
+    size_t i, n;
+    switch (lept_get_type(v)) {
+        case LEPT_TRUE:
+            return 1.0;
+        case LEPT_NUMBER:
+            return lept_get_number(v);
+        case LEPT_STRING:
+            return (double) lept_get_string_length(v) + lept_get_string(v)[0];
+        case LEPT_ARRAY:
+            for (i = 0, n = lept_get_array_size(v); i < n; i++)
+                sum += walk(lept_get_array_element(v, i), find);
+            return sum;
+        case LEPT_OBJECT:
+            for (i = 0, n = lept_get_object_size(v); i < n; i++) {
+                const char *k = lept_get_object_key(v, i);
+                size_t klen = lept_get_object_key_length(v, i);
+                sum += walk(find ? lept_find_object_value(v, k, klen) : lept_get_object_value(v, i), find);
+            }
+            return sum;
+        default:
+            return 0.0;
+    }
+}
+
+static void bench_walk(const char *op, const corpus *c, int find) {
+
+    lept_value v;
+    double sum = 0.0;
+    unsigned iterations = 0;
+    double start, elapsed;
+    if (!selected(op, c))
+        return;
+    parse(c, &v);
+    start = now();
+    do {
+        sum += walk(&v, find);
+        iterations++;
+    } while ((elapsed = now() - start) < BENCH_SECONDS);
+    report(op, c, c->b.len, iterations, elapsed);
+    lept_free(&v);
+    if (sum < 0)
+        printf("%f\n", sum);
+}
+
+/* 延迟解析: 用编译好的 JSON Pointer 读取一条记录里的几个字段 */
+static void bench_lazy(const char *op, const corpus *c) {
+
+    static const char *const paths[] = { "/10000/score", "/10000/name", "/10000/tags/2" };
+    lept_pointer *ps[3];
+    lept_value *results[3];
+    lept_document d;
+    double sum = 0.0;
+    unsigned iterations = 0;
+    double start = now(), elapsed;
+    if (!selected(op, c))
+        return;
+    for (int i = 0; i < 3; i++)
+        ps[i] = lept_pointer_compile(paths[i], strlen(paths[i]));
+    lept_document_init(&d);
+    do {
+        if (lept_document_parse_lazy(&d, c->b.s, c->b.len) != LEPT_PARSE_OK) {
+            fprintf(stderr, "%s: parse error\n", c->name);
+            exit(1);
+        }
+        lept_pointer_get_all(ps, 3, &d.root, results);
+        sum += lept_get_number(results[0]);
+        sum += lept_get_string_length(results[1]) + lept_get_string_length(results[2]);
+        iterations++;
+    } while ((elapsed = now() - start) < BENCH_SECONDS);
+    lept_document_free(&d);
+    for (int i = 0; i < 3; i++)
+        lept_pointer_free(ps[i]);
+    report(op, c, c->b.len, iterations, elapsed);
+    if (sum < 0)
+        printf("%f\n", sum);
+}
+
+/* 从二进制编码重新加载, MB/s 按编码的长度计算 */
+static void bench_binary(const char *op, const corpus *c) {
+
+    lept_value v;
+    char *data;
+    size_t length;
+    unsigned iterations = 0;
+    double start, elapsed;
+    if (!selected(op, c))
+        return;
+    parse(c, &v);
+    lept_encode_binary(&v, &data, &length);
+    lept_free(&v);
+    start = now();
+    do {
+        if (lept_decode_binary(&v, data, length) != LEPT_PARSE_OK) {
+            fprintf(stderr, "%s: decode error\n", c->name);
+            exit(1);
+        }
+        lept_free(&v);
+        iterations++;
+    } while ((elapsed = now() - start) < BENCH_SECONDS);
+    report(op, c, length, iterations, elapsed);
+    free(data);
+}
+
+/* MB/s 按输出的长度计算 */
+static void bench_stringify(const char *op, const corpus *c) {
+
+    lept_value v;
+    char *json;
+    size_t length;
+    unsigned iterations = 0;
+    double start, elapsed;
+    if (!selected(op, c))
+        return;
+    parse(c, &v);
+    start = now();
+    do {
+        lept_stringify(&v, &json, &length);
+        free(json);
+        iterations++;
+    } while ((elapsed = now() - start) < BENCH_SECONDS);
+    report(op, c, length, iterations, elapsed);
+    lept_free(&v);
+}
+
+/* SAX: 只累加数字, 不构建树 */
+static int sum_number(void *user, double n) {
+
+    *(double *) user += n;
+    return 0;
+}
+
+static void bench_sax(const char *op, const corpus *c) {
+
+    lept_handler h = { NULL, NULL, sum_number, NULL, NULL, NULL, NULL, NULL, NULL };
+    double sum = 0.0;
+    unsigned iterations = 0;
+    double start = now(), elapsed;
+    if (!selected(op, c))
+        return;
+    do {
+        if (lept_sax_parse_n(&h, &sum, c->b.s, c->b.len) != LEPT_PARSE_OK) {
+            fprintf(stderr, "%s: parse error\n", c->name);
+            exit(1);
+        }
+        iterations++;
+    } while ((elapsed = now() - start) < BENCH_SECONDS);
+    report(op, c, c->b.len, iterations, elapsed);
+}
+
+/* 增量解析: 按 TCP 报文的大小分块输入 */
+static void bench_push(const char *op, const corpus *c, size_t chunk) {
+
+    lept_push_parser *p;
+    lept_value v;
+    unsigned iterations = 0;
+    double start = now(), elapsed;
+    if (!selected(op, c))
+        return;
+    p = lept_push_parser_new();
+    do {
+        for (size_t i = 0; i < c->b.len; i += chunk)
+            lept_push_parse(p, c->b.s + i, c->b.len - i < chunk ? c->b.len - i : chunk);
+        if (lept_push_finish(p, &v) != LEPT_PARSE_OK) {
+            fprintf(stderr, "%s: parse error\n", c->name);
+            exit(1);
+        }
+        lept_free(&v);
+        iterations++;
+    } while ((elapsed = now() - start) < BENCH_SECONDS);
+    report(op, c, c->b.len, iterations, elapsed);
+    lept_push_parser_free(p);
+}
+
+static void bench_ndjson(const char *op, const corpus *c, unsigned threads) {
+
+    lept_batch batch;
+    unsigned iterations = 0;
+    double start = now(), elapsed;
+    if (!selected(op, c))
+        return;
+    lept_batch_init(&batch);
+    do {
+        if (lept_parse_ndjson(&batch, c->b.s, c->b.len, threads) != LEPT_PARSE_OK) {
+            fprintf(stderr, "%s: parse error\n", c->name);
+            exit(1);
+        }
+        lept_batch_free(&batch);
+        iterations++;
+    } while ((elapsed = now() - start) < BENCH_SECONDS);
+    report(op, c, c->b.len, iterations, elapsed);
+}
+
+/* 用法: leptjson_bench [-m] [filter]
+ * 每个语料都测 parse, stringify, free 和两种遍历, 其他解析方式只在适合它的语料上测
+ */
+int main(int argc, char *argv[]) {
+
+    corpus corpora[] = {
+        { "minified", {NULL, 0, 0} },
+        { "pretty", {NULL, 0, 0} },
+        { "logs", {NULL, 0, 0} },
+        { "geo", {NULL, 0, 0} },
+        { "deep", {NULL, 0, 0} },
+        { "wide", {NULL, 0, 0} },
+        { "record", {NULL, 0, 0} },
+    };
+    corpus lines = { "lines", {NULL, 0, 0} };
+    const corpus *minified = &corpora[0];
+    size_t i, n = sizeof(corpora) / sizeof(corpora[0]);
+
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "-m") == 0)
+            machine = 1;
+        else
+            filter = argv[a];
+    }
+    generate(&corpora[0].b, 0, 20000);
+    generate(&corpora[1].b, 4, 20000);
+    generate_text(&corpora[2].b, 20000);
+    generate_geo(&corpora[3].b, 5000);
+    generate_deep(&corpora[4].b, 2000, 100);
+    generate_wide(&corpora[5].b, 100, 1000);
+    record(&corpora[6].b, 0, 0, 42); //一条很小的记录, 看每次调用的固定开销
+    generate_lines(&lines.b, 100000);
+    if (machine)
+        printf("op\tcorpus\tbytes\titerations\tns/op\tMB/s\n");
+
+    for (i = 0; i < n; i++)
+        bench_parse("parse", &corpora[i], 1);
+    for (i = 0; i < n; i++)
+        bench_stringify("stringify", &corpora[i]);
+    for (i = 0; i < n; i++)
+        bench_free("free", &corpora[i]);
+    for (i = 0; i < n; i++)
+        bench_walk("walk", &corpora[i], 0);
+    for (i = 0; i < n; i++)
+        bench_walk("find", &corpora[i], 1);
+    for (i = 0; i < n; i++)
+        bench_roundtrip("roundtrip", &corpora[i]);
+    for (i = 0; i < n; i++)
+        bench_workspace("workspace", &corpora[i]);
+    bench_parse("parallel", minified, 0);
+    bench_lazy("lazy", minified);
+    bench_binary("binary", minified);
+    bench_sax("sax", minified);
+    bench_push("push", minified, 1460);
+    bench_ndjson("ndjson-1", &lines, 1);
+    bench_ndjson("ndjson", &lines, 0);
+
+    for (i = 0; i < n; i++)
+        free(corpora[i].b.s);
+    free(lines.b.s);
+    return 0;
+}
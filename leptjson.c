@@ -1,10 +1,33 @@
 #include "leptjson.h"
 #include <assert.h>  // assert()
-#include <stdlib.h>  // NULL, strtod(), malloc(), realloc(), free()
-#include <math.h> // HUGEVAL
-#include <errno.h> // errno, ERANGE
+#include <stdlib.h>  // NULL, malloc(), realloc(), free()
+#include <float.h> // FLT_EVAL_METHOD
 #include <string.h>
 #include <stdio.h>
+#include <stdint.h>
+
+/* SIMD: x86 上 SSE2 是基线, AVX2 在运行时检测; 其他平台用 SWAR, 定义 LEPT_NO_SIMD 可以全部关掉 */
+#if !defined(LEPT_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define LEPT_SSE2 1
+#include <emmintrin.h>
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define LEPT_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+/* NDJSON 的并行解析用 pthreads, 定义 LEPT_NO_THREADS 时退化为单线程 */
+#if !defined(LEPT_NO_THREADS) && !defined(_WIN32)
+#define LEPT_THREADS 1
+#include <pthread.h>
+#endif
+#ifndef _WIN32
+#include <unistd.h> // sysconf(), write()
+#include <errno.h>
+#include <fcntl.h> // open()
+#include <sys/stat.h> // fstat()
+#include <sys/mman.h> // mmap(), madvise()
+#endif
 
 #ifndef LEPT_PARSE_STACK_INIT_SIZE
     #define LEPT_PARSE_STACK_INIT_SIZE 256
@@ -12,26 +35,155 @@
 #ifndef LEPT_PARSE_STRINGIFY_INIT_SIZE
 #define LEPT_PARSE_STRINGIFY_INIT_SIZE 256
 #endif
+#ifndef LEPT_STRINGIFY_BUFFER_SIZE
+#define LEPT_STRINGIFY_BUFFER_SIZE (64 * 1024) //流式输出时缓冲区的大小
+#endif
+#ifndef LEPT_INTERN_SHARDS
+#define LEPT_INTERN_SHARDS 16 //key 驻留表分成多少份, 每份一把锁; 必须是 2 的幂
+#endif
+#ifndef LEPT_OBJECT_INDEX_THRESHOLD
+#define LEPT_OBJECT_INDEX_THRESHOLD 16 //成员数达到这个值的对象在解析时建立哈希索引
+#endif
+#ifndef LEPT_SIZE_MAX
+#define LEPT_SIZE_MAX UINT32_MAX //字符串长度和数组/对象元素个数的上限, 超过时返回 LEPT_PARSE_TOO_LARGE; 可以设得更小, 不能更大
+#endif
+
+/* 统计: LEPT_STAT 里的语句只在定义 LEPT_STATS 时编译; LEPT_STAT_TIME 把 stmt 花的周期数加到 lept_stats 的 field 上 */
+#ifdef LEPT_STATS
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define LEPT_THREAD_LOCAL __declspec(thread)
+#define lept_cycles() __rdtsc()
+#else
+#define LEPT_THREAD_LOCAL _Thread_local
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define lept_cycles() __builtin_ia32_rdtsc()
+#else
+#include <time.h>
+static uint64_t lept_cycles(void) {
+
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+#endif
+#endif
+
+static LEPT_THREAD_LOCAL lept_stats lept_stats_current;
+static LEPT_THREAD_LOCAL size_t lept_stats_depth;
+
+const lept_stats *lept_get_stats(void) {
+
+    return &lept_stats_current;
+}
+
+static void lept_stats_reset(void) {
+
+    memset(&lept_stats_current, 0, sizeof(lept_stats_current));
+    lept_stats_depth = 0;
+}
+
+#define LEPT_STAT(stmt) do { stmt; } while(0)
+#define LEPT_STAT_TIME(field, stmt) \
+    do { \
+        uint64_t lept_t0_ = lept_cycles(); \
+        stmt; \
+        lept_stats_current.field += lept_cycles() - lept_t0_; \
+    } while(0)
+#define LEPT_STAT_ENTER() \
+    do { if (++lept_stats_depth > lept_stats_current.max_depth) lept_stats_current.max_depth = lept_stats_depth; } while(0)
+#define LEPT_STAT_LEAVE() do { lept_stats_depth--; } while(0)
+#else
+#define LEPT_STAT(stmt) do { } while(0)
+#define LEPT_STAT_TIME(field, stmt) do { stmt; } while(0)
+#define LEPT_STAT_ENTER() do { } while(0)
+#define LEPT_STAT_LEAVE() do { } while(0)
+#endif
 
-#define EXPECT(c, ch) do { assert(*c->json == (ch)); c->json++; } while(0)
+#define EXPECT(c, ch) do { assert(c->json != c->end && *c->json == (ch)); c->json++; } while(0)
+#define PEEK(c) ((c)->json != (c)->end ? *(c)->json : '\0') //到达结尾时当作 '\0', 调用者只用来和非 '\0' 字符比较
+/* 强制内联: 把 static const 的事件表传进去以后, 里面的间接调用才能变成直接调用 */
+#if defined(__GNUC__) || defined(__clang__)
+#define LEPT_ALWAYS_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define LEPT_ALWAYS_INLINE __forceinline
+#else
+#define LEPT_ALWAYS_INLINE inline
+#endif
 #define ISDIGIT(c) ((c) >='0' && (c) <='9')
 #define ISDIGIT1TO9(c) ((c)>='1' && (c) <= '9')
 #define ISHEX(c) (ISDIGIT(c) || ((c) >= 'a' && (c) <= 'f') || ((c) >= 'A' && (c) <= 'F'))
 
+/* 字符串的内容和长度: 短字符串存放在值本身的前几个字节里 */
+#define LEPT_STRING(v) ((v)->flags & LEPT_VALUE_INLINE ? (char *) (v) : (v)->u.s)
+#define LEPT_STRING_LENGTH(v) ((v)->flags & LEPT_VALUE_INLINE ? (size_t) (v)->slen : (size_t) (v)->size)
+
 #define PUTC(c, ch) do{ *(char *) lept_context_push(c, sizeof (char)) = (ch); } while(0)
+#define PUTS(c, s, len)  memcpy(lept_context_push(c, len), s, len)
 #define STRING_ERROR(error) do{ c->top=head; return error; } while(0)
 
+/* 延迟解析的扫描结果: 每个数组/对象一条记录, 按在 json 中出现的顺序 (先序) 连续存放在 arena 中
+ * 一个容器的子容器的记录紧跟在它后面, 跳过 descendants 条记录就是下一个兄弟容器的记录
+ */
+struct lept_lazy {
+    const char *json; //'[' 或 '{' 的位置
+    const char *end; //']' 或 '}' 之后的位置
+    lept_document *doc; //展开时从它的 arena 分配, 用它的 key 驻留表
+    size_t size; //元素/成员个数
+    size_t descendants; //子树中容器的个数, 不含自己
+};
+
 typedef struct {
     const char *json;
+    const char *end; //输入的结尾, 解析器不会读取 end 及之后的字节, json 不需要以 '\0' 结尾
     char *stack;
     size_t size; //当前已分配的栈大小
     size_t top; //当前栈顶位置
+    lept_arena *arena; //不为 NULL 时字符串, key, 数组和成员块都从 arena 中分配
+    unsigned flags; //解析出的值的 flags
+    int insitu; //json 可写, 字符串和 key 直接指向原地反转义后的输入
+    const lept_handler *handler; //SAX 解析时的回调
+    void *user; //传给回调的参数
+    lept_write_func write; //不为 NULL 时 stringify 的输出攒满一块就交给它, 栈不再增长
+    const lept_lazy *lazy; //不为 NULL 时遇到的数组/对象不解析, 按顺序对应这里的记录, 生成延迟的值
+    lept_intern_table *keys; //不为 NULL 时比 LEPT_INLINE_MAX 长的 key 都从这里驻留
+    const char *borrow; //不为 NULL 时 [borrow, end) 中没有转义的长字符串直接指向输入, 不拷贝, 也不以 '\0' 结尾
+    const lept_allocator *alloc; //栈和 (不在 arena 里的) 值的内存, 为 NULL 时用 malloc
 } lept_context;
 
+static void *lept_mem_alloc(const lept_allocator *a, size_t size) {
+
+    return a ? a->malloc(a->user, size) : malloc(size);
+}
+
+static void *lept_mem_realloc(const lept_allocator *a, void *p, size_t size) {
+
+    return a ? a->realloc(a->user, p, size) : realloc(p, size);
+}
+
+static void lept_mem_free(const lept_allocator *a, void *p) {
+
+    if (a == NULL)
+        free(p);
+    else if (p)
+        a->free(a->user, p);
+}
+
 static void lept_context_init(lept_context *c) {
 
+    c->json = c->end = NULL;
     c->stack = NULL;
     c->size = c->top = 0;
+    c->arena = NULL;
+    c->flags = 0;
+    c->insitu = 0;
+    c->handler = NULL;
+    c->user = NULL;
+    c->write = NULL;
+    c->lazy = NULL;
+    c->keys = NULL;
+    c->borrow = NULL;
+    c->alloc = NULL;
 }
 
 static void *lept_context_push(lept_context *c, size_t size) {
@@ -44,11 +196,14 @@ static void *lept_context_push(lept_context *c, size_t size) {
         while (c->top + size >= c->size) {
             c->size += c->size >> 1; //每次扩大1.5倍
         }
-        c->stack = realloc(c->stack, c->size);
+        c->stack = lept_mem_realloc(c->alloc, c->stack, c->size);
+        LEPT_STAT(lept_stats_current.reallocs++; lept_stats_current.realloc_bytes += c->size;
+                  lept_stats_current.stack_growths++);
     }
 
     void *ret = c->stack + c->top; //可用的空间从这里开始
     c->top += size;
+    LEPT_STAT(if (c->top > lept_stats_current.stack_peak) lept_stats_current.stack_peak = c->top);
     return ret; //如果使用的程序不听话, 写入了后面的内存呢?
 }
 
@@ -59,14 +214,155 @@ static void *lept_context_pop(lept_context *c, size_t size) {
     return c->stack + c->top;
 }
 
+struct lept_arena_chunk {
+    lept_arena_chunk *next;
+    size_t size; //chunk 头后面可用的空间
+    size_t used;
+};
+
+#define LEPT_ARENA_ALIGN(n) (((n) + 7) & ~(size_t) 7)
+
+static void *lept_arena_alloc(lept_arena *a, size_t size) {
+
+    lept_arena_chunk *chunk = a->head;
+    size = LEPT_ARENA_ALIGN(size);
+    if (chunk == NULL || chunk->size - chunk->used < size) {
+        size_t chunk_size = a->chunk_size ? a->chunk_size : LEPT_ARENA_CHUNK_SIZE;
+        if (size > chunk_size / 4) {
+            //大块单独占一个 chunk, 挂在当前 chunk 后面, 当前 chunk 剩下的空间还能继续用
+            chunk = (lept_arena_chunk *) lept_mem_alloc(a->alloc, sizeof(lept_arena_chunk) + size);
+            LEPT_STAT(lept_stats_current.mallocs++; lept_stats_current.malloc_bytes += sizeof(lept_arena_chunk) + size);
+            chunk->size = chunk->used = size;
+            if (a->head) {
+                chunk->next = a->head->next;
+                a->head->next = chunk;
+            } else {
+                chunk->next = NULL;
+                a->head = chunk;
+            }
+            return chunk + 1;
+        }
+        chunk = (lept_arena_chunk *) lept_mem_alloc(a->alloc, sizeof(lept_arena_chunk) + chunk_size);
+        LEPT_STAT(lept_stats_current.mallocs++; lept_stats_current.malloc_bytes += sizeof(lept_arena_chunk) + chunk_size);
+        chunk->size = chunk_size;
+        chunk->used = 0;
+        chunk->next = a->head;
+        a->head = chunk;
+    }
+    void *ret = (char *) (chunk + 1) + chunk->used;
+    chunk->used += size;
+    return ret;
+}
+
+static void lept_arena_free(lept_arena *a) {
+
+    lept_arena_chunk *chunk = a->head;
+    while (chunk) {
+        lept_arena_chunk *next = chunk->next;
+        lept_mem_free(a->alloc, chunk);
+        chunk = next;
+    }
+    a->head = NULL;
+}
+
+/* 解析过程中所有存进 lept_value 的内存都通过这个函数分配; 从 arena 分配的值带有 LEPT_VALUE_BORROWED, lept_free 不会释放 */
+static void *lept_parse_alloc(lept_context *c, size_t size) {
+
+    void *p;
+    if (c->arena)
+        LEPT_STAT_TIME(alloc_cycles, p = lept_arena_alloc(c->arena, size));
+    else {
+        LEPT_STAT_TIME(alloc_cycles, p = lept_mem_alloc(c->alloc, size));
+        LEPT_STAT(lept_stats_current.mallocs++; lept_stats_current.malloc_bytes += size);
+    }
+    return p;
+}
+
+#ifdef LEPT_SSE2
+static unsigned lept_ctz(unsigned x) {
+
+    assert(x != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned) __builtin_ctz(x);
+#else
+    unsigned n = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+#endif
+
+#define ISWHITESPACE(ch) ((ch) == ' ' || (ch) == '\t' || (ch) == '\n' || (ch) == '\r')
+
+/* 空白扫描: 返回 [p, end) 中第一个不是空白的字节的位置, 分级的方式和 lept_scan_string 一样 */
+#ifdef LEPT_AVX2
+__attribute__((target("avx2")))
+static const char *lept_skip_whitespace_avx2(const char *p, const char *end) {
+
+    const __m256i sp = _mm256_set1_epi8(' '), tab = _mm256_set1_epi8('\t');
+    const __m256i lf = _mm256_set1_epi8('\n'), cr = _mm256_set1_epi8('\r');
+    for (; end - p >= 32; p += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) p);
+        __m256i t = _mm256_or_si256(_mm256_cmpeq_epi8(x, sp), _mm256_cmpeq_epi8(x, tab));
+        t = _mm256_or_si256(t, _mm256_or_si256(_mm256_cmpeq_epi8(x, lf), _mm256_cmpeq_epi8(x, cr)));
+        unsigned mask = ~(unsigned) _mm256_movemask_epi8(t);
+        if (mask)
+            return p + lept_ctz(mask);
+    }
+    return p;
+}
+#endif
+
+static const char *lept_skip_whitespace(const char *p, const char *end) {
+
+    //缩进通常只有十几个字节, 先逐个检查一小段, 短的空白不值得进入向量循环
+    for (int i = 0; i < 4; i++, p++) {
+        if (p == end || !ISWHITESPACE(*p))
+            return p;
+    }
+#ifdef LEPT_AVX2
+    if (end - p >= 64 && __builtin_cpu_supports("avx2"))
+        p = lept_skip_whitespace_avx2(p, end);
+#endif
+#ifdef LEPT_SSE2
+    {
+        const __m128i sp = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t');
+        const __m128i lf = _mm_set1_epi8('\n'), cr = _mm_set1_epi8('\r');
+        for (; end - p >= 16; p += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i *) p);
+            __m128i t = _mm_or_si128(_mm_cmpeq_epi8(x, sp), _mm_cmpeq_epi8(x, tab));
+            t = _mm_or_si128(t, _mm_or_si128(_mm_cmpeq_epi8(x, lf), _mm_cmpeq_epi8(x, cr)));
+            unsigned mask = ~(unsigned) _mm_movemask_epi8(t) & 0xFFFF;
+            if (mask)
+                return p + lept_ctz(mask);
+        }
+    }
+#endif
+    //SWAR: 精确地标出等于某个值的字节 (最高位), 8 个字节都是空白才整体跳过
+    for (; end - p >= 8; p += 8) {
+        uint64_t x, ws = 0;
+        const uint64_t lows = 0x7F7F7F7F7F7F7F7Fu, ones = 0x0101010101010101u;
+        static const unsigned char chars[] = {' ', '\t', '\n', '\r'};
+        memcpy(&x, p, 8);
+        for (int i = 0; i < 4; i++) {
+            uint64_t y = x ^ (ones * chars[i]);
+            ws |= ~(((y & lows) + lows) | y | lows);
+        }
+        if (ws != ~lows)
+            break;
+    }
+    while (p != end && ISWHITESPACE(*p))
+        p++;
+    return p;
+}
+
 //static的全局变量, 表示只有文件内部链接, 无法在其他文件引用, 相当于是这个文件的私有变量
 static void lept_parse_whitespace(lept_context *c) {
 
-    const char *p = c->json;
-    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') {
-        p++;
-    }
-    c->json = p;
+    c->json = lept_skip_whitespace(c->json, c->end);
 }
 
 static int lept_parse_literal(lept_context *c, lept_value *v, lept_type type) {
@@ -74,24 +370,987 @@ static int lept_parse_literal(lept_context *c, lept_value *v, lept_type type) {
     assert(type == LEPT_TRUE || type == LEPT_FALSE || type == LEPT_NULL);
 
     const char *str;
+    size_t len;
     if (type == LEPT_TRUE) {
         str = "true";
+        len = 4;
     } else if (type == LEPT_FALSE) {
         str = "false";
+        len = 5;
     } else {
         str = "null";
+        len = 4;
     }
 
-    EXPECT(c, *str++);
+    if ((size_t) (c->end - c->json) < len || memcmp(c->json, str, len) != 0)
+        return LEPT_PARSE_INVALID_VALUE;
+    c->json += len;
 
-    while (*str) {
-        if (*c->json++ != *str++) {
-            return LEPT_PARSE_INVALID_VALUE;
+    v->type = type;
+    return 0;
+}
+
+/* 数字解码: 不用 strtod (会重新扫描一遍, 依赖 locale, 还要设置 errno)
+ * 1. 整数和 Clinger 快速路径: 尾数 <= 2^53 且 |exp10| <= 22 时一次浮点乘除就是精确结果
+ * 2. Eisel-Lemire: 用 128 位的 5^q 近似值做一次 64x128 乘法, 绝大多数情况可以直接确定正确舍入的结果
+ * 3. 上面都不能确定时 (极少见), 用十进制大数按 2 的幂移位, 精确地算出结果
+ */
+
+#define LEPT_POW5_MIN_EXP10 (-342)
+#define LEPT_POW5_MAX_EXP10 308
+
+/* 5^q 的 128 位近似值 (高 64 位, 低 64 位), q 从 -342 到 308, 最高位对齐到第 127 位 */
+static const uint64_t lept_pow5_128[][2] = {
+    {0xeef453d6923bd65au, 0x113faa2906a13b3fu},
+    {0x9558b4661b6565f8u, 0x4ac7ca59a424c507u},
+    {0xbaaee17fa23ebf76u, 0x5d79bcf00d2df649u},
+    {0xe95a99df8ace6f53u, 0xf4d82c2c107973dcu},
+    {0x91d8a02bb6c10594u, 0x79071b9b8a4be869u},
+    {0xb64ec836a47146f9u, 0x9748e2826cdee284u},
+    {0xe3e27a444d8d98b7u, 0xfd1b1b2308169b25u},
+    {0x8e6d8c6ab0787f72u, 0xfe30f0f5e50e20f7u},
+    {0xb208ef855c969f4fu, 0xbdbd2d335e51a935u},
+    {0xde8b2b66b3bc4723u, 0xad2c788035e61382u},
+    {0x8b16fb203055ac76u, 0x4c3bcb5021afcc31u},
+    {0xaddcb9e83c6b1793u, 0xdf4abe242a1bbf3du},
+    {0xd953e8624b85dd78u, 0xd71d6dad34a2af0du},
+    {0x87d4713d6f33aa6bu, 0x8672648c40e5ad68u},
+    {0xa9c98d8ccb009506u, 0x680efdaf511f18c2u},
+    {0xd43bf0effdc0ba48u, 0x0212bd1b2566def2u},
+    {0x84a57695fe98746du, 0x014bb630f7604b57u},
+    {0xa5ced43b7e3e9188u, 0x419ea3bd35385e2du},
+    {0xcf42894a5dce35eau, 0x52064cac828675b9u},
+    {0x818995ce7aa0e1b2u, 0x7343efebd1940993u},
+    {0xa1ebfb4219491a1fu, 0x1014ebe6c5f90bf8u},
+    {0xca66fa129f9b60a6u, 0xd41a26e077774ef6u},
+    {0xfd00b897478238d0u, 0x8920b098955522b4u},
+    {0x9e20735e8cb16382u, 0x55b46e5f5d5535b0u},
+    {0xc5a890362fddbc62u, 0xeb2189f734aa831du},
+    {0xf712b443bbd52b7bu, 0xa5e9ec7501d523e4u},
+    {0x9a6bb0aa55653b2du, 0x47b233c92125366eu},
+    {0xc1069cd4eabe89f8u, 0x999ec0bb696e840au},
+    {0xf148440a256e2c76u, 0xc00670ea43ca250du},
+    {0x96cd2a865764dbcau, 0x380406926a5e5728u},
+    {0xbc807527ed3e12bcu, 0xc605083704f5ecf2u},
+    {0xeba09271e88d976bu, 0xf7864a44c633682eu},
+    {0x93445b8731587ea3u, 0x7ab3ee6afbe0211du},
+    {0xb8157268fdae9e4cu, 0x5960ea05bad82964u},
+    {0xe61acf033d1a45dfu, 0x6fb92487298e33bdu},
+    {0x8fd0c16206306babu, 0xa5d3b6d479f8e056u},
+    {0xb3c4f1ba87bc8696u, 0x8f48a4899877186cu},
+    {0xe0b62e2929aba83cu, 0x331acdabfe94de87u},
+    {0x8c71dcd9ba0b4925u, 0x9ff0c08b7f1d0b14u},
+    {0xaf8e5410288e1b6fu, 0x07ecf0ae5ee44dd9u},
+    {0xdb71e91432b1a24au, 0xc9e82cd9f69d6150u},
+    {0x892731ac9faf056eu, 0xbe311c083a225cd2u},
+    {0xab70fe17c79ac6cau, 0x6dbd630a48aaf406u},
+    {0xd64d3d9db981787du, 0x092cbbccdad5b108u},
+    {0x85f0468293f0eb4eu, 0x25bbf56008c58ea5u},
+    {0xa76c582338ed2621u, 0xaf2af2b80af6f24eu},
+    {0xd1476e2c07286faau, 0x1af5af660db4aee1u},
+    {0x82cca4db847945cau, 0x50d98d9fc890ed4du},
+    {0xa37fce126597973cu, 0xe50ff107bab528a0u},
+    {0xcc5fc196fefd7d0cu, 0x1e53ed49a96272c8u},
+    {0xff77b1fcbebcdc4fu, 0x25e8e89c13bb0f7au},
+    {0x9faacf3df73609b1u, 0x77b191618c54e9acu},
+    {0xc795830d75038c1du, 0xd59df5b9ef6a2417u},
+    {0xf97ae3d0d2446f25u, 0x4b0573286b44ad1du},
+    {0x9becce62836ac577u, 0x4ee367f9430aec32u},
+    {0xc2e801fb244576d5u, 0x229c41f793cda73fu},
+    {0xf3a20279ed56d48au, 0x6b43527578c1110fu},
+    {0x9845418c345644d6u, 0x830a13896b78aaa9u},
+    {0xbe5691ef416bd60cu, 0x23cc986bc656d553u},
+    {0xedec366b11c6cb8fu, 0x2cbfbe86b7ec8aa8u},
+    {0x94b3a202eb1c3f39u, 0x7bf7d71432f3d6a9u},
+    {0xb9e08a83a5e34f07u, 0xdaf5ccd93fb0cc53u},
+    {0xe858ad248f5c22c9u, 0xd1b3400f8f9cff68u},
+    {0x91376c36d99995beu, 0x23100809b9c21fa1u},
+    {0xb58547448ffffb2du, 0xabd40a0c2832a78au},
+    {0xe2e69915b3fff9f9u, 0x16c90c8f323f516cu},
+    {0x8dd01fad907ffc3bu, 0xae3da7d97f6792e3u},
+    {0xb1442798f49ffb4au, 0x99cd11cfdf41779cu},
+    {0xdd95317f31c7fa1du, 0x40405643d711d583u},
+    {0x8a7d3eef7f1cfc52u, 0x482835ea666b2572u},
+    {0xad1c8eab5ee43b66u, 0xda3243650005eecfu},
+    {0xd863b256369d4a40u, 0x90bed43e40076a82u},
+    {0x873e4f75e2224e68u, 0x5a7744a6e804a291u},
+    {0xa90de3535aaae202u, 0x711515d0a205cb36u},
+    {0xd3515c2831559a83u, 0x0d5a5b44ca873e03u},
+    {0x8412d9991ed58091u, 0xe858790afe9486c2u},
+    {0xa5178fff668ae0b6u, 0x626e974dbe39a872u},
+    {0xce5d73ff402d98e3u, 0xfb0a3d212dc8128fu},
+    {0x80fa687f881c7f8eu, 0x7ce66634bc9d0b99u},
+    {0xa139029f6a239f72u, 0x1c1fffc1ebc44e80u},
+    {0xc987434744ac874eu, 0xa327ffb266b56220u},
+    {0xfbe9141915d7a922u, 0x4bf1ff9f0062baa8u},
+    {0x9d71ac8fada6c9b5u, 0x6f773fc3603db4a9u},
+    {0xc4ce17b399107c22u, 0xcb550fb4384d21d3u},
+    {0xf6019da07f549b2bu, 0x7e2a53a146606a48u},
+    {0x99c102844f94e0fbu, 0x2eda7444cbfc426du},
+    {0xc0314325637a1939u, 0xfa911155fefb5308u},
+    {0xf03d93eebc589f88u, 0x793555ab7eba27cau},
+    {0x96267c7535b763b5u, 0x4bc1558b2f3458deu},
+    {0xbbb01b9283253ca2u, 0x9eb1aaedfb016f16u},
+    {0xea9c227723ee8bcbu, 0x465e15a979c1cadcu},
+    {0x92a1958a7675175fu, 0x0bfacd89ec191ec9u},
+    {0xb749faed14125d36u, 0xcef980ec671f667bu},
+    {0xe51c79a85916f484u, 0x82b7e12780e7401au},
+    {0x8f31cc0937ae58d2u, 0xd1b2ecb8b0908810u},
+    {0xb2fe3f0b8599ef07u, 0x861fa7e6dcb4aa15u},
+    {0xdfbdcece67006ac9u, 0x67a791e093e1d49au},
+    {0x8bd6a141006042bdu, 0xe0c8bb2c5c6d24e0u},
+    {0xaecc49914078536du, 0x58fae9f773886e18u},
+    {0xda7f5bf590966848u, 0xaf39a475506a899eu},
+    {0x888f99797a5e012du, 0x6d8406c952429603u},
+    {0xaab37fd7d8f58178u, 0xc8e5087ba6d33b83u},
+    {0xd5605fcdcf32e1d6u, 0xfb1e4a9a90880a64u},
+    {0x855c3be0a17fcd26u, 0x5cf2eea09a55067fu},
+    {0xa6b34ad8c9dfc06fu, 0xf42faa48c0ea481eu},
+    {0xd0601d8efc57b08bu, 0xf13b94daf124da26u},
+    {0x823c12795db6ce57u, 0x76c53d08d6b70858u},
+    {0xa2cb1717b52481edu, 0x54768c4b0c64ca6eu},
+    {0xcb7ddcdda26da268u, 0xa9942f5dcf7dfd09u},
+    {0xfe5d54150b090b02u, 0xd3f93b35435d7c4cu},
+    {0x9efa548d26e5a6e1u, 0xc47bc5014a1a6dafu},
+    {0xc6b8e9b0709f109au, 0x359ab6419ca1091bu},
+    {0xf867241c8cc6d4c0u, 0xc30163d203c94b62u},
+    {0x9b407691d7fc44f8u, 0x79e0de63425dcf1du},
+    {0xc21094364dfb5636u, 0x985915fc12f542e4u},
+    {0xf294b943e17a2bc4u, 0x3e6f5b7b17b2939du},
+    {0x979cf3ca6cec5b5au, 0xa705992ceecf9c42u},
+    {0xbd8430bd08277231u, 0x50c6ff782a838353u},
+    {0xece53cec4a314ebdu, 0xa4f8bf5635246428u},
+    {0x940f4613ae5ed136u, 0x871b7795e136be99u},
+    {0xb913179899f68584u, 0x28e2557b59846e3fu},
+    {0xe757dd7ec07426e5u, 0x331aeada2fe589cfu},
+    {0x9096ea6f3848984fu, 0x3ff0d2c85def7621u},
+    {0xb4bca50b065abe63u, 0x0fed077a756b53a9u},
+    {0xe1ebce4dc7f16dfbu, 0xd3e8495912c62894u},
+    {0x8d3360f09cf6e4bdu, 0x64712dd7abbbd95cu},
+    {0xb080392cc4349decu, 0xbd8d794d96aacfb3u},
+    {0xdca04777f541c567u, 0xecf0d7a0fc5583a0u},
+    {0x89e42caaf9491b60u, 0xf41686c49db57244u},
+    {0xac5d37d5b79b6239u, 0x311c2875c522ced5u},
+    {0xd77485cb25823ac7u, 0x7d633293366b828bu},
+    {0x86a8d39ef77164bcu, 0xae5dff9c02033197u},
+    {0xa8530886b54dbdebu, 0xd9f57f830283fdfcu},
+    {0xd267caa862a12d66u, 0xd072df63c324fd7bu},
+    {0x8380dea93da4bc60u, 0x4247cb9e59f71e6du},
+    {0xa46116538d0deb78u, 0x52d9be85f074e608u},
+    {0xcd795be870516656u, 0x67902e276c921f8bu},
+    {0x806bd9714632dff6u, 0x00ba1cd8a3db53b6u},
+    {0xa086cfcd97bf97f3u, 0x80e8a40eccd228a4u},
+    {0xc8a883c0fdaf7df0u, 0x6122cd128006b2cdu},
+    {0xfad2a4b13d1b5d6cu, 0x796b805720085f81u},
+    {0x9cc3a6eec6311a63u, 0xcbe3303674053bb0u},
+    {0xc3f490aa77bd60fcu, 0xbedbfc4411068a9cu},
+    {0xf4f1b4d515acb93bu, 0xee92fb5515482d44u},
+    {0x991711052d8bf3c5u, 0x751bdd152d4d1c4au},
+    {0xbf5cd54678eef0b6u, 0xd262d45a78a0635du},
+    {0xef340a98172aace4u, 0x86fb897116c87c34u},
+    {0x9580869f0e7aac0eu, 0xd45d35e6ae3d4da0u},
+    {0xbae0a846d2195712u, 0x8974836059cca109u},
+    {0xe998d258869facd7u, 0x2bd1a438703fc94bu},
+    {0x91ff83775423cc06u, 0x7b6306a34627ddcfu},
+    {0xb67f6455292cbf08u, 0x1a3bc84c17b1d542u},
+    {0xe41f3d6a7377eecau, 0x20caba5f1d9e4a93u},
+    {0x8e938662882af53eu, 0x547eb47b7282ee9cu},
+    {0xb23867fb2a35b28du, 0xe99e619a4f23aa43u},
+    {0xdec681f9f4c31f31u, 0x6405fa00e2ec94d4u},
+    {0x8b3c113c38f9f37eu, 0xde83bc408dd3dd04u},
+    {0xae0b158b4738705eu, 0x9624ab50b148d445u},
+    {0xd98ddaee19068c76u, 0x3badd624dd9b0957u},
+    {0x87f8a8d4cfa417c9u, 0xe54ca5d70a80e5d6u},
+    {0xa9f6d30a038d1dbcu, 0x5e9fcf4ccd211f4cu},
+    {0xd47487cc8470652bu, 0x7647c3200069671fu},
+    {0x84c8d4dfd2c63f3bu, 0x29ecd9f40041e073u},
+    {0xa5fb0a17c777cf09u, 0xf468107100525890u},
+    {0xcf79cc9db955c2ccu, 0x7182148d4066eeb4u},
+    {0x81ac1fe293d599bfu, 0xc6f14cd848405530u},
+    {0xa21727db38cb002fu, 0xb8ada00e5a506a7cu},
+    {0xca9cf1d206fdc03bu, 0xa6d90811f0e4851cu},
+    {0xfd442e4688bd304au, 0x908f4a166d1da663u},
+    {0x9e4a9cec15763e2eu, 0x9a598e4e043287feu},
+    {0xc5dd44271ad3cdbau, 0x40eff1e1853f29fdu},
+    {0xf7549530e188c128u, 0xd12bee59e68ef47cu},
+    {0x9a94dd3e8cf578b9u, 0x82bb74f8301958ceu},
+    {0xc13a148e3032d6e7u, 0xe36a52363c1faf01u},
+    {0xf18899b1bc3f8ca1u, 0xdc44e6c3cb279ac1u},
+    {0x96f5600f15a7b7e5u, 0x29ab103a5ef8c0b9u},
+    {0xbcb2b812db11a5deu, 0x7415d448f6b6f0e7u},
+    {0xebdf661791d60f56u, 0x111b495b3464ad21u},
+    {0x936b9fcebb25c995u, 0xcab10dd900beec34u},
+    {0xb84687c269ef3bfbu, 0x3d5d514f40eea742u},
+    {0xe65829b3046b0afau, 0x0cb4a5a3112a5112u},
+    {0x8ff71a0fe2c2e6dcu, 0x47f0e785eaba72abu},
+    {0xb3f4e093db73a093u, 0x59ed216765690f56u},
+    {0xe0f218b8d25088b8u, 0x306869c13ec3532cu},
+    {0x8c974f7383725573u, 0x1e414218c73a13fbu},
+    {0xafbd2350644eeacfu, 0xe5d1929ef90898fau},
+    {0xdbac6c247d62a583u, 0xdf45f746b74abf39u},
+    {0x894bc396ce5da772u, 0x6b8bba8c328eb783u},
+    {0xab9eb47c81f5114fu, 0x066ea92f3f326564u},
+    {0xd686619ba27255a2u, 0xc80a537b0efefebdu},
+    {0x8613fd0145877585u, 0xbd06742ce95f5f36u},
+    {0xa798fc4196e952e7u, 0x2c48113823b73704u},
+    {0xd17f3b51fca3a7a0u, 0xf75a15862ca504c5u},
+    {0x82ef85133de648c4u, 0x9a984d73dbe722fbu},
+    {0xa3ab66580d5fdaf5u, 0xc13e60d0d2e0ebbau},
+    {0xcc963fee10b7d1b3u, 0x318df905079926a8u},
+    {0xffbbcfe994e5c61fu, 0xfdf17746497f7052u},
+    {0x9fd561f1fd0f9bd3u, 0xfeb6ea8bedefa633u},
+    {0xc7caba6e7c5382c8u, 0xfe64a52ee96b8fc0u},
+    {0xf9bd690a1b68637bu, 0x3dfdce7aa3c673b0u},
+    {0x9c1661a651213e2du, 0x06bea10ca65c084eu},
+    {0xc31bfa0fe5698db8u, 0x486e494fcff30a62u},
+    {0xf3e2f893dec3f126u, 0x5a89dba3c3efccfau},
+    {0x986ddb5c6b3a76b7u, 0xf89629465a75e01cu},
+    {0xbe89523386091465u, 0xf6bbb397f1135823u},
+    {0xee2ba6c0678b597fu, 0x746aa07ded582e2cu},
+    {0x94db483840b717efu, 0xa8c2a44eb4571cdcu},
+    {0xba121a4650e4ddebu, 0x92f34d62616ce413u},
+    {0xe896a0d7e51e1566u, 0x77b020baf9c81d17u},
+    {0x915e2486ef32cd60u, 0x0ace1474dc1d122eu},
+    {0xb5b5ada8aaff80b8u, 0x0d819992132456bau},
+    {0xe3231912d5bf60e6u, 0x10e1fff697ed6c69u},
+    {0x8df5efabc5979c8fu, 0xca8d3ffa1ef463c1u},
+    {0xb1736b96b6fd83b3u, 0xbd308ff8a6b17cb2u},
+    {0xddd0467c64bce4a0u, 0xac7cb3f6d05ddbdeu},
+    {0x8aa22c0dbef60ee4u, 0x6bcdf07a423aa96bu},
+    {0xad4ab7112eb3929du, 0x86c16c98d2c953c6u},
+    {0xd89d64d57a607744u, 0xe871c7bf077ba8b7u},
+    {0x87625f056c7c4a8bu, 0x11471cd764ad4972u},
+    {0xa93af6c6c79b5d2du, 0xd598e40d3dd89bcfu},
+    {0xd389b47879823479u, 0x4aff1d108d4ec2c3u},
+    {0x843610cb4bf160cbu, 0xcedf722a585139bau},
+    {0xa54394fe1eedb8feu, 0xc2974eb4ee658828u},
+    {0xce947a3da6a9273eu, 0x733d226229feea32u},
+    {0x811ccc668829b887u, 0x0806357d5a3f525fu},
+    {0xa163ff802a3426a8u, 0xca07c2dcb0cf26f7u},
+    {0xc9bcff6034c13052u, 0xfc89b393dd02f0b5u},
+    {0xfc2c3f3841f17c67u, 0xbbac2078d443ace2u},
+    {0x9d9ba7832936edc0u, 0xd54b944b84aa4c0du},
+    {0xc5029163f384a931u, 0x0a9e795e65d4df11u},
+    {0xf64335bcf065d37du, 0x4d4617b5ff4a16d5u},
+    {0x99ea0196163fa42eu, 0x504bced1bf8e4e45u},
+    {0xc06481fb9bcf8d39u, 0xe45ec2862f71e1d6u},
+    {0xf07da27a82c37088u, 0x5d767327bb4e5a4cu},
+    {0x964e858c91ba2655u, 0x3a6a07f8d510f86fu},
+    {0xbbe226efb628afeau, 0x890489f70a55368bu},
+    {0xeadab0aba3b2dbe5u, 0x2b45ac74ccea842eu},
+    {0x92c8ae6b464fc96fu, 0x3b0b8bc90012929du},
+    {0xb77ada0617e3bbcbu, 0x09ce6ebb40173744u},
+    {0xe55990879ddcaabdu, 0xcc420a6a101d0515u},
+    {0x8f57fa54c2a9eab6u, 0x9fa946824a12232du},
+    {0xb32df8e9f3546564u, 0x47939822dc96abf9u},
+    {0xdff9772470297ebdu, 0x59787e2b93bc56f7u},
+    {0x8bfbea76c619ef36u, 0x57eb4edb3c55b65au},
+    {0xaefae51477a06b03u, 0xede622920b6b23f1u},
+    {0xdab99e59958885c4u, 0xe95fab368e45ecedu},
+    {0x88b402f7fd75539bu, 0x11dbcb0218ebb414u},
+    {0xaae103b5fcd2a881u, 0xd652bdc29f26a119u},
+    {0xd59944a37c0752a2u, 0x4be76d3346f0495fu},
+    {0x857fcae62d8493a5u, 0x6f70a4400c562ddbu},
+    {0xa6dfbd9fb8e5b88eu, 0xcb4ccd500f6bb952u},
+    {0xd097ad07a71f26b2u, 0x7e2000a41346a7a7u},
+    {0x825ecc24c873782fu, 0x8ed400668c0c28c8u},
+    {0xa2f67f2dfa90563bu, 0x728900802f0f32fau},
+    {0xcbb41ef979346bcau, 0x4f2b40a03ad2ffb9u},
+    {0xfea126b7d78186bcu, 0xe2f610c84987bfa8u},
+    {0x9f24b832e6b0f436u, 0x0dd9ca7d2df4d7c9u},
+    {0xc6ede63fa05d3143u, 0x91503d1c79720dbbu},
+    {0xf8a95fcf88747d94u, 0x75a44c6397ce912au},
+    {0x9b69dbe1b548ce7cu, 0xc986afbe3ee11abau},
+    {0xc24452da229b021bu, 0xfbe85badce996168u},
+    {0xf2d56790ab41c2a2u, 0xfae27299423fb9c3u},
+    {0x97c560ba6b0919a5u, 0xdccd879fc967d41au},
+    {0xbdb6b8e905cb600fu, 0x5400e987bbc1c920u},
+    {0xed246723473e3813u, 0x290123e9aab23b68u},
+    {0x9436c0760c86e30bu, 0xf9a0b6720aaf6521u},
+    {0xb94470938fa89bceu, 0xf808e40e8d5b3e69u},
+    {0xe7958cb87392c2c2u, 0xb60b1d1230b20e04u},
+    {0x90bd77f3483bb9b9u, 0xb1c6f22b5e6f48c2u},
+    {0xb4ecd5f01a4aa828u, 0x1e38aeb6360b1af3u},
+    {0xe2280b6c20dd5232u, 0x25c6da63c38de1b0u},
+    {0x8d590723948a535fu, 0x579c487e5a38ad0eu},
+    {0xb0af48ec79ace837u, 0x2d835a9df0c6d851u},
+    {0xdcdb1b2798182244u, 0xf8e431456cf88e65u},
+    {0x8a08f0f8bf0f156bu, 0x1b8e9ecb641b58ffu},
+    {0xac8b2d36eed2dac5u, 0xe272467e3d222f3fu},
+    {0xd7adf884aa879177u, 0x5b0ed81dcc6abb0fu},
+    {0x86ccbb52ea94baeau, 0x98e947129fc2b4e9u},
+    {0xa87fea27a539e9a5u, 0x3f2398d747b36224u},
+    {0xd29fe4b18e88640eu, 0x8eec7f0d19a03aadu},
+    {0x83a3eeeef9153e89u, 0x1953cf68300424acu},
+    {0xa48ceaaab75a8e2bu, 0x5fa8c3423c052dd7u},
+    {0xcdb02555653131b6u, 0x3792f412cb06794du},
+    {0x808e17555f3ebf11u, 0xe2bbd88bbee40bd0u},
+    {0xa0b19d2ab70e6ed6u, 0x5b6aceaeae9d0ec4u},
+    {0xc8de047564d20a8bu, 0xf245825a5a445275u},
+    {0xfb158592be068d2eu, 0xeed6e2f0f0d56712u},
+    {0x9ced737bb6c4183du, 0x55464dd69685606bu},
+    {0xc428d05aa4751e4cu, 0xaa97e14c3c26b886u},
+    {0xf53304714d9265dfu, 0xd53dd99f4b3066a8u},
+    {0x993fe2c6d07b7fabu, 0xe546a8038efe4029u},
+    {0xbf8fdb78849a5f96u, 0xde98520472bdd033u},
+    {0xef73d256a5c0f77cu, 0x963e66858f6d4440u},
+    {0x95a8637627989aadu, 0xdde7001379a44aa8u},
+    {0xbb127c53b17ec159u, 0x5560c018580d5d52u},
+    {0xe9d71b689dde71afu, 0xaab8f01e6e10b4a6u},
+    {0x9226712162ab070du, 0xcab3961304ca70e8u},
+    {0xb6b00d69bb55c8d1u, 0x3d607b97c5fd0d22u},
+    {0xe45c10c42a2b3b05u, 0x8cb89a7db77c506au},
+    {0x8eb98a7a9a5b04e3u, 0x77f3608e92adb242u},
+    {0xb267ed1940f1c61cu, 0x55f038b237591ed3u},
+    {0xdf01e85f912e37a3u, 0x6b6c46dec52f6688u},
+    {0x8b61313bbabce2c6u, 0x2323ac4b3b3da015u},
+    {0xae397d8aa96c1b77u, 0xabec975e0a0d081au},
+    {0xd9c7dced53c72255u, 0x96e7bd358c904a21u},
+    {0x881cea14545c7575u, 0x7e50d64177da2e54u},
+    {0xaa242499697392d2u, 0xdde50bd1d5d0b9e9u},
+    {0xd4ad2dbfc3d07787u, 0x955e4ec64b44e864u},
+    {0x84ec3c97da624ab4u, 0xbd5af13bef0b113eu},
+    {0xa6274bbdd0fadd61u, 0xecb1ad8aeacdd58eu},
+    {0xcfb11ead453994bau, 0x67de18eda5814af2u},
+    {0x81ceb32c4b43fcf4u, 0x80eacf948770ced7u},
+    {0xa2425ff75e14fc31u, 0xa1258379a94d028du},
+    {0xcad2f7f5359a3b3eu, 0x096ee45813a04330u},
+    {0xfd87b5f28300ca0du, 0x8bca9d6e188853fcu},
+    {0x9e74d1b791e07e48u, 0x775ea264cf55347eu},
+    {0xc612062576589ddau, 0x95364afe032a819eu},
+    {0xf79687aed3eec551u, 0x3a83ddbd83f52205u},
+    {0x9abe14cd44753b52u, 0xc4926a9672793543u},
+    {0xc16d9a0095928a27u, 0x75b7053c0f178294u},
+    {0xf1c90080baf72cb1u, 0x5324c68b12dd6339u},
+    {0x971da05074da7beeu, 0xd3f6fc16ebca5e04u},
+    {0xbce5086492111aeau, 0x88f4bb1ca6bcf585u},
+    {0xec1e4a7db69561a5u, 0x2b31e9e3d06c32e6u},
+    {0x9392ee8e921d5d07u, 0x3aff322e62439fd0u},
+    {0xb877aa3236a4b449u, 0x09befeb9fad487c3u},
+    {0xe69594bec44de15bu, 0x4c2ebe687989a9b4u},
+    {0x901d7cf73ab0acd9u, 0x0f9d37014bf60a11u},
+    {0xb424dc35095cd80fu, 0x538484c19ef38c95u},
+    {0xe12e13424bb40e13u, 0x2865a5f206b06fbau},
+    {0x8cbccc096f5088cbu, 0xf93f87b7442e45d4u},
+    {0xafebff0bcb24aafeu, 0xf78f69a51539d749u},
+    {0xdbe6fecebdedd5beu, 0xb573440e5a884d1cu},
+    {0x89705f4136b4a597u, 0x31680a88f8953031u},
+    {0xabcc77118461cefcu, 0xfdc20d2b36ba7c3eu},
+    {0xd6bf94d5e57a42bcu, 0x3d32907604691b4du},
+    {0x8637bd05af6c69b5u, 0xa63f9a49c2c1b110u},
+    {0xa7c5ac471b478423u, 0x0fcf80dc33721d54u},
+    {0xd1b71758e219652bu, 0xd3c36113404ea4a9u},
+    {0x83126e978d4fdf3bu, 0x645a1cac083126eau},
+    {0xa3d70a3d70a3d70au, 0x3d70a3d70a3d70a4u},
+    {0xccccccccccccccccu, 0xcccccccccccccccdu},
+    {0x8000000000000000u, 0x0000000000000000u},
+    {0xa000000000000000u, 0x0000000000000000u},
+    {0xc800000000000000u, 0x0000000000000000u},
+    {0xfa00000000000000u, 0x0000000000000000u},
+    {0x9c40000000000000u, 0x0000000000000000u},
+    {0xc350000000000000u, 0x0000000000000000u},
+    {0xf424000000000000u, 0x0000000000000000u},
+    {0x9896800000000000u, 0x0000000000000000u},
+    {0xbebc200000000000u, 0x0000000000000000u},
+    {0xee6b280000000000u, 0x0000000000000000u},
+    {0x9502f90000000000u, 0x0000000000000000u},
+    {0xba43b74000000000u, 0x0000000000000000u},
+    {0xe8d4a51000000000u, 0x0000000000000000u},
+    {0x9184e72a00000000u, 0x0000000000000000u},
+    {0xb5e620f480000000u, 0x0000000000000000u},
+    {0xe35fa931a0000000u, 0x0000000000000000u},
+    {0x8e1bc9bf04000000u, 0x0000000000000000u},
+    {0xb1a2bc2ec5000000u, 0x0000000000000000u},
+    {0xde0b6b3a76400000u, 0x0000000000000000u},
+    {0x8ac7230489e80000u, 0x0000000000000000u},
+    {0xad78ebc5ac620000u, 0x0000000000000000u},
+    {0xd8d726b7177a8000u, 0x0000000000000000u},
+    {0x878678326eac9000u, 0x0000000000000000u},
+    {0xa968163f0a57b400u, 0x0000000000000000u},
+    {0xd3c21bcecceda100u, 0x0000000000000000u},
+    {0x84595161401484a0u, 0x0000000000000000u},
+    {0xa56fa5b99019a5c8u, 0x0000000000000000u},
+    {0xcecb8f27f4200f3au, 0x0000000000000000u},
+    {0x813f3978f8940984u, 0x4000000000000000u},
+    {0xa18f07d736b90be5u, 0x5000000000000000u},
+    {0xc9f2c9cd04674edeu, 0xa400000000000000u},
+    {0xfc6f7c4045812296u, 0x4d00000000000000u},
+    {0x9dc5ada82b70b59du, 0xf020000000000000u},
+    {0xc5371912364ce305u, 0x6c28000000000000u},
+    {0xf684df56c3e01bc6u, 0xc732000000000000u},
+    {0x9a130b963a6c115cu, 0x3c7f400000000000u},
+    {0xc097ce7bc90715b3u, 0x4b9f100000000000u},
+    {0xf0bdc21abb48db20u, 0x1e86d40000000000u},
+    {0x96769950b50d88f4u, 0x1314448000000000u},
+    {0xbc143fa4e250eb31u, 0x17d955a000000000u},
+    {0xeb194f8e1ae525fdu, 0x5dcfab0800000000u},
+    {0x92efd1b8d0cf37beu, 0x5aa1cae500000000u},
+    {0xb7abc627050305adu, 0xf14a3d9e40000000u},
+    {0xe596b7b0c643c719u, 0x6d9ccd05d0000000u},
+    {0x8f7e32ce7bea5c6fu, 0xe4820023a2000000u},
+    {0xb35dbf821ae4f38bu, 0xdda2802c8a800000u},
+    {0xe0352f62a19e306eu, 0xd50b2037ad200000u},
+    {0x8c213d9da502de45u, 0x4526f422cc340000u},
+    {0xaf298d050e4395d6u, 0x9670b12b7f410000u},
+    {0xdaf3f04651d47b4cu, 0x3c0cdd765f114000u},
+    {0x88d8762bf324cd0fu, 0xa5880a69fb6ac800u},
+    {0xab0e93b6efee0053u, 0x8eea0d047a457a00u},
+    {0xd5d238a4abe98068u, 0x72a4904598d6d880u},
+    {0x85a36366eb71f041u, 0x47a6da2b7f864750u},
+    {0xa70c3c40a64e6c51u, 0x999090b65f67d924u},
+    {0xd0cf4b50cfe20765u, 0xfff4b4e3f741cf6du},
+    {0x82818f1281ed449fu, 0xbff8f10e7a8921a4u},
+    {0xa321f2d7226895c7u, 0xaff72d52192b6a0du},
+    {0xcbea6f8ceb02bb39u, 0x9bf4f8a69f764490u},
+    {0xfee50b7025c36a08u, 0x02f236d04753d5b4u},
+    {0x9f4f2726179a2245u, 0x01d762422c946590u},
+    {0xc722f0ef9d80aad6u, 0x424d3ad2b7b97ef5u},
+    {0xf8ebad2b84e0d58bu, 0xd2e0898765a7deb2u},
+    {0x9b934c3b330c8577u, 0x63cc55f49f88eb2fu},
+    {0xc2781f49ffcfa6d5u, 0x3cbf6b71c76b25fbu},
+    {0xf316271c7fc3908au, 0x8bef464e3945ef7au},
+    {0x97edd871cfda3a56u, 0x97758bf0e3cbb5acu},
+    {0xbde94e8e43d0c8ecu, 0x3d52eeed1cbea317u},
+    {0xed63a231d4c4fb27u, 0x4ca7aaa863ee4bddu},
+    {0x945e455f24fb1cf8u, 0x8fe8caa93e74ef6au},
+    {0xb975d6b6ee39e436u, 0xb3e2fd538e122b44u},
+    {0xe7d34c64a9c85d44u, 0x60dbbca87196b616u},
+    {0x90e40fbeea1d3a4au, 0xbc8955e946fe31cdu},
+    {0xb51d13aea4a488ddu, 0x6babab6398bdbe41u},
+    {0xe264589a4dcdab14u, 0xc696963c7eed2dd1u},
+    {0x8d7eb76070a08aecu, 0xfc1e1de5cf543ca2u},
+    {0xb0de65388cc8ada8u, 0x3b25a55f43294bcbu},
+    {0xdd15fe86affad912u, 0x49ef0eb713f39ebeu},
+    {0x8a2dbf142dfcc7abu, 0x6e3569326c784337u},
+    {0xacb92ed9397bf996u, 0x49c2c37f07965404u},
+    {0xd7e77a8f87daf7fbu, 0xdc33745ec97be906u},
+    {0x86f0ac99b4e8dafdu, 0x69a028bb3ded71a3u},
+    {0xa8acd7c0222311bcu, 0xc40832ea0d68ce0cu},
+    {0xd2d80db02aabd62bu, 0xf50a3fa490c30190u},
+    {0x83c7088e1aab65dbu, 0x792667c6da79e0fau},
+    {0xa4b8cab1a1563f52u, 0x577001b891185938u},
+    {0xcde6fd5e09abcf26u, 0xed4c0226b55e6f86u},
+    {0x80b05e5ac60b6178u, 0x544f8158315b05b4u},
+    {0xa0dc75f1778e39d6u, 0x696361ae3db1c721u},
+    {0xc913936dd571c84cu, 0x03bc3a19cd1e38e9u},
+    {0xfb5878494ace3a5fu, 0x04ab48a04065c723u},
+    {0x9d174b2dcec0e47bu, 0x62eb0d64283f9c76u},
+    {0xc45d1df942711d9au, 0x3ba5d0bd324f8394u},
+    {0xf5746577930d6500u, 0xca8f44ec7ee36479u},
+    {0x9968bf6abbe85f20u, 0x7e998b13cf4e1ecbu},
+    {0xbfc2ef456ae276e8u, 0x9e3fedd8c321a67eu},
+    {0xefb3ab16c59b14a2u, 0xc5cfe94ef3ea101eu},
+    {0x95d04aee3b80ece5u, 0xbba1f1d158724a12u},
+    {0xbb445da9ca61281fu, 0x2a8a6e45ae8edc97u},
+    {0xea1575143cf97226u, 0xf52d09d71a3293bdu},
+    {0x924d692ca61be758u, 0x593c2626705f9c56u},
+    {0xb6e0c377cfa2e12eu, 0x6f8b2fb00c77836cu},
+    {0xe498f455c38b997au, 0x0b6dfb9c0f956447u},
+    {0x8edf98b59a373fecu, 0x4724bd4189bd5eacu},
+    {0xb2977ee300c50fe7u, 0x58edec91ec2cb657u},
+    {0xdf3d5e9bc0f653e1u, 0x2f2967b66737e3edu},
+    {0x8b865b215899f46cu, 0xbd79e0d20082ee74u},
+    {0xae67f1e9aec07187u, 0xecd8590680a3aa11u},
+    {0xda01ee641a708de9u, 0xe80e6f4820cc9495u},
+    {0x884134fe908658b2u, 0x3109058d147fdcddu},
+    {0xaa51823e34a7eedeu, 0xbd4b46f0599fd415u},
+    {0xd4e5e2cdc1d1ea96u, 0x6c9e18ac7007c91au},
+    {0x850fadc09923329eu, 0x03e2cf6bc604ddb0u},
+    {0xa6539930bf6bff45u, 0x84db8346b786151cu},
+    {0xcfe87f7cef46ff16u, 0xe612641865679a63u},
+    {0x81f14fae158c5f6eu, 0x4fcb7e8f3f60c07eu},
+    {0xa26da3999aef7749u, 0xe3be5e330f38f09du},
+    {0xcb090c8001ab551cu, 0x5cadf5bfd3072cc5u},
+    {0xfdcb4fa002162a63u, 0x73d9732fc7c8f7f6u},
+    {0x9e9f11c4014dda7eu, 0x2867e7fddcdd9afau},
+    {0xc646d63501a1511du, 0xb281e1fd541501b8u},
+    {0xf7d88bc24209a565u, 0x1f225a7ca91a4226u},
+    {0x9ae757596946075fu, 0x3375788de9b06958u},
+    {0xc1a12d2fc3978937u, 0x0052d6b1641c83aeu},
+    {0xf209787bb47d6b84u, 0xc0678c5dbd23a49au},
+    {0x9745eb4d50ce6332u, 0xf840b7ba963646e0u},
+    {0xbd176620a501fbffu, 0xb650e5a93bc3d898u},
+    {0xec5d3fa8ce427affu, 0xa3e51f138ab4cebeu},
+    {0x93ba47c980e98cdfu, 0xc66f336c36b10137u},
+    {0xb8a8d9bbe123f017u, 0xb80b0047445d4184u},
+    {0xe6d3102ad96cec1du, 0xa60dc059157491e5u},
+    {0x9043ea1ac7e41392u, 0x87c89837ad68db2fu},
+    {0xb454e4a179dd1877u, 0x29babe4598c311fbu},
+    {0xe16a1dc9d8545e94u, 0xf4296dd6fef3d67au},
+    {0x8ce2529e2734bb1du, 0x1899e4a65f58660cu},
+    {0xb01ae745b101e9e4u, 0x5ec05dcff72e7f8fu},
+    {0xdc21a1171d42645du, 0x76707543f4fa1f73u},
+    {0x899504ae72497ebau, 0x6a06494a791c53a8u},
+    {0xabfa45da0edbde69u, 0x0487db9d17636892u},
+    {0xd6f8d7509292d603u, 0x45a9d2845d3c42b6u},
+    {0x865b86925b9bc5c2u, 0x0b8a2392ba45a9b2u},
+    {0xa7f26836f282b732u, 0x8e6cac7768d7141eu},
+    {0xd1ef0244af2364ffu, 0x3207d795430cd926u},
+    {0x8335616aed761f1fu, 0x7f44e6bd49e807b8u},
+    {0xa402b9c5a8d3a6e7u, 0x5f16206c9c6209a6u},
+    {0xcd036837130890a1u, 0x36dba887c37a8c0fu},
+    {0x802221226be55a64u, 0xc2494954da2c9789u},
+    {0xa02aa96b06deb0fdu, 0xf2db9baa10b7bd6cu},
+    {0xc83553c5c8965d3du, 0x6f92829494e5acc7u},
+    {0xfa42a8b73abbf48cu, 0xcb772339ba1f17f9u},
+    {0x9c69a97284b578d7u, 0xff2a760414536efbu},
+    {0xc38413cf25e2d70du, 0xfef5138519684abau},
+    {0xf46518c2ef5b8cd1u, 0x7eb258665fc25d69u},
+    {0x98bf2f79d5993802u, 0xef2f773ffbd97a61u},
+    {0xbeeefb584aff8603u, 0xaafb550ffacfd8fau},
+    {0xeeaaba2e5dbf6784u, 0x95ba2a53f983cf38u},
+    {0x952ab45cfa97a0b2u, 0xdd945a747bf26183u},
+    {0xba756174393d88dfu, 0x94f971119aeef9e4u},
+    {0xe912b9d1478ceb17u, 0x7a37cd5601aab85du},
+    {0x91abb422ccb812eeu, 0xac62e055c10ab33au},
+    {0xb616a12b7fe617aau, 0x577b986b314d6009u},
+    {0xe39c49765fdf9d94u, 0xed5a7e85fda0b80bu},
+    {0x8e41ade9fbebc27du, 0x14588f13be847307u},
+    {0xb1d219647ae6b31cu, 0x596eb2d8ae258fc8u},
+    {0xde469fbd99a05fe3u, 0x6fca5f8ed9aef3bbu},
+    {0x8aec23d680043beeu, 0x25de7bb9480d5854u},
+    {0xada72ccc20054ae9u, 0xaf561aa79a10ae6au},
+    {0xd910f7ff28069da4u, 0x1b2ba1518094da04u},
+    {0x87aa9aff79042286u, 0x90fb44d2f05d0842u},
+    {0xa99541bf57452b28u, 0x353a1607ac744a53u},
+    {0xd3fa922f2d1675f2u, 0x42889b8997915ce8u},
+    {0x847c9b5d7c2e09b7u, 0x69956135febada11u},
+    {0xa59bc234db398c25u, 0x43fab9837e699095u},
+    {0xcf02b2c21207ef2eu, 0x94f967e45e03f4bbu},
+    {0x8161afb94b44f57du, 0x1d1be0eebac278f5u},
+    {0xa1ba1ba79e1632dcu, 0x6462d92a69731732u},
+    {0xca28a291859bbf93u, 0x7d7b8f7503cfdcfeu},
+    {0xfcb2cb35e702af78u, 0x5cda735244c3d43eu},
+    {0x9defbf01b061adabu, 0x3a0888136afa64a7u},
+    {0xc56baec21c7a1916u, 0x088aaa1845b8fdd0u},
+    {0xf6c69a72a3989f5bu, 0x8aad549e57273d45u},
+    {0x9a3c2087a63f6399u, 0x36ac54e2f678864bu},
+    {0xc0cb28a98fcf3c7fu, 0x84576a1bb416a7ddu},
+    {0xf0fdf2d3f3c30b9fu, 0x656d44a2a11c51d5u},
+    {0x969eb7c47859e743u, 0x9f644ae5a4b1b325u},
+    {0xbc4665b596706114u, 0x873d5d9f0dde1feeu},
+    {0xeb57ff22fc0c7959u, 0xa90cb506d155a7eau},
+    {0x9316ff75dd87cbd8u, 0x09a7f12442d588f2u},
+    {0xb7dcbf5354e9beceu, 0x0c11ed6d538aeb2fu},
+    {0xe5d3ef282a242e81u, 0x8f1668c8a86da5fau},
+    {0x8fa475791a569d10u, 0xf96e017d694487bcu},
+    {0xb38d92d760ec4455u, 0x37c981dcc395a9acu},
+    {0xe070f78d3927556au, 0x85bbe253f47b1417u},
+    {0x8c469ab843b89562u, 0x93956d7478ccec8eu},
+    {0xaf58416654a6babbu, 0x387ac8d1970027b2u},
+    {0xdb2e51bfe9d0696au, 0x06997b05fcc0319eu},
+    {0x88fcf317f22241e2u, 0x441fece3bdf81f03u},
+    {0xab3c2fddeeaad25au, 0xd527e81cad7626c3u},
+    {0xd60b3bd56a5586f1u, 0x8a71e223d8d3b074u},
+    {0x85c7056562757456u, 0xf6872d5667844e49u},
+    {0xa738c6bebb12d16cu, 0xb428f8ac016561dbu},
+    {0xd106f86e69d785c7u, 0xe13336d701beba52u},
+    {0x82a45b450226b39cu, 0xecc0024661173473u},
+    {0xa34d721642b06084u, 0x27f002d7f95d0190u},
+    {0xcc20ce9bd35c78a5u, 0x31ec038df7b441f4u},
+    {0xff290242c83396ceu, 0x7e67047175a15271u},
+    {0x9f79a169bd203e41u, 0x0f0062c6e984d386u},
+    {0xc75809c42c684dd1u, 0x52c07b78a3e60868u},
+    {0xf92e0c3537826145u, 0xa7709a56ccdf8a82u},
+    {0x9bbcc7a142b17ccbu, 0x88a66076400bb691u},
+    {0xc2abf989935ddbfeu, 0x6acff893d00ea435u},
+    {0xf356f7ebf83552feu, 0x0583f6b8c4124d43u},
+    {0x98165af37b2153deu, 0xc3727a337a8b704au},
+    {0xbe1bf1b059e9a8d6u, 0x744f18c0592e4c5cu},
+    {0xeda2ee1c7064130cu, 0x1162def06f79df73u},
+    {0x9485d4d1c63e8be7u, 0x8addcb5645ac2ba8u},
+    {0xb9a74a0637ce2ee1u, 0x6d953e2bd7173692u},
+    {0xe8111c87c5c1ba99u, 0xc8fa8db6ccdd0437u},
+    {0x910ab1d4db9914a0u, 0x1d9c9892400a22a2u},
+    {0xb54d5e4a127f59c8u, 0x2503beb6d00cab4bu},
+    {0xe2a0b5dc971f303au, 0x2e44ae64840fd61du},
+    {0x8da471a9de737e24u, 0x5ceaecfed289e5d2u},
+    {0xb10d8e1456105dadu, 0x7425a83e872c5f47u},
+    {0xdd50f1996b947518u, 0xd12f124e28f77719u},
+    {0x8a5296ffe33cc92fu, 0x82bd6b70d99aaa6fu},
+    {0xace73cbfdc0bfb7bu, 0x636cc64d1001550bu},
+    {0xd8210befd30efa5au, 0x3c47f7e05401aa4eu},
+    {0x8714a775e3e95c78u, 0x65acfaec34810a71u},
+    {0xa8d9d1535ce3b396u, 0x7f1839a741a14d0du},
+    {0xd31045a8341ca07cu, 0x1ede48111209a050u},
+    {0x83ea2b892091e44du, 0x934aed0aab460432u},
+    {0xa4e4b66b68b65d60u, 0xf81da84d5617853fu},
+    {0xce1de40642e3f4b9u, 0x36251260ab9d668eu},
+    {0x80d2ae83e9ce78f3u, 0xc1d72b7c6b426019u},
+    {0xa1075a24e4421730u, 0xb24cf65b8612f81fu},
+    {0xc94930ae1d529cfcu, 0xdee033f26797b627u},
+    {0xfb9b7cd9a4a7443cu, 0x169840ef017da3b1u},
+    {0x9d412e0806e88aa5u, 0x8e1f289560ee864eu},
+    {0xc491798a08a2ad4eu, 0xf1a6f2bab92a27e2u},
+    {0xf5b5d7ec8acb58a2u, 0xae10af696774b1dbu},
+    {0x9991a6f3d6bf1765u, 0xacca6da1e0a8ef29u},
+    {0xbff610b0cc6edd3fu, 0x17fd090a58d32af3u},
+    {0xeff394dcff8a948eu, 0xddfc4b4cef07f5b0u},
+    {0x95f83d0a1fb69cd9u, 0x4abdaf101564f98eu},
+    {0xbb764c4ca7a4440fu, 0x9d6d1ad41abe37f1u},
+    {0xea53df5fd18d5513u, 0x84c86189216dc5edu},
+    {0x92746b9be2f8552cu, 0x32fd3cf5b4e49bb4u},
+    {0xb7118682dbb66a77u, 0x3fbc8c33221dc2a1u},
+    {0xe4d5e82392a40515u, 0x0fabaf3feaa5334au},
+    {0x8f05b1163ba6832du, 0x29cb4d87f2a7400eu},
+    {0xb2c71d5bca9023f8u, 0x743e20e9ef511012u},
+    {0xdf78e4b2bd342cf6u, 0x914da9246b255416u},
+    {0x8bab8eefb6409c1au, 0x1ad089b6c2f7548eu},
+    {0xae9672aba3d0c320u, 0xa184ac2473b529b1u},
+    {0xda3c0f568cc4f3e8u, 0xc9e5d72d90a2741eu},
+    {0x8865899617fb1871u, 0x7e2fa67c7a658892u},
+    {0xaa7eebfb9df9de8du, 0xddbb901b98feeab7u},
+    {0xd51ea6fa85785631u, 0x552a74227f3ea565u},
+    {0x8533285c936b35deu, 0xd53a88958f87275fu},
+    {0xa67ff273b8460356u, 0x8a892abaf368f137u},
+    {0xd01fef10a657842cu, 0x2d2b7569b0432d85u},
+    {0x8213f56a67f6b29bu, 0x9c3b29620e29fc73u},
+    {0xa298f2c501f45f42u, 0x8349f3ba91b47b8fu},
+    {0xcb3f2f7642717713u, 0x241c70a936219a73u},
+    {0xfe0efb53d30dd4d7u, 0xed238cd383aa0110u},
+    {0x9ec95d1463e8a506u, 0xf4363804324a40aau},
+    {0xc67bb4597ce2ce48u, 0xb143c6053edcd0d5u},
+    {0xf81aa16fdc1b81dau, 0xdd94b7868e94050au},
+    {0x9b10a4e5e9913128u, 0xca7cf2b4191c8326u},
+    {0xc1d4ce1f63f57d72u, 0xfd1c2f611f63a3f0u},
+    {0xf24a01a73cf2dccfu, 0xbc633b39673c8cecu},
+    {0x976e41088617ca01u, 0xd5be0503e085d813u},
+    {0xbd49d14aa79dbc82u, 0x4b2d8644d8a74e18u},
+    {0xec9c459d51852ba2u, 0xddf8e7d60ed1219eu},
+    {0x93e1ab8252f33b45u, 0xcabb90e5c942b503u},
+    {0xb8da1662e7b00a17u, 0x3d6a751f3b936243u},
+    {0xe7109bfba19c0c9du, 0x0cc512670a783ad4u},
+    {0x906a617d450187e2u, 0x27fb2b80668b24c5u},
+    {0xb484f9dc9641e9dau, 0xb1f9f660802dedf6u},
+    {0xe1a63853bbd26451u, 0x5e7873f8a0396973u},
+    {0x8d07e33455637eb2u, 0xdb0b487b6423e1e8u},
+    {0xb049dc016abc5e5fu, 0x91ce1a9a3d2cda62u},
+    {0xdc5c5301c56b75f7u, 0x7641a140cc7810fbu},
+    {0x89b9b3e11b6329bau, 0xa9e904c87fcb0a9du},
+    {0xac2820d9623bf429u, 0x546345fa9fbdcd44u},
+    {0xd732290fbacaf133u, 0xa97c177947ad4095u},
+    {0x867f59a9d4bed6c0u, 0x49ed8eabcccc485du},
+    {0xa81f301449ee8c70u, 0x5c68f256bfff5a74u},
+    {0xd226fc195c6a2f8cu, 0x73832eec6fff3111u},
+    {0x83585d8fd9c25db7u, 0xc831fd53c5ff7eabu},
+    {0xa42e74f3d032f525u, 0xba3e7ca8b77f5e55u},
+    {0xcd3a1230c43fb26fu, 0x28ce1bd2e55f35ebu},
+    {0x80444b5e7aa7cf85u, 0x7980d163cf5b81b3u},
+    {0xa0555e361951c366u, 0xd7e105bcc332621fu},
+    {0xc86ab5c39fa63440u, 0x8dd9472bf3fefaa7u},
+    {0xfa856334878fc150u, 0xb14f98f6f0feb951u},
+    {0x9c935e00d4b9d8d2u, 0x6ed1bf9a569f33d3u},
+    {0xc3b8358109e84f07u, 0x0a862f80ec4700c8u},
+    {0xf4a642e14c6262c8u, 0xcd27bb612758c0fau},
+    {0x98e7e9cccfbd7dbdu, 0x8038d51cb897789cu},
+    {0xbf21e44003acdd2cu, 0xe0470a63e6bd56c3u},
+    {0xeeea5d5004981478u, 0x1858ccfce06cac74u},
+    {0x95527a5202df0ccbu, 0x0f37801e0c43ebc8u},
+    {0xbaa718e68396cffdu, 0xd30560258f54e6bau},
+    {0xe950df20247c83fdu, 0x47c6b82ef32a2069u},
+    {0x91d28b7416cdd27eu, 0x4cdc331d57fa5441u},
+    {0xb6472e511c81471du, 0xe0133fe4adf8e952u},
+    {0xe3d8f9e563a198e5u, 0x58180fddd97723a6u},
+    {0x8e679c2f5e44ff8fu, 0x570f09eaa7ea7648u},
+};
+
+static void lept_mul128(uint64_t a, uint64_t b, uint64_t *hi, uint64_t *lo) {
+
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 uint128;
+    uint128 r = (uint128) a * b;
+    *hi = (uint64_t) (r >> 64);
+    *lo = (uint64_t) r;
+#else
+    uint64_t a0 = a & 0xFFFFFFFFu, a1 = a >> 32, b0 = b & 0xFFFFFFFFu, b1 = b >> 32;
+    uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    uint64_t mid = (p00 >> 32) + (p01 & 0xFFFFFFFFu) + (p10 & 0xFFFFFFFFu);
+    *lo = (mid << 32) | (p00 & 0xFFFFFFFFu);
+    *hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+#endif
+}
+
+static int lept_clz64(uint64_t x) {
+
+    assert(x != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    while (!(x & 0x8000000000000000u)) {
+        x <<= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+static double lept_double_from_bits(uint64_t bits) {
+
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+/* m * 10^q 的 IEEE 754 编码 (不含符号位), 不能确定正确舍入时返回 0 */
+/* 也就是说 0 既不是 +0 也不是其他结果, 0 和 inf 由调用者在外面处理 */
+static int lept_eisel_lemire(uint64_t m, int q, uint64_t *bits) {
+
+    uint64_t hi, lo, hi2, lo2, mantissa;
+    int lz, upper, shift, power2;
+    const uint64_t *pow5;
+
+    assert(m != 0 && q >= LEPT_POW5_MIN_EXP10 && q <= LEPT_POW5_MAX_EXP10);
+    pow5 = lept_pow5_128[q - LEPT_POW5_MIN_EXP10];
+    lz = lept_clz64(m);
+    m <<= lz;
+
+    //只需要高 55 位是准确的, 其余位全为 1 时才需要用到 5^q 的低 64 位
+    lept_mul128(m, pow5[0], &hi, &lo);
+    if ((hi & 0x1FF) == 0x1FF) {
+        lept_mul128(m, pow5[1], &hi2, &lo2);
+        lo += hi2;
+        if (hi2 > lo)
+            hi++;
+    }
+    //近似值的误差可能影响结果, 交给慢速路径
+    if (lo == 0xFFFFFFFFFFFFFFFFu && (q < -27 || q > 55))
+        return 0;
+
+    upper = (int) (hi >> 63);
+    shift = upper + 64 - 52 - 3;
+    mantissa = hi >> shift;
+    //floor(log2(10^q)) + 63, 右移负数按算术右移处理
+    power2 = (((152170 + 65536) * q) >> 16) + 63 + upper - lz + 1023;
+
+    if (power2 <= 0) {
+        //非规格化数
+        if (-power2 + 1 >= 64)
+            return 0;
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        power2 = mantissa < ((uint64_t) 1 << 52) ? 0 : 1;
+        *bits = (mantissa & (((uint64_t) 1 << 52) - 1)) | (uint64_t) power2 << 52;
+        return *bits != 0;
+    }
+    //正好在两个 double 中间时向偶数舍入, 只有 q 在 [-4, 23] 时乘积才可能是精确的
+    if (lo <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && (mantissa << shift) == hi)
+        mantissa &= ~(uint64_t) 1;
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= ((uint64_t) 2 << 52)) {
+        mantissa = (uint64_t) 1 << 52;
+        power2++;
+    }
+    if (power2 >= 0x7FF)
+        return 0;
+    *bits = (mantissa & (((uint64_t) 1 << 52) - 1)) | (uint64_t) power2 << 52;
+    return 1;
+}
+
+/* 慢速路径: 十进制大数 0.d[0]d[1]...d[nd-1] * 10^dp, 每一位存 0-9, 超出的非零位只记录 trunc */
+#define LEPT_DECIMAL_DIGITS 800
+#define LEPT_DECIMAL_MAX_SHIFT 60
+
+typedef struct {
+    unsigned char d[LEPT_DECIMAL_DIGITS];
+    int nd, dp, trunc;
+} lept_decimal;
+
+static void lept_decimal_trim(lept_decimal *a) {
+
+    while (a->nd > 0 && a->d[a->nd - 1] == 0)
+        a->nd--;
+    if (a->nd == 0)
+        a->dp = 0;
+}
+
+static void lept_decimal_right_shift(lept_decimal *a, unsigned k) {
+
+    int r = 0, w = 0;
+    uint64_t n = 0, mask = ((uint64_t) 1 << k) - 1;
+    //先读入足够多的位, 使第一次右移后非零
+    for (; (n >> k) == 0; r++) {
+        if (r >= a->nd) {
+            if (n == 0) {
+                a->nd = 0;
+                return;
+            }
+            while ((n >> k) == 0) {
+                n *= 10;
+                r++;
+            }
+            break;
         }
+        n = n * 10 + a->d[r];
     }
+    a->dp -= r - 1;
+    for (; r < a->nd; r++) {
+        unsigned char dig = (unsigned char) (n >> k);
+        n &= mask;
+        a->d[w++] = dig;
+        n = n * 10 + a->d[r];
+    }
+    while (n > 0) {
+        unsigned char dig = (unsigned char) (n >> k);
+        n &= mask;
+        if (w < LEPT_DECIMAL_DIGITS)
+            a->d[w++] = dig;
+        else if (dig > 0)
+            a->trunc = 1;
+        n *= 10;
+    }
+    a->nd = w;
+    lept_decimal_trim(a);
+}
 
-    v->type = type;
-    return 0;
+static void lept_decimal_left_shift(lept_decimal *a, unsigned k) {
+
+    //2^60 < 10^19, 最多多出 19 位, 从低位往高位写到临时缓冲区里
+    unsigned char tmp[LEPT_DECIMAL_DIGITS + 19];
+    int r, top = a->nd + 19, w = top, count;
+    uint64_t n = 0, q;
+    for (r = a->nd - 1; r >= 0; r--) {
+        n += (uint64_t) a->d[r] << k;
+        q = n / 10;
+        tmp[--w] = (unsigned char) (n - 10 * q);
+        n = q;
+    }
+    while (n > 0) {
+        q = n / 10;
+        tmp[--w] = (unsigned char) (n - 10 * q);
+        n = q;
+    }
+    count = top - w;
+    a->dp += count - a->nd;
+    if (count > LEPT_DECIMAL_DIGITS) {
+        for (r = w + LEPT_DECIMAL_DIGITS; r < top; r++)
+            if (tmp[r])
+                a->trunc = 1;
+        count = LEPT_DECIMAL_DIGITS;
+    }
+    memcpy(a->d, tmp + w, count);
+    a->nd = count;
+    lept_decimal_trim(a);
+}
+
+static void lept_decimal_shift(lept_decimal *a, int k) {
+
+    if (a->nd == 0)
+        return;
+    for (; k > LEPT_DECIMAL_MAX_SHIFT; k -= LEPT_DECIMAL_MAX_SHIFT)
+        lept_decimal_left_shift(a, LEPT_DECIMAL_MAX_SHIFT);
+    for (; k < -LEPT_DECIMAL_MAX_SHIFT; k += LEPT_DECIMAL_MAX_SHIFT)
+        lept_decimal_right_shift(a, LEPT_DECIMAL_MAX_SHIFT);
+    if (k > 0)
+        lept_decimal_left_shift(a, (unsigned) k);
+    else if (k < 0)
+        lept_decimal_right_shift(a, (unsigned) -k);
+}
+
+/* 小数点后第 nd 位开始舍入时是否进位, 正好一半时向偶数舍入 */
+static int lept_decimal_round_up(const lept_decimal *a, int nd) {
+
+    if (nd < 0 || nd >= a->nd)
+        return 0;
+    if (a->d[nd] == 5 && nd + 1 == a->nd) {
+        if (a->trunc)
+            return 1;
+        return nd > 0 && a->d[nd - 1] % 2 == 1;
+    }
+    return a->d[nd] >= 5;
+}
+
+static uint64_t lept_decimal_rounded_integer(const lept_decimal *a) {
+
+    int i;
+    uint64_t n = 0;
+    assert(a->dp <= 20);
+    for (i = 0; i < a->dp && i < a->nd; i++)
+        n = n * 10 + a->d[i];
+    for (; i < a->dp; i++)
+        n *= 10;
+    if (lept_decimal_round_up(a, a->dp))
+        n++;
+    return n;
+}
+
+/* json 是已经验证过的数字 (不含符号), 返回 IEEE 754 编码 (不含符号位), 溢出时为 inf */
+static uint64_t lept_decimal_to_bits(const char *json, const char *end) {
+
+    static const int powtab[] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+    const int bias = -1023;
+    lept_decimal a;
+    const char *p = json;
+    int exp, e = 0, esign = 1, sawdot = 0;
+    uint64_t mantissa;
+
+    a.nd = a.dp = a.trunc = 0;
+    for (; p != end && (ISDIGIT(*p) || *p == '.'); p++) {
+        if (*p == '.') {
+            sawdot = 1;
+            a.dp = a.nd;
+        } else if (*p == '0' && a.nd == 0) {
+            a.dp--; //前导 0
+        } else if (a.nd < LEPT_DECIMAL_DIGITS) {
+            a.d[a.nd++] = (unsigned char) (*p - '0');
+        } else if (*p != '0') {
+            a.trunc = 1;
+        }
+    }
+    if (!sawdot)
+        a.dp = a.nd;
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (*p == '+' || *p == '-')
+            esign = *p++ == '-' ? -1 : 1;
+        for (; p != end && ISDIGIT(*p); p++)
+            if (e < 10000)
+                e = e * 10 + (*p - '0');
+        a.dp += e * esign;
+    }
+    lept_decimal_trim(&a);
+
+    if (a.nd == 0 || a.dp < -330)
+        return 0;
+    if (a.dp > 310)
+        return (uint64_t) 0x7FF << 52;
+
+    //缩放到 [0.5, 1)
+    exp = 0;
+    while (a.dp > 0) {
+        int n = a.dp >= 9 ? 27 : powtab[a.dp];
+        lept_decimal_shift(&a, -n);
+        exp += n;
+    }
+    while (a.dp < 0 || (a.dp == 0 && a.d[0] < 5)) {
+        int n = -a.dp >= 9 ? 27 : powtab[-a.dp];
+        lept_decimal_shift(&a, n);
+        exp -= n;
+    }
+    //[0.5, 1) -> [1, 2)
+    exp--;
+    if (exp < bias + 1) {
+        int n = bias + 1 - exp;
+        lept_decimal_shift(&a, -n);
+        exp += n;
+    }
+    if (exp - bias >= 0x7FF)
+        return (uint64_t) 0x7FF << 52;
+
+    lept_decimal_shift(&a, 1 + 52);
+    mantissa = lept_decimal_rounded_integer(&a);
+    if (mantissa == (uint64_t) 2 << 52) {
+        mantissa >>= 1;
+        exp++;
+        if (exp - bias >= 0x7FF)
+            return (uint64_t) 0x7FF << 52;
+    }
+    //非规格化数
+    if (!(mantissa & ((uint64_t) 1 << 52)))
+        exp = bias;
+    return (mantissa & (((uint64_t) 1 << 52) - 1)) | (uint64_t) (exp - bias) << 52;
 }
 
 /**
@@ -104,63 +1363,142 @@ static int lept_parse_number(lept_context *c, lept_value *v) {
 
     //负号->整数->小数->指数
     //^-?(0|[1-9]\d*)(\.\d+)?([eE][+-]?\d+)?$
-    //takes as many characters as possible to form a valid floating point representation
-    //做数字转换都是这种思想, 基本不会出错, 转换尽可能多的字符, 剩下的不动, 原样返回
-    const char *p = c->json;
-    if (*p == '-') p++;
-    if (*p == '0') p++;
+    //验证的同时把前 19 位有效数字累加到 m 里, 小数点和丢掉的整数位折算进 exp10
+#define CH(p) ((p) != end ? *(p) : '\0')
+    const char *p = c->json, *end = c->end, *digits;
+    uint64_t m = 0, bits, bits2;
+    int neg = 0, ndigits = 0, truncated = 0, exp10 = 0, e = 0;
+    if (CH(p) == '-') {
+        neg = 1;
+        p++;
+    }
+    digits = p;
+    if (CH(p) == '0') p++;
     else {
-        if (!ISDIGIT1TO9(*p)) return LEPT_PARSE_INVALID_VALUE;
-        for (p++; ISDIGIT(*p); p++);
+        if (!ISDIGIT1TO9(CH(p))) return LEPT_PARSE_INVALID_VALUE;
+        for (; ISDIGIT(CH(p)); p++) {
+            if (ndigits < 19) {
+                m = m * 10 + (*p - '0');
+                ndigits++;
+            } else {
+                truncated |= *p != '0';
+                exp10++;
+            }
+        }
     }
-    if (*p == '.') {
+    if (CH(p) == '.') {
         p++;
-        if (!ISDIGIT(*p)) return LEPT_PARSE_INVALID_VALUE;
-        for (p++; ISDIGIT(*p); p++);
+        if (!ISDIGIT(CH(p))) return LEPT_PARSE_INVALID_VALUE;
+        for (; ISDIGIT(CH(p)); p++) {
+            if (m == 0 && *p == '0') {
+                exp10--; //前导 0 不算有效数字
+            } else if (ndigits < 19) {
+                m = m * 10 + (*p - '0');
+                ndigits++;
+                exp10--;
+            } else {
+                truncated |= *p != '0';
+            }
+        }
     }
-    if (*p == 'e' || *p == 'E') {
+    if (CH(p) == 'e' || CH(p) == 'E') {
+        int esign = 1;
         p++;
-        if (*p == '+' || *p == '-') p++;
-        if (!ISDIGIT(*p)) return LEPT_PARSE_INVALID_VALUE;
-        for (p++; ISDIGIT(*p); p++);
+        if (CH(p) == '+' || CH(p) == '-')
+            esign = *p++ == '-' ? -1 : 1;
+        if (!ISDIGIT(CH(p))) return LEPT_PARSE_INVALID_VALUE;
+        for (; ISDIGIT(CH(p)); p++)
+            if (e < 100000)
+                e = e * 10 + (*p - '0');
+        exp10 += esign * e;
     }
+#undef CH
 
-    errno = 0;
-    v->u.n = strtod(c->json, NULL);
-    if (errno == ERANGE && (v->u.n == HUGE_VAL || v->u.n == -HUGE_VAL))
-        return LEPT_PARSE_NUMBER_TOO_BIG; //HUGE_VAL == inf
+    if (m == 0) {
+        bits = 0;
+    } else if (!truncated && m <= ((uint64_t) 1 << 53) && exp10 == 0) {
+        //整数
+        bits = 0;
+        v->u.n = neg ? -(double) m : (double) m;
+        goto done;
+    }
+#if FLT_EVAL_METHOD == 0
+    else if (!truncated && m <= ((uint64_t) 1 << 53) && exp10 >= -22 && exp10 <= 22) {
+        //m 和 10^|exp10| 都能精确表示, 一次运算只有一次舍入
+        static const double pow10[] = {
+                1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        double d = exp10 < 0 ? (double) m / pow10[-exp10] : (double) m * pow10[exp10];
+        v->u.n = neg ? -d : d;
+        goto done;
+    }
+#endif
+    else if (exp10 < LEPT_POW5_MIN_EXP10) {
+        bits = 0; //19 位有效数字乘以 10^-343 已经小于最小非规格化数的一半
+    } else if (exp10 > LEPT_POW5_MAX_EXP10) {
+        bits = (uint64_t) 0x7FF << 52;
+    } else if (!lept_eisel_lemire(m, exp10, &bits) ||
+               (truncated && (!lept_eisel_lemire(m + 1, exp10, &bits2) || bits != bits2))) {
+        //被截断的尾数在 m 和 m + 1 之间, 两端结果一样才是确定的
+        bits = lept_decimal_to_bits(digits, p);
+    }
+    if (bits == (uint64_t) 0x7FF << 52)
+        return LEPT_PARSE_NUMBER_TOO_BIG;
+    v->u.n = lept_double_from_bits(bits | (uint64_t) neg << 63);
 
+done:
     c->json = p;
     v->type = LEPT_NUMBER;
 
     return LEPT_PARSE_OK;
 }
 
-void lept_free(lept_value *v) {
+/* 值自己分配的内存都来自 a */
+static void lept_free_value(lept_value *v, const lept_allocator *a) {
 
     assert(v != NULL);
     switch (v->type) {
         case LEPT_STRING:
-            free(v->u.s.s);
+            if (!(v->flags & (LEPT_VALUE_BORROWED | LEPT_VALUE_INLINE)))
+                lept_mem_free(a, v->u.s);
             break;
         case LEPT_ARRAY:
+            if (v->flags & LEPT_VALUE_LAZY)
+                break; //还没有展开, 也没有分配过内存
             //解析失败则类型为NULL, 就不会进入到这里面来
             //free 每一个元素指向的地址, 但容器本身没有 free
-            for (size_t i = 0; i < v->u.a.size; i++)
-                lept_free(&v->u.a.e[i]);
-            free(v->u.a.e); //每一个 malloc 都要有相应的 free
+            //借用的数组里的元素也可能被 lept_set_* 改成了自己分配的内存, 所以仍然要递归
+            for (size_t i = 0; i < v->size; i++)
+                lept_free_value(&v->u.e[i], a);
+            if (!(v->flags & LEPT_VALUE_BORROWED))
+                lept_mem_free(a, v->u.e); //每一个 malloc 都要有相应的 free
             break;
         case LEPT_OBJECT:
-            for (size_t i = 0; i < v->u.o.size; i++) {
-                free(v->u.o.m[i].k);
-                lept_free(&v->u.o.m[i].v);
+            if (v->flags & LEPT_VALUE_LAZY)
+                break;
+            for (size_t i = 0; i < v->size; i++) {
+                lept_free_value(&v->u.m[i].k, a); //key 自己的 flags 决定是否需要释放
+                lept_free_value(&v->u.m[i].v, a);
             }
-            free(v->u.o.m);
+            if (!(v->flags & LEPT_VALUE_BORROWED))
+                lept_mem_free(a, v->u.m);
             break;
         default:
             break;
     }
     v->type = LEPT_NULL;
+    v->flags = 0;
+}
+
+void lept_free(lept_value *v) {
+
+    lept_free_value(v, NULL);
+}
+
+void lept_free_with(lept_value *v, const lept_allocator *a) {
+
+    lept_free_value(v, a);
 }
 
 static int hex_to_int(char h) {
@@ -172,9 +1510,11 @@ static int hex_to_int(char h) {
     return h - '0';
 }
 
-static const char *lept_parse_hex4(const char *p, unsigned *u) {
+static const char *lept_parse_hex4(const char *p, const char *end, unsigned *u) {
 
     *u = 0;
+    if (end - p < 4)
+        return NULL;
     for (int i = 0; i < 4; i++, p++) {
         if (!ISHEX(*p))
             return NULL;
@@ -183,103 +1523,237 @@ static const char *lept_parse_hex4(const char *p, unsigned *u) {
     return p;
 }
 
-static void lept_encode_utf8(lept_context *c, unsigned u) {
+static size_t lept_encode_utf8(char *buf, unsigned u) {
 
     if (u <= 0x7F) {
-        PUTC(c, u);
+        buf[0] = u;
+        return 1;
     } else if (u <= 0x07FF) {
-        PUTC(c, 0xC0 | ((u >> 6) & 0xFF));
-        PUTC(c, 0x80 | (u & 0x3F));
+        buf[0] = 0xC0 | ((u >> 6) & 0xFF);
+        buf[1] = 0x80 | (u & 0x3F);
+        return 2;
     } else if (u <= 0xFFFF) {
-        PUTC(c, 0xE0 | ((u >> 12) & 0xFF)); /* 0xE0 = 11100000 */
-        PUTC(c, 0x80 | ((u >> 6) & 0x3F)); /* 0x80 = 10000000 */
-        PUTC(c, 0x80 | (u & 0x3F)); /* 0x3F = 00111111 */
+        buf[0] = 0xE0 | ((u >> 12) & 0xFF); /* 0xE0 = 11100000 */
+        buf[1] = 0x80 | ((u >> 6) & 0x3F); /* 0x80 = 10000000 */
+        buf[2] = 0x80 | (u & 0x3F); /* 0x3F = 00111111 */
+        return 3;
     } else {
         assert(u <= 0x10FFFF); //果然是厉害的程序员, 这一招就比我厉害多了
-        PUTC(c, 0xF0 | ((u >> 18) & 0xFF));
-        PUTC(c, 0x80 | ((u >> 12) & 0x3F));
-        PUTC(c, 0x80 | ((u >> 6) & 0x3F));
-        PUTC(c, 0x80 | (u & 0x3F));
+        buf[0] = 0xF0 | ((u >> 18) & 0xFF);
+        buf[1] = 0x80 | ((u >> 12) & 0x3F);
+        buf[2] = 0x80 | ((u >> 6) & 0x3F);
+        buf[3] = 0x80 | (u & 0x3F);
+        return 4;
+    }
+}
+
+/* 解析 '\\' 后面的转义序列, *pp 指向 '\\' 的下一个字符, 解码出的字节 (最多 4 个) 写入 buf */
+/* 先读完整个转义序列再写 buf, 所以 buf 可以和输入重叠 (in situ 解析) */
+static int lept_parse_escape(const char **pp, const char *end, char *buf, size_t *n) {
+
+    const char *p = *pp;
+    unsigned u;
+    *n = 1;
+    if (p == end)
+        return LEPT_PARSE_MISS_QUOTATION_MARK;
+    switch (*p++) {
+        case '"':
+            buf[0] = '"';
+            break;
+        case '\\':
+            buf[0] = '\\';
+            break;
+        case '/':
+            buf[0] = '/';
+            break;
+        case 'b':
+            buf[0] = '\b';
+            break;
+        case 'f':
+            buf[0] = '\f';
+            break;
+        case 'n':
+            buf[0] = '\n';
+            break;
+        case 'r':
+            buf[0] = '\r';
+            break;
+        case 't':
+            buf[0] = '\t';
+            break;
+        case 'u':
+            //遇到 \uXXXX, 则解析出四位 hex 字符, 解析成功返回 p 的新位置, u 为解析出的 code point, 失败返回 NULL
+            if (!(p = lept_parse_hex4(p, end, &u)))
+                return LEPT_PARSE_INVALID_UNICODE_HEX;
+
+            //如果解析出的 u 位于高代理范围内, 则继续解析低代理对
+            if (u >= 0xD800 && u <= 0xDBFF) {
+                unsigned u2;
+                if (end - p < 2 || *p++ != '\\' || *p++ != 'u')
+                    return LEPT_PARSE_INVALID_UNICODE_SURROGATE;
+
+                if (!(p = lept_parse_hex4(p, end, &u2)))
+                    return LEPT_PARSE_INVALID_UNICODE_HEX;
+
+                if (u2 > 0xDFFF || u2 < 0xDC00)
+                    return LEPT_PARSE_INVALID_UNICODE_SURROGATE;
+                //将 (H,L) 代理对转换为真实的 code point
+                u = 0x10000 + (u - 0xD800) * 0x400 + (u2 - 0xDC00);
+            } else if (u >= 0xDC00 && u <= 0xDCFF) {//位于低代理位
+                return LEPT_PARSE_INVALID_UNICODE_SURROGATE;
+            }
+            //将 code point 按照 utf8 编码为多个字节
+            *n = lept_encode_utf8(buf, u);
+            break;
+        default:
+            return LEPT_PARSE_INVALID_STRING_ESCAPE;
+    }
+    *pp = p;
+    return LEPT_PARSE_OK;
+}
+
+/* 字符串扫描: 返回 [p, end) 中第一个 '"', '\\' 或 < 0x20 的字节的位置, 没有则返回 end */
+/* 每一级处理到剩余字节不够一个块为止 (或者找到了), 由下一级接着处理, 找到的字节在下一级的第一个块里会立即返回 */
+#define LEPT_STRING_SPECIAL(ch) ((ch) == '"' || (ch) == '\\' || (unsigned char) (ch) < 0x20)
+
+#ifdef LEPT_AVX2
+__attribute__((target("avx2")))
+static const char *lept_scan_string_avx2(const char *p, const char *end) {
+
+    const __m256i quote = _mm256_set1_epi8('"'), backslash = _mm256_set1_epi8('\\');
+    const __m256i ctrl = _mm256_set1_epi8(0x1F);
+    for (; end - p >= 32; p += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) p);
+        __m256i t = _mm256_or_si256(_mm256_cmpeq_epi8(x, quote), _mm256_cmpeq_epi8(x, backslash));
+        //无符号比较 x <= 0x1F 等价于 max(x, 0x1F) == 0x1F
+        t = _mm256_or_si256(t, _mm256_cmpeq_epi8(_mm256_max_epu8(x, ctrl), ctrl));
+        unsigned mask = (unsigned) _mm256_movemask_epi8(t);
+        if (mask)
+            return p + lept_ctz(mask);
+    }
+    return p;
+}
+#endif
+
+static const char *lept_scan_string(const char *p, const char *end) {
+
+#ifdef LEPT_AVX2
+    if (end - p >= 64 && __builtin_cpu_supports("avx2"))
+        p = lept_scan_string_avx2(p, end);
+#endif
+#ifdef LEPT_SSE2
+    {
+        const __m128i quote = _mm_set1_epi8('"'), backslash = _mm_set1_epi8('\\');
+        const __m128i ctrl = _mm_set1_epi8(0x1F);
+        for (; end - p >= 16; p += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i *) p);
+            __m128i t = _mm_or_si128(_mm_cmpeq_epi8(x, quote), _mm_cmpeq_epi8(x, backslash));
+            t = _mm_or_si128(t, _mm_cmpeq_epi8(_mm_max_epu8(x, ctrl), ctrl));
+            unsigned mask = (unsigned) _mm_movemask_epi8(t);
+            if (mask)
+                return p + lept_ctz(mask);
+        }
+    }
+#endif
+    //SWAR: 一次检查 8 个字节, 有命中时再逐字节找, 不依赖字节序
+    for (; end - p >= 8; p += 8) {
+        uint64_t x, t;
+        const uint64_t ones = 0x0101010101010101u, highs = 0x8080808080808080u;
+        memcpy(&x, p, 8);
+        t = ((x ^ (ones * '"')) - ones) & ~(x ^ (ones * '"'));
+        t |= ((x ^ (ones * '\\')) - ones) & ~(x ^ (ones * '\\'));
+        t |= (x - ones * 0x20) & ~x;
+        if (t & highs)
+            break;
+    }
+    while (p != end && !LEPT_STRING_SPECIAL(*p))
+        p++;
+    return p;
+}
+
+/* in situ: 直接在输入缓冲区里反转义, 结果不会比原文长, 写指针 w 永远不会超过读指针 p */
+/* str 指向输入缓冲区, 结尾的 '"' (或更前面的位置) 被改写为 '\0' */
+static int lept_parse_string_insitu(lept_context *c, char **str, size_t *len) {
+
+    char *head = (char *) c->json;
+    char *w = head;
+    const char *p = c->json, *end = c->end;
+    size_t n;
+    int ret;
+    for (;;) {
+        //不需要处理的一段直接整体移动, 还没遇到转义时 w == p, 什么都不用做
+        const char *q = lept_scan_string(p, end);
+        if (w != p)
+            memmove(w, p, q - p);
+        w += q - p;
+        p = q;
+        if (p == end)
+            return LEPT_PARSE_MISS_QUOTATION_MARK;
+        char ch = *p++;
+        switch (ch) {
+            case '\\':
+                if ((ret = lept_parse_escape(&p, end, w, &n)) != LEPT_PARSE_OK)
+                    return ret;
+                w += n;
+                break;
+            case '"':
+                *str = head;
+                *len = w - head;
+                *w = '\0';
+                c->json = p;
+                return LEPT_PARSE_OK;
+            default:
+                assert((unsigned char) ch < 0x20);
+                return LEPT_PARSE_INVALID_STRING_CHAR;
+        }
     }
 }
 
 /* 解析 JSON 字符串，把结果写入 str 和 len */
 /* str 指向 c->stack 中的元素，需要在 c->stack  */
+/* 没有转义的字符串不经过 c->stack, str 直接指向输入 (只读) */
 static int lept_parse_string_raw(lept_context *c, char **str, size_t *len) {
     //1. 尽可能多的解析字符吗?
     //2. 解析完成的字符如何拷贝?
     //3. 对于转义字符, 读入内存后会以什么样的形式给我呢? 比如说 '\n' 是两个字符还是一个 ord==10 的字符?
     //那么对于C语言中非法的转义, 结果会是怎么样的呢? => 对于非法的转义如 '\x', 编译器会去掉 '\', 只剩下 'x'
 
+    if (c->insitu)
+        return lept_parse_string_insitu(c, str, len);
+
     size_t head = c->top;
-    unsigned u;
-    const char *p = c->json;
+    char buf[4];
+    size_t n;
+    int ret;
+    const char *p = c->json, *end = c->end;
+
+    p = lept_scan_string(p, end);
+    if (p != end && *p == '"') {
+        *str = (char *) c->json;
+        *len = p - c->json;
+        c->json = p + 1;
+        return LEPT_PARSE_OK;
+    }
+    if (p != c->json)
+        PUTS(c, c->json, p - c->json);
     for (;;) {
+        if (p == end) {
+            //JSON 中允许字符串中间出现\0, 怎么办? 是以\u0000的形式出现的, 在转义中处理了
+            //没有转义的 '\0' 和其他控制字符一样是非法字符
+            STRING_ERROR(LEPT_PARSE_MISS_QUOTATION_MARK);
+        }
         char ch = *p++;
         switch (ch) {
             case '\\':
-                switch (*p++) {
-                    case '"':
-                        PUTC(c, '"');
-                        break;
-                    case '\\':
-                        PUTC(c, '\\');
-                        break;
-                    case '/':
-                        PUTC(c, '/');
-                        break;
-                    case 'b':
-                        PUTC(c, '\b');
-                        break;
-                    case 'f':
-                        PUTC(c, '\f');
-                        break;
-                    case 'n':
-                        PUTC(c, '\n');
-                        break;
-                    case 'r':
-                        PUTC(c, '\r');
-                        break;
-                    case 't':
-                        PUTC(c, '\t');
-                        break;
-                    case 'u':
-                        //遇到 \uXXXX, 则解析出四位 hex 字符, 解析成功返回 p 的新位置, u 为解析出的 code point, 失败返回 NULL
-                        if (!(p = lept_parse_hex4(p, &u)))
-                            STRING_ERROR(LEPT_PARSE_INVALID_UNICODE_HEX);
-
-                        //todo 如果处于低代理范围, 则报错
-                        //如果解析出的 u 位于高代理范围内, 则继续解析低代理对
-                        if (u >= 0xD800 && u <= 0xDBFF) {
-                            unsigned u2;
-                            if (*p++ != '\\' || *p++ != 'u')
-                                STRING_ERROR(LEPT_PARSE_INVALID_UNICODE_SURROGATE);
-
-                            if (!(p = lept_parse_hex4(p, &u2)))
-                                STRING_ERROR(LEPT_PARSE_INVALID_UNICODE_HEX);
-
-                            if (u2 > 0xDFFF || u2 < 0xDC00)
-                                STRING_ERROR(LEPT_PARSE_INVALID_UNICODE_SURROGATE);
-                            //将 (H,L) 代理对转换为真实的 code point
-                            u = 0x10000 + (u - 0xD800) * 0x400 + (u2 - 0xDC00);
-                        } else if (u >= 0xDC00 && u <= 0xDCFF) {//位于低代理位
-                            STRING_ERROR(LEPT_PARSE_INVALID_UNICODE_SURROGATE);
-                        }
-                        //将 code point 按照 utf8 编码为多个字节, 写入到缓冲区中
-                        lept_encode_utf8(c, u);
-                        break;
-                    default:
-                        STRING_ERROR(LEPT_PARSE_INVALID_STRING_ESCAPE);
-                }
+                if ((ret = lept_parse_escape(&p, end, buf, &n)) != LEPT_PARSE_OK)
+                    STRING_ERROR(ret);
+                PUTS(c, buf, n);
                 break;
             case '"':
                 *len = c->top - head;
                 *str = lept_context_pop(c, *len);
                 c->json = p;
                 return LEPT_PARSE_OK;
-            case '\0':
-                //JSON 中允许字符串中间出现\0, 怎么办? 是以\u0000的形式出现的, 在转义中处理了
-                STRING_ERROR(LEPT_PARSE_MISS_QUOTATION_MARK);
             default:
                 //处理不合法的非转义字符
                 //unescaped = %x20-21 / %x23-5B / %x5D-10FFFF
@@ -289,156 +1763,388 @@ static int lept_parse_string_raw(lept_context *c, char **str, size_t *len) {
                 //0x20为空格，0x20之前的都是非打印字符
                 if ((unsigned char) ch < 0x20)
                     STRING_ERROR(LEPT_PARSE_INVALID_STRING_CHAR);
-                PUTC(c, ch);
+                {
+                    //普通字符一段一段地拷贝
+                    const char *q = lept_scan_string(p, end);
+                    --p;
+                    PUTS(c, p, q - p);
+                    p = q;
+                }
         }
     }
 }
 
-static int lept_parse_string(lept_context *c, lept_value *v) {
-
-    EXPECT(c, '"');
-    char *str = NULL;
-    size_t len = 0;
-    //应该先定义变量分配了内存之后, 取地址传给函数, 而不是声明指针(没有指向实体)
-    int ret = lept_parse_string_raw(c, &str, &len);
-    if (ret != LEPT_PARSE_OK) return ret;
+/* 短字符串直接拷贝到值里, 不分配内存; s 可以指向 v 自己的内容 */
+static void lept_set_inline_string(lept_value *v, const char *s, size_t len) {
 
-    lept_set_string(v, str, len);
-    return ret;
+    char *p = (char *) v;
+    assert(len <= LEPT_INLINE_MAX);
+    memmove(p, s, len);
+    p[len] = '\0';
+    v->slen = (unsigned char) len;
+    v->flags = LEPT_VALUE_INLINE;
+    v->type = LEPT_STRING;
+}
+
+/* 把 lept_parse_string_raw 的结果存到 v 中, 字符串值和 key 都用它; v->size 放不下时什么也不做 */
+static int lept_parse_set_string(lept_context *c, lept_value *v, char *str, size_t len) {
+
+    if (len > LEPT_SIZE_MAX)
+        return LEPT_PARSE_TOO_LARGE;
+    if (c->insitu) {
+        v->u.s = str;
+        v->flags = LEPT_VALUE_BORROWED;
+    } else if (len <= LEPT_INLINE_MAX) {
+        lept_set_inline_string(v, str, len);
+        return LEPT_PARSE_OK;
+    } else if (c->borrow && (uintptr_t) str - (uintptr_t) c->borrow < (uintptr_t) c->end - (uintptr_t) c->borrow) {
+        //lept_parse_string_raw 只有在没有转义时才返回指向输入的指针, 否则指向栈
+        v->u.s = str;
+        v->flags = LEPT_VALUE_BORROWED;
+    } else {
+        v->u.s = (char *) lept_parse_alloc(c, len + 1);
+        memcpy(v->u.s, str, len);
+        v->u.s[len] = '\0';
+        v->flags = c->flags;
+    }
+    v->size = (uint32_t) len;
+    v->type = LEPT_STRING;
+    return LEPT_PARSE_OK;
+}
+
+/* key: 有驻留表时长 key 指向表中共享的副本, 不再每次分配 */
+static int lept_parse_set_key(lept_context *c, lept_value *v, char *str, size_t len) {
+
+    if (c->keys == NULL || len <= LEPT_INLINE_MAX || len > LEPT_SIZE_MAX)
+        return lept_parse_set_string(c, v, str, len);
+    v->u.s = (char *) lept_intern(c->keys, str, len);
+    v->size = (uint32_t) len;
+    v->flags = LEPT_VALUE_BORROWED;
+    v->type = LEPT_STRING;
+    return LEPT_PARSE_OK;
+}
+
+static int lept_parse_string(lept_context *c, lept_value *v) {
+
+    EXPECT(c, '"');
+    char *str = NULL;
+    size_t len = 0;
+    //应该先定义变量分配了内存之后, 取地址传给函数, 而不是声明指针(没有指向实体)
+    int ret;
+    LEPT_STAT_TIME(string_cycles, ret = lept_parse_string_raw(c, &str, &len));
+    if (ret != LEPT_PARSE_OK) return ret;
+    return lept_parse_set_string(c, v, str, len);
 }
 
 static int lept_parse_value(lept_context *c, lept_value *v);
 
-static int lept_parse_array(lept_context *c, lept_value *v) {
+/* 数组和对象的语法 (空白, 逗号, 冒号, key 的引号, 各个错误码) 只写在 lept_parse_container 里
+ * DOM 构建, SAX 和延迟扫描各提供一张事件表: begin 在 '[' / '{' 处调用, key 在 key 的 '"' 处调用并解析整个 key,
+ * value 解析一个元素或成员的值, end 在 ']' / '}' 之后调用; 之后出错时 fail 清理已经完成的 size 个元素/成员
+ * key 返回 LEPT_PARSE_MISS_QUOTATION_MARK 时报告为 LEPT_PARSE_MISS_KEY
+ */
+typedef struct {
+    lept_type type; //LEPT_ARRAY 或 LEPT_OBJECT
+    int (*begin)(lept_context *c, void *frame); //可以为 NULL
+    int (*key)(lept_context *c, void *frame); //只有对象用
+    int (*value)(lept_context *c, void *frame);
+    int (*end)(lept_context *c, void *frame, size_t size);
+    void (*fail)(lept_context *c, void *frame, size_t size); //可以为 NULL
+} lept_grammar;
 
+static LEPT_ALWAYS_INLINE int lept_parse_container(lept_context *c, const lept_grammar *g, void *frame) {
+
+    const int object = g->type == LEPT_OBJECT;
+    const char close = object ? '}' : ']';
     size_t size = 0;
     int ret;
-    EXPECT(c, '[');
+    if (g->begin && (ret = g->begin(c, frame)) != LEPT_PARSE_OK)
+        return ret;
+    EXPECT(c, object ? '{' : '[');
     lept_parse_whitespace(c);
-    if (*c->json == ']') {
+    if (PEEK(c) == close) {
         c->json++;
-        v->type = LEPT_ARRAY;
-        v->u.a.size = 0;
-        v->u.a.e = NULL;
-        return LEPT_PARSE_OK;
-    }
-    for (;;) {
-        lept_value e;
-        //lept_value *e = lept_context_push(c, sizeof(lept_value)); //一个有bug的写法, 但是还不知道有什么bug
-        //这种写法, 如果后面的realloc ... 就会产生指针悬挂
-        lept_init(&e);
-        lept_parse_whitespace(c);
-        if ((ret = lept_parse_value(c, &e)) != LEPT_PARSE_OK) {
-            break; //解析出错, 跳出循环
-        }
-        //在数组完全解析完成之前, 每个元素(而不是不是指针)都临时放在堆栈中
-        memcpy(lept_context_push(c, sizeof(lept_value)), &e, sizeof(lept_value));
-        size++;
-        lept_parse_whitespace(c);
-        if (*c->json == ',')
-            c->json++;
-        else if (*c->json == ']') {
-            c->json++;
-            v->type = LEPT_ARRAY;
-            v->u.a.size = size;
-            size *= sizeof(lept_value); //整个 array 的大小
-            memcpy(v->u.a.e = (lept_value *) malloc(size), lept_context_pop(c, size), size); //弹出整个数组
-            return LEPT_PARSE_OK;
-        } else {
-            ret = LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
-            break;
+        if ((ret = g->end(c, frame, 0)) == LEPT_PARSE_OK)
+            return ret;
+    } else {
+        for (;;) {
+            if (object) {
+                if (PEEK(c) != '"') {
+                    ret = LEPT_PARSE_MISS_KEY;
+                    break;
+                }
+                if ((ret = g->key(c, frame)) != LEPT_PARSE_OK) {
+                    if (ret == LEPT_PARSE_MISS_QUOTATION_MARK) ret = LEPT_PARSE_MISS_KEY;
+                    break;
+                }
+                lept_parse_whitespace(c);
+                if (PEEK(c) != ':') {
+                    ret = LEPT_PARSE_MISS_COLON;
+                    break;
+                }
+                c->json++; //skip :
+                lept_parse_whitespace(c);
+            }
+            if ((ret = g->value(c, frame)) != LEPT_PARSE_OK)
+                break; //解析出错, 跳出循环
+            size++;
+            lept_parse_whitespace(c);
+            if (PEEK(c) == ',') {
+                c->json++;
+                lept_parse_whitespace(c);
+            } else if (PEEK(c) == close) {
+                c->json++;
+                if ((ret = g->end(c, frame, size)) == LEPT_PARSE_OK)
+                    return ret;
+                break;
+            } else {
+                ret = object ? LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET : LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+                break;
+            }
         }
     }
-    //c->top = head; //移动栈顶,空出来的位置后面就可以给后面的元素用了, 就相当于完成了pop
-    for (size_t i = 0; i < size; i++) {
-        lept_free(lept_context_pop(c, sizeof(lept_value)));
-    }
+    if (g->fail)
+        g->fail(c, frame, size);
     return ret;
 }
 
-static int lept_parse_object(lept_context *c, lept_value *v) {
+/* DOM: 在容器完全解析完成之前, 每个元素 (而不是指针) 都临时放在栈中, 结束时一次弹出 */
+typedef struct {
+    lept_value *v;
+    lept_member m; //对象: 已经解析了 key, 还在等值的成员; 没有时 m.k 的类型是 LEPT_NULL
+} lept_dom_frame;
 
-    EXPECT(c, '{');
-    lept_parse_whitespace(c);
-    if (*c->json == '}') {
-        c->json++;
-        v->type = LEPT_OBJECT;
-        v->u.o.m = 0;
-        v->u.o.size = 0;
-        return LEPT_PARSE_OK;
-    }
+static int lept_dom_array_value(lept_context *c, void *frame) {
 
+    lept_value e;
     int ret;
-    size_t size = 0;
-    lept_member m;
-    m.k = NULL;
-    for (;;) {
-        lept_parse_whitespace(c);
-        if (*c->json != '"') {
-            ret = LEPT_PARSE_MISS_KEY;
-            break;
-        }
-        c->json++; //跳过"
+    (void) frame;
+    //lept_value *e = lept_context_push(c, sizeof(lept_value)); //一个有bug的写法: 后面的 realloc 会让指针悬挂
+    lept_init(&e);
+    if ((ret = lept_parse_value(c, &e)) == LEPT_PARSE_OK)
+        memcpy(lept_context_push(c, sizeof(lept_value)), &e, sizeof(lept_value));
+    return ret;
+}
 
-        char *str = NULL;
-        ret = lept_parse_string_raw(c, &str, &m.klen);
-        if (ret != LEPT_PARSE_OK) {
-            if (ret == LEPT_PARSE_MISS_QUOTATION_MARK) ret = LEPT_PARSE_MISS_KEY;
-            break;
-        }
+static int lept_dom_array_end(lept_context *c, void *frame, size_t size) {
 
-        m.k = (char *) malloc(m.klen + 1);
-        memcpy(m.k, str, m.klen);
-        m.k[m.klen] = '\0';
+    lept_value *v = ((lept_dom_frame *) frame)->v;
+    if (size > LEPT_SIZE_MAX)
+        return LEPT_PARSE_TOO_LARGE; //元素还在栈上, 由 fail 释放
+    v->type = LEPT_ARRAY;
+    v->flags = c->flags;
+    v->size = size;
+    v->u.e = NULL;
+    if (size) {
+        size *= sizeof(lept_value); //整个 array 的大小
+        memcpy(v->u.e = (lept_value *) lept_parse_alloc(c, size), lept_context_pop(c, size), size); //弹出整个数组
+    }
+    return LEPT_PARSE_OK;
+}
 
-        //解析中间的冒号
-        lept_parse_whitespace(c);
-        if (*c->json != ':') {
-            ret = LEPT_PARSE_MISS_COLON;
-            //从这里中途退出, size还没有++, 所以为key分配的内存就无法释放, 需要在这里手动释放
-            free(m.k);
-            break;
-        }
-        c->json++; //skip :
+static void lept_dom_array_fail(lept_context *c, void *frame, size_t size) {
 
-        lept_init(&m.v);
-        lept_parse_whitespace(c);
-        if ((ret = lept_parse_value(c, &m.v)) != LEPT_PARSE_OK) break;
+    (void) frame;
+    for (size_t i = 0; i < size; i++)
+        lept_free_value(lept_context_pop(c, sizeof(lept_value)), c->alloc);
+}
 
-        memcpy(lept_context_push(c, sizeof(lept_member)), &m, sizeof(m)); //解析完一个成员, 暂存到堆栈中
-        size++;
+static const lept_grammar lept_dom_array = {
+    LEPT_ARRAY, NULL, NULL, lept_dom_array_value, lept_dom_array_end, lept_dom_array_fail
+};
 
-        m.k = NULL; //原来为key分配的内存已经有新的指针指向了(memcpy)
+static int lept_parse_array(lept_context *c, lept_value *v) {
 
-        lept_parse_whitespace(c);
-        if (*c->json == ',') {
-            c->json++;
-        } else if (*c->json == '}') {
-            c->json++;
-            v->type = LEPT_OBJECT;
-            v->u.o.size = size;
-            size *= sizeof(lept_member);
-            v->u.o.m = (lept_member *) malloc(size);
-            memcpy(v->u.o.m, lept_context_pop(c, size), size); //退出整个对象
-            return LEPT_PARSE_OK;
-        } else {
-            ret = LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
-            break;
+    lept_dom_frame f;
+    f.v = v;
+    return lept_parse_container(c, &lept_dom_array, &f);
+}
+
+/* 对象的哈希索引: 紧跟在成员块后面, 和成员块一起分配和释放
+ * 槽位数只由成员数决定, 不需要额外记录; 成员数小于 LEPT_OBJECT_INDEX_THRESHOLD 的对象没有索引, 查找时顺序比较
+ */
+typedef struct {
+    uint32_t hash;
+    uint32_t index; //成员下标 + 1, 0 表示空槽
+} lept_member_slot;
+
+static size_t lept_object_index_capacity(size_t size) {
+
+    size_t cap = 1;
+    if (size == 0 || size < LEPT_OBJECT_INDEX_THRESHOLD || size >= UINT32_MAX)
+        return 0;
+    while (cap < 2 * size)
+        cap <<= 1; //负载不超过 1/2
+    return cap;
+}
+
+static uint32_t lept_hash_key(const char *k, size_t len) {
+
+    uint64_t h = 0x9e3779b97f4a7c15u ^ len, w;
+    for (; len >= 8; k += 8, len -= 8) {
+        memcpy(&w, k, 8);
+        h = (h ^ w) * 0xff51afd7ed558ccdu;
+        h ^= h >> 32;
+    }
+    if (len) {
+        w = 0;
+        memcpy(&w, k, len);
+        h = (h ^ w) * 0xff51afd7ed558ccdu;
+    }
+    //槽位只用低位, 最后把高位混进来
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53u;
+    h ^= h >> 33;
+    return (uint32_t) h;
+}
+
+/* 驻留的 key 和用同一个驻留表得到的 key 只需要比较指针 */
+static int lept_member_key_equal(const lept_member *m, const char *key, size_t klen) {
+
+    const char *k = LEPT_STRING(&m->k);
+    return LEPT_STRING_LENGTH(&m->k) == klen && (k == key || klen == 0 || memcmp(k, key, klen) == 0);
+}
+
+static void lept_object_build_index(lept_member *m, size_t size) {
+
+    size_t cap = lept_object_index_capacity(size);
+    lept_member_slot *slots = (lept_member_slot *) (m + size);
+    if (cap == 0)
+        return;
+    memset(slots, 0, cap * sizeof(lept_member_slot));
+    for (size_t i = 0; i < size; i++) {
+        const char *k = LEPT_STRING(&m[i].k);
+        size_t klen = LEPT_STRING_LENGTH(&m[i].k);
+        uint32_t h = lept_hash_key(k, klen);
+        size_t j = h & (cap - 1);
+        for (; slots[j].index; j = (j + 1) & (cap - 1))
+            if (slots[j].hash == h && lept_member_key_equal(&m[slots[j].index - 1], k, klen))
+                break; //重复的 key 只索引第一个, 和顺序查找的结果一致
+        if (slots[j].index == 0) {
+            slots[j].hash = h;
+            slots[j].index = (uint32_t) (i + 1);
         }
     }
+}
+
+static int lept_dom_object_key(lept_context *c, void *frame) {
+
+    lept_member *m = &((lept_dom_frame *) frame)->m;
+    char *str = NULL;
+    size_t klen;
+    int ret;
+    c->json++; //跳过"
+    LEPT_STAT_TIME(string_cycles, ret = lept_parse_string_raw(c, &str, &klen));
+    if (ret == LEPT_PARSE_OK)
+        ret = lept_parse_set_key(c, &m->k, str, klen); //key 和字符串值一样, 短的直接放在成员里
+    return ret;
+}
+
+static int lept_dom_object_value(lept_context *c, void *frame) {
+
+    lept_member *m = &((lept_dom_frame *) frame)->m;
+    int ret;
+    lept_init(&m->v);
+    if ((ret = lept_parse_value(c, &m->v)) != LEPT_PARSE_OK)
+        return ret;
+    memcpy(lept_context_push(c, sizeof(lept_member)), m, sizeof(lept_member)); //解析完一个成员, 暂存到堆栈中
+    lept_init(&m->k); //key 已经交给栈了
+    return LEPT_PARSE_OK;
+}
+
+static int lept_dom_object_end(lept_context *c, void *frame, size_t size) {
+
+    lept_value *v = ((lept_dom_frame *) frame)->v;
+    if (size > LEPT_SIZE_MAX)
+        return LEPT_PARSE_TOO_LARGE;
+    v->type = LEPT_OBJECT;
+    v->flags = c->flags;
+    v->size = size;
+    v->u.m = NULL;
+    if (size) {
+        v->u.m = (lept_member *) lept_parse_alloc(c, size * sizeof(lept_member)
+                                                       + lept_object_index_capacity(size) * sizeof(lept_member_slot));
+        memcpy(v->u.m, lept_context_pop(c, size * sizeof(lept_member)), size * sizeof(lept_member)); //退出整个对象
+        lept_object_build_index(v->u.m, size);
+    }
+    return LEPT_PARSE_OK;
+}
 
-    //解析失败, free 栈中的暂存内容
+static void lept_dom_object_fail(lept_context *c, void *frame, size_t size) {
+
+    //解析失败, free 栈中的暂存内容, 还有没等到值的 key
     for (size_t i = 0; i < size; i++) {
         lept_member *member = (lept_member *) lept_context_pop(c, sizeof(lept_member));
-        free(member->k);
-        lept_free(&member->v);
+        lept_free_value(&member->k, c->alloc);
+        lept_free_value(&member->v, c->alloc);
     }
+    lept_free_value(&((lept_dom_frame *) frame)->m.k, c->alloc);
+}
 
-    return ret;
+static const lept_grammar lept_dom_object = {
+    LEPT_OBJECT, NULL, lept_dom_object_key, lept_dom_object_value, lept_dom_object_end, lept_dom_object_fail
+};
+
+static int lept_parse_object(lept_context *c, lept_value *v) {
+
+    lept_dom_frame f;
+    f.v = v;
+    lept_init(&f.m.k);
+    return lept_parse_container(c, &lept_dom_object, &f);
+}
+
+/* 延迟的数组/对象: 直接跳到记录的结尾, 内容已经检查过了 */
+static int lept_parse_lazy(lept_context *c, lept_value *v, lept_type type) {
+
+    const lept_lazy *node = c->lazy;
+    assert(node->json == c->json);
+    v->type = type;
+    v->flags = c->flags | LEPT_VALUE_LAZY;
+    v->u.l = node;
+    v->size = node->size;
+    c->json = node->end;
+    c->lazy = node + node->descendants + 1;
+    return LEPT_PARSE_OK;
 }
 
 static int lept_parse_value(lept_context *c, lept_value *v) {
 
+    if (c->json == c->end)
+        return LEPT_PARSE_EXPECT_VALUE;
+    if (c->lazy && (*c->json == '[' || *c->json == '{'))
+        return lept_parse_lazy(c, v, *c->json == '[' ? LEPT_ARRAY : LEPT_OBJECT);
+#ifdef LEPT_STATS
+    int ret;
+    switch (*c->json) {
+        case 'n':
+            ret = lept_parse_literal(c, v, LEPT_NULL);
+            break;
+        case 't':
+            ret = lept_parse_literal(c, v, LEPT_TRUE);
+            break;
+        case 'f':
+            ret = lept_parse_literal(c, v, LEPT_FALSE);
+            break;
+        case '"':
+            ret = lept_parse_string(c, v);
+            break;
+        case '[':
+            LEPT_STAT_ENTER();
+            ret = lept_parse_array(c, v);
+            LEPT_STAT_LEAVE();
+            break;
+        case '{':
+            LEPT_STAT_ENTER();
+            ret = lept_parse_object(c, v);
+            LEPT_STAT_LEAVE();
+            break;
+        default:
+            LEPT_STAT_TIME(number_cycles, ret = lept_parse_number(c, v));
+    }
+    if (ret == LEPT_PARSE_OK)
+        lept_stats_current.nodes[v->type]++;
+    return ret;
+#else
     switch (*c->json) {
         case 'n':
             return lept_parse_literal(c, v, LEPT_NULL);
@@ -452,203 +2158,2788 @@ static int lept_parse_value(lept_context *c, lept_value *v) {
             return lept_parse_array(c, v);
         case '{':
             return lept_parse_object(c, v);
-        case '\0':
-            return LEPT_PARSE_EXPECT_VALUE;
         default:
             return lept_parse_number(c, v);
     }
+#endif
 }
 
-int lept_parse(lept_value *v, const char *json) {
-
-    lept_context c;
-    assert(v != NULL);
-
-    lept_context_init(&c);
-    c.json = json;
+static int lept_parse_root(lept_context *c, lept_value *v) {
 
+#ifdef LEPT_STATS
+    const char *start = c->json;
+    uint64_t t0 = lept_cycles();
+    lept_stats_reset();
+#endif
     lept_init(v);
-    lept_parse_whitespace(&c);
-    int ret = lept_parse_value(&c, v);
+    lept_parse_whitespace(c);
+    int ret = lept_parse_value(c, v);
 
     if (ret == LEPT_PARSE_OK) {
-        lept_parse_whitespace(&c);
-        if (*c.json != '\0') {
-            v->type = LEPT_NULL;
+        lept_parse_whitespace(c);
+        if (c->json != c->end) {
+            lept_free_value(v, c->alloc);
             ret = LEPT_PARSE_ROOT_NOT_SINGULAR;
         }
     }
 
-    assert(c.top == 0);
-    free(c.stack);
-
+    assert(c->top == 0);
+    LEPT_STAT(lept_stats_current.bytes = (size_t) (c->json - start); lept_stats_current.cycles = lept_cycles() - t0);
     return ret;
 }
 
-/* Access functions */
-lept_type lept_get_type(const lept_value *v) {
+int lept_parse(lept_value *v, const char *json) {
 
+    lept_context c;
     assert(v != NULL);
-    return v->type;
-}
 
-int lept_get_boolean(const lept_value *v) {
+    lept_context_init(&c);
+    c.json = json;
+    c.end = json + strlen(json);
+    int ret = lept_parse_root(&c, v);
+    lept_mem_free(c.alloc, c.stack);
 
-    assert(v != NULL && (v->type == LEPT_TRUE || v->type == LEPT_FALSE));
-    return v->type == LEPT_TRUE;
+    return ret;
 }
 
-void lept_set_boolean(lept_value *v, int bool) {
+int lept_parse_n(lept_value *v, const char *json, size_t len) {
 
-    assert(v != NULL);
-    lept_free(v); //容易内存泄露
-    v->type = bool ? LEPT_TRUE : LEPT_FALSE;
-}
+    lept_context c;
+    assert(v != NULL && (json != NULL || len == 0));
 
-double lept_get_number(const lept_value *v) {
+    lept_context_init(&c);
+    c.json = json;
+    c.end = json + len;
+    int ret = lept_parse_root(&c, v);
+    lept_mem_free(c.alloc, c.stack);
 
-    assert(v != NULL && v->type == LEPT_NUMBER);
-    return v->u.n;
+    return ret;
 }
 
-void lept_set_number(lept_value *v, double n) {
+/* SAX 解析: 和 DOM 共用 literal/number/string 的解析代码和容器的语法 (lept_parse_container), 只是把结果交给回调而不是写入 lept_value */
 
-    assert(v != NULL);
-    lept_free(v); //memory leak
-    v->u.n = n;
-    v->type = LEPT_NUMBER;
-}
+#define SAX_CALLBACK(call) do { if (call) return LEPT_PARSE_ABORTED; } while(0)
 
-char *lept_get_string(const lept_value *v) {
+static int lept_sax_parse_value(lept_context *c);
 
-    assert(v != NULL && v->type == LEPT_STRING);
-    return v->u.s.s;
+static int lept_sax_begin_array(lept_context *c, void *frame) {
+
+    const lept_handler *h = c->handler;
+    (void) frame;
+    SAX_CALLBACK(h->start_array && h->start_array(c->user));
+    return LEPT_PARSE_OK;
 }
 
-void lept_set_string(lept_value *v, const char *s, size_t len) {
+static int lept_sax_end_array(lept_context *c, void *frame, size_t size) {
 
-    assert(v != NULL && (s != NULL || len == 0));
-    lept_free(v);
-    v->u.s.s = (char *) malloc(len + 1);
-    // Copies count characters from the object pointed to by src to the object pointed to by dest.
-    // Both objects are interpreted as arrays of unsigned char.
-    memcpy(v->u.s.s, s, len);
-    v->u.s.s[len] = '\0';
-    v->u.s.len = len;
-    v->type = LEPT_STRING;
+    const lept_handler *h = c->handler;
+    (void) frame;
+    SAX_CALLBACK(h->end_array && h->end_array(c->user, size));
+    return LEPT_PARSE_OK;
 }
 
-size_t lept_get_string_length(const lept_value *v) {
+static int lept_sax_begin_object(lept_context *c, void *frame) {
 
-    assert(v != NULL && v->type == LEPT_STRING);
-    return v->u.s.len;
+    const lept_handler *h = c->handler;
+    (void) frame;
+    SAX_CALLBACK(h->start_object && h->start_object(c->user));
+    return LEPT_PARSE_OK;
 }
 
-size_t lept_get_array_size(const lept_value *v) {
+static int lept_sax_end_object(lept_context *c, void *frame, size_t size) {
 
-    assert(v != NULL && v->type == LEPT_ARRAY);
-    return v->u.a.size;
+    const lept_handler *h = c->handler;
+    (void) frame;
+    SAX_CALLBACK(h->end_object && h->end_object(c->user, size));
+    return LEPT_PARSE_OK;
 }
 
-lept_value *lept_get_array_element(const lept_value *v, size_t index) {
+static int lept_sax_key(lept_context *c, void *frame) {
 
-    assert(lept_get_type(v) == LEPT_ARRAY);
-    assert(index < v->u.a.size);
-    return &v->u.a.e[index];
+    const lept_handler *h = c->handler;
+    char *str;
+    size_t len;
+    int ret;
+    (void) frame;
+    c->json++;
+    if ((ret = lept_parse_string_raw(c, &str, &len)) != LEPT_PARSE_OK)
+        return ret;
+    SAX_CALLBACK(h->key && h->key(c->user, str, len));
+    return LEPT_PARSE_OK;
 }
 
-size_t lept_get_object_size(const lept_value *v) {
+static int lept_sax_value(lept_context *c, void *frame) {
 
-    assert(v != NULL && v->type == LEPT_OBJECT);
-    return v->u.o.size;
+    (void) frame;
+    return lept_sax_parse_value(c);
 }
 
-const char *lept_get_object_key(const lept_value *v, size_t index) {
+static const lept_grammar lept_sax_array = {
+    LEPT_ARRAY, lept_sax_begin_array, NULL, lept_sax_value, lept_sax_end_array, NULL
+};
+static const lept_grammar lept_sax_object = {
+    LEPT_OBJECT, lept_sax_begin_object, lept_sax_key, lept_sax_value, lept_sax_end_object, NULL
+};
 
-    assert(v != NULL && v->type == LEPT_OBJECT);
-    assert(index < v->u.o.size);
-    return v->u.o.m[index].k;
+static int lept_sax_parse_value(lept_context *c) {
+
+    const lept_handler *h = c->handler;
+    lept_value v; //literal 和 number 的临时结果, 不会分配内存
+    char *str;
+    size_t len;
+    int ret;
+    if (c->json == c->end)
+        return LEPT_PARSE_EXPECT_VALUE;
+    switch (*c->json) {
+        case 'n':
+            if ((ret = lept_parse_literal(c, &v, LEPT_NULL)) != LEPT_PARSE_OK)
+                return ret;
+            SAX_CALLBACK(h->null && h->null(c->user));
+            return LEPT_PARSE_OK;
+        case 't':
+            if ((ret = lept_parse_literal(c, &v, LEPT_TRUE)) != LEPT_PARSE_OK)
+                return ret;
+            SAX_CALLBACK(h->boolean && h->boolean(c->user, 1));
+            return LEPT_PARSE_OK;
+        case 'f':
+            if ((ret = lept_parse_literal(c, &v, LEPT_FALSE)) != LEPT_PARSE_OK)
+                return ret;
+            SAX_CALLBACK(h->boolean && h->boolean(c->user, 0));
+            return LEPT_PARSE_OK;
+        case '"':
+            c->json++;
+            if ((ret = lept_parse_string_raw(c, &str, &len)) != LEPT_PARSE_OK)
+                return ret;
+            SAX_CALLBACK(h->string && h->string(c->user, str, len));
+            return LEPT_PARSE_OK;
+        case '[':
+            return lept_parse_container(c, &lept_sax_array, NULL);
+        case '{':
+            return lept_parse_container(c, &lept_sax_object, NULL);
+        default:
+            if ((ret = lept_parse_number(c, &v)) != LEPT_PARSE_OK)
+                return ret;
+            SAX_CALLBACK(h->number && h->number(c->user, v.u.n));
+            return LEPT_PARSE_OK;
+    }
 }
 
-size_t lept_get_object_key_length(const lept_value *v, size_t index) {
+int lept_sax_parse_n(const lept_handler *h, void *user, const char *json, size_t len) {
 
-    assert(v != NULL && v->type == LEPT_OBJECT);
-    assert(index < v->u.o.size);
-    return v->u.o.m[index].klen;
+    lept_context c;
+    int ret;
+    assert(h != NULL && (json != NULL || len == 0));
+
+    lept_context_init(&c);
+    c.json = json;
+    c.end = json + len;
+    c.handler = h;
+    c.user = user;
+    lept_parse_whitespace(&c);
+    if ((ret = lept_sax_parse_value(&c)) == LEPT_PARSE_OK) {
+        lept_parse_whitespace(&c);
+        if (c.json != c.end)
+            ret = LEPT_PARSE_ROOT_NOT_SINGULAR;
+    }
+    lept_mem_free(c.alloc, c.stack);
+    return ret;
 }
 
-lept_value *lept_get_object_value(const lept_value *v, size_t index) {
+int lept_sax_parse(const lept_handler *h, void *user, const char *json) {
 
-    assert(v != NULL && v->type == LEPT_OBJECT);
-    assert(index < v->u.o.size);
-    return &v->u.o.m[index].v;
+    assert(json != NULL);
+    return lept_sax_parse_n(h, user, json, strlen(json));
 }
 
-/* Stringify function */
-#define PUTS(c, s, len)  memcpy(lept_context_push(c, len), s, len)
+/* 增量解析: 输入分块到达, 显式的容器栈代替递归, 跨块的 token 暂存在 pending 中
+ * 完整落在一块内的 token 直接用 lept_parse_value 解析; 被截断的 token 补齐之后再解析, 所以结果和错误码与 lept_parse 一致
+ */
 
-static void lept_stringify_string(lept_context *c, const char *s, size_t len) {
+enum {
+    LEPT_PUSH_VALUE, //期待一个值
+    LEPT_PUSH_ARRAY_FIRST, //'[' 之后, 值或 ']'
+    LEPT_PUSH_OBJECT_FIRST, //'{' 之后, key 或 '}'
+    LEPT_PUSH_KEY,
+    LEPT_PUSH_COLON,
+    LEPT_PUSH_AFTER_VALUE, //',' 或者结束当前容器
+    LEPT_PUSH_DONE //根值已经完整
+};
 
-    static const char hex_digits[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
-    assert(s != NULL);
-    size_t size;
-    char *head, *p;
-    size = len * 6 + 2; //转换之后的字符串的最大长度
-    p = head = lept_context_push(c, size);
+enum { LEPT_PUSH_TOKEN_NONE, LEPT_PUSH_TOKEN_STRING, LEPT_PUSH_TOKEN_SCALAR };
 
-    *p++ = '"';
-    for (size_t i = 0; i < len; i++) {
-        unsigned char ch = (unsigned char) s[i];
-        switch (ch) {
-            case '\"':
-                *p++ = '\\';
-                *p++ = '"';
-                break;
+typedef struct {
+    lept_type type; //LEPT_ARRAY 或 LEPT_OBJECT
+    size_t size; //已经压入 c->stack 的元素/成员个数, 成员在解析完 key 时就压入
+} lept_push_frame;
+
+struct lept_push_parser {
+    lept_context c; //c.stack 上依次暂存各层容器的元素, 和递归解析时一样
+    lept_push_frame *frames;
+    size_t depth, frames_cap;
+    int state;
+    int error; //出错之后一直返回这个错误, 直到 lept_push_finish
+    lept_value root;
+    char *pending; //被块边界截断的 token, 从第一个字节开始
+    size_t pending_len, pending_cap;
+    int token; //LEPT_PUSH_TOKEN_*, pending 中的 token 类型
+    int escape; //pending 中的字符串以未配对的 '\\' 结尾
+};
+
+//number 和 literal 中可能出现的字符, 遇到其他字符说明 token 已经结束
+#define ISSCALAR(ch) (ISDIGIT(ch) || ((ch) >= 'a' && (ch) <= 'z') || ((ch) >= 'A' && (ch) <= 'Z') || \
+                      (ch) == '.' || (ch) == '+' || (ch) == '-')
+
+lept_push_parser *lept_push_parser_new(void) {
+
+    lept_push_parser *p = (lept_push_parser *) malloc(sizeof(lept_push_parser));
+    lept_context_init(&p->c);
+    p->frames = NULL;
+    p->depth = p->frames_cap = 0;
+    p->state = LEPT_PUSH_VALUE;
+    p->error = LEPT_PARSE_OK;
+    lept_init(&p->root);
+    p->pending = NULL;
+    p->pending_len = p->pending_cap = 0;
+    p->token = LEPT_PUSH_TOKEN_NONE;
+    p->escape = 0;
+    return p;
+}
+
+/* 释放还没有完成的容器, 回到初始状态, 保留已经分配的缓冲区 */
+static void lept_push_reset(lept_push_parser *p) {
+
+    lept_context *c = &p->c;
+    while (p->depth) {
+        lept_push_frame *f = &p->frames[--p->depth];
+        for (size_t i = 0; i < f->size; i++) {
+            if (f->type == LEPT_ARRAY) {
+                lept_free(lept_context_pop(c, sizeof(lept_value)));
+            } else {
+                lept_member *m = (lept_member *) lept_context_pop(c, sizeof(lept_member));
+                lept_free(&m->k);
+                lept_free(&m->v);
+            }
+        }
+    }
+    assert(c->top == 0);
+    lept_free(&p->root);
+    p->state = LEPT_PUSH_VALUE;
+    p->error = LEPT_PARSE_OK;
+    p->pending_len = 0;
+    p->token = LEPT_PUSH_TOKEN_NONE;
+    p->escape = 0;
+}
+
+void lept_push_parser_free(lept_push_parser *p) {
+
+    if (p == NULL)
+        return;
+    lept_push_reset(p);
+    free(p->c.stack);
+    free(p->frames);
+    free(p->pending);
+    free(p);
+}
+
+static void lept_push_pend(lept_push_parser *p, const char *s, size_t len) {
+
+    if (p->pending_len + len > p->pending_cap) {
+        if (p->pending_cap == 0)
+            p->pending_cap = LEPT_PARSE_STACK_INIT_SIZE;
+        while (p->pending_len + len > p->pending_cap)
+            p->pending_cap += p->pending_cap >> 1;
+        p->pending = (char *) realloc(p->pending, p->pending_cap);
+    }
+    memcpy(p->pending + p->pending_len, s, len);
+    p->pending_len += len;
+}
+
+/* 在 [s, end) 中找字符串结尾的引号, *escape 记录跨块的 '\\'; 找不到时返回 end */
+static const char *lept_push_find_quote(const char *s, const char *end, int *escape) {
+
+    while (s != end) {
+        if (*escape) {
+            *escape = 0;
+            s++;
+            continue;
+        }
+        s = lept_scan_string(s, end);
+        if (s == end || *s == '"')
+            return s;
+        *escape = *s == '\\'; //控制字符留给 lept_parse_string_raw 报错
+        s++;
+    }
+    return end;
+}
+
+/* 当前状态下遇到了不能接受的字符或者输入结束时的错误, 和递归解析时 PEEK 到这个字符的结果一样 */
+static int lept_push_unexpected(const lept_push_parser *p) {
+
+    switch (p->state) {
+        case LEPT_PUSH_VALUE:
+        case LEPT_PUSH_ARRAY_FIRST:
+            return LEPT_PARSE_EXPECT_VALUE;
+        case LEPT_PUSH_OBJECT_FIRST:
+        case LEPT_PUSH_KEY:
+            return LEPT_PARSE_MISS_KEY;
+        case LEPT_PUSH_COLON:
+            return LEPT_PARSE_MISS_COLON;
+        case LEPT_PUSH_AFTER_VALUE:
+            return p->frames[p->depth - 1].type == LEPT_ARRAY ?
+                   LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET : LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+        default:
+            return LEPT_PARSE_ROOT_NOT_SINGULAR;
+    }
+}
+
+/* 一个值完成了, 放到当前容器里 */
+static void lept_push_value(lept_push_parser *p, const lept_value *v) {
+
+    lept_context *c = &p->c;
+    if (p->depth == 0) {
+        p->root = *v;
+        p->state = LEPT_PUSH_DONE;
+        return;
+    }
+    lept_push_frame *f = &p->frames[p->depth - 1];
+    if (f->type == LEPT_ARRAY) {
+        memcpy(lept_context_push(c, sizeof(lept_value)), v, sizeof(lept_value));
+        f->size++;
+    } else {
+        ((lept_member *) (c->stack + c->top) - 1)->v = *v; //key 解析完时已经压入了这个成员
+    }
+    p->state = LEPT_PUSH_AFTER_VALUE;
+}
+
+static void lept_push_open(lept_push_parser *p, lept_type type) {
+
+    if (p->depth == p->frames_cap) {
+        p->frames_cap = p->frames_cap ? p->frames_cap + (p->frames_cap >> 1) : 16;
+        p->frames = (lept_push_frame *) realloc(p->frames, p->frames_cap * sizeof(lept_push_frame));
+    }
+    p->frames[p->depth].type = type;
+    p->frames[p->depth].size = 0;
+    p->depth++;
+    p->state = type == LEPT_ARRAY ? LEPT_PUSH_ARRAY_FIRST : LEPT_PUSH_OBJECT_FIRST;
+}
+
+static int lept_push_close(lept_push_parser *p) {
+
+    lept_context *c = &p->c;
+    lept_push_frame *f = &p->frames[p->depth - 1];
+    size_t size = f->size;
+    lept_value v;
+    if (size > LEPT_SIZE_MAX)
+        return LEPT_PARSE_TOO_LARGE; //帧还在, 由 lept_push_reset 释放
+    p->depth--;
+    v.type = f->type;
+    v.flags = c->flags;
+    if (f->type == LEPT_ARRAY) {
+        v.size = size;
+        v.u.e = NULL;
+        if (size) {
+            size *= sizeof(lept_value);
+            memcpy(v.u.e = (lept_value *) lept_parse_alloc(c, size), lept_context_pop(c, size), size);
+        }
+    } else {
+        v.size = size;
+        v.u.m = NULL;
+        if (size) {
+            v.u.m = (lept_member *) lept_parse_alloc(c, size * sizeof(lept_member)
+                                                         + lept_object_index_capacity(size) * sizeof(lept_member_slot));
+            memcpy(v.u.m, lept_context_pop(c, size * sizeof(lept_member)), size * sizeof(lept_member));
+            lept_object_build_index(v.u.m, size);
+        }
+    }
+    lept_push_value(p, &v);
+    return LEPT_PARSE_OK;
+}
+
+/* 解析从 c->json 开始的一个完整的 string/number/literal (或者 key) */
+static int lept_push_token(lept_push_parser *p) {
+
+    lept_context *c = &p->c;
+    lept_value v;
+    int ret;
+    if (p->state == LEPT_PUSH_KEY || p->state == LEPT_PUSH_OBJECT_FIRST) {
+        lept_member m;
+        char *str;
+        size_t klen;
+        c->json++; //跳过 "
+        if ((ret = lept_parse_string_raw(c, &str, &klen)) != LEPT_PARSE_OK)
+            return ret == LEPT_PARSE_MISS_QUOTATION_MARK ? LEPT_PARSE_MISS_KEY : ret;
+        if ((ret = lept_parse_set_string(c, &m.k, str, klen)) != LEPT_PARSE_OK)
+            return ret;
+        lept_init(&m.v);
+        memcpy(lept_context_push(c, sizeof(lept_member)), &m, sizeof(lept_member));
+        p->frames[p->depth - 1].size++;
+        p->state = LEPT_PUSH_COLON;
+        return LEPT_PARSE_OK;
+    }
+    lept_init(&v);
+    if ((ret = lept_parse_value(c, &v)) != LEPT_PARSE_OK)
+        return ret;
+    lept_push_value(p, &v);
+    return LEPT_PARSE_OK;
+}
+
+/* 补齐 pending 中的 token 之后解析它 */
+static int lept_push_pending(lept_push_parser *p) {
+
+    lept_context *c = &p->c;
+    const char *json = c->json, *end = c->end;
+    int ret;
+    c->json = p->pending;
+    c->end = p->pending + p->pending_len;
+    ret = lept_push_token(p);
+    //number/literal 后面紧跟的字符也在 pending 里, 例如 "truex"
+    if (ret == LEPT_PARSE_OK && c->json != c->end)
+        ret = lept_push_unexpected(p);
+    c->json = json;
+    c->end = end;
+    p->pending_len = 0;
+    p->token = LEPT_PUSH_TOKEN_NONE;
+    return ret;
+}
+
+static int lept_push_run(lept_push_parser *p, const char *json, size_t len, int eof) {
+
+    lept_context *c = &p->c;
+    const char *end = json + len, *q;
+    int ret = LEPT_PARSE_OK;
+    c->json = json;
+    c->end = end;
+
+    if (p->token == LEPT_PUSH_TOKEN_STRING) {
+        q = lept_push_find_quote(json, end, &p->escape);
+        if (q == end) {
+            lept_push_pend(p, json, len);
+            if (!eof)
+                return LEPT_PARSE_NEED_MORE;
+        } else {
+            lept_push_pend(p, json, ++q - json); //包括结尾的引号
+        }
+        c->json = q;
+        if ((ret = lept_push_pending(p)) != LEPT_PARSE_OK)
+            return ret;
+    } else if (p->token == LEPT_PUSH_TOKEN_SCALAR) {
+        for (q = json; q != end && ISSCALAR(*q); q++);
+        lept_push_pend(p, json, q - json);
+        c->json = q;
+        if (q == end && !eof)
+            return LEPT_PARSE_NEED_MORE;
+        if ((ret = lept_push_pending(p)) != LEPT_PARSE_OK)
+            return ret;
+    }
+
+    for (;;) {
+        lept_parse_whitespace(c);
+        if (c->json == end)
+            break;
+        char ch = *c->json;
+        switch (p->state) {
+            case LEPT_PUSH_DONE:
+                return LEPT_PARSE_ROOT_NOT_SINGULAR;
+            case LEPT_PUSH_COLON:
+                if (ch != ':')
+                    return LEPT_PARSE_MISS_COLON;
+                c->json++;
+                p->state = LEPT_PUSH_VALUE;
+                continue;
+            case LEPT_PUSH_AFTER_VALUE:
+                if (ch == ',') {
+                    c->json++;
+                    p->state = p->frames[p->depth - 1].type == LEPT_ARRAY ? LEPT_PUSH_VALUE : LEPT_PUSH_KEY;
+                } else if (ch == (p->frames[p->depth - 1].type == LEPT_ARRAY ? ']' : '}')) {
+                    c->json++;
+                    if ((ret = lept_push_close(p)) != LEPT_PARSE_OK)
+                        return ret;
+                } else {
+                    return lept_push_unexpected(p);
+                }
+                continue;
+            case LEPT_PUSH_OBJECT_FIRST:
+            case LEPT_PUSH_KEY:
+                if (ch == '}' && p->state == LEPT_PUSH_OBJECT_FIRST) {
+                    c->json++;
+                    if ((ret = lept_push_close(p)) != LEPT_PARSE_OK)
+                        return ret;
+                    continue;
+                }
+                if (ch != '"')
+                    return LEPT_PARSE_MISS_KEY;
+                break;
+            default:
+                if (ch == ']' && p->state == LEPT_PUSH_ARRAY_FIRST) {
+                    c->json++;
+                    if ((ret = lept_push_close(p)) != LEPT_PARSE_OK)
+                        return ret;
+                    continue;
+                }
+                if (ch == '[' || ch == '{') {
+                    c->json++;
+                    lept_push_open(p, ch == '[' ? LEPT_ARRAY : LEPT_OBJECT);
+                    continue;
+                }
+                break;
+        }
+
+        //string/number/literal: 可能被块的结尾截断
+        json = c->json;
+        if (ch == '"') {
+            if ((ret = lept_push_token(p)) == LEPT_PARSE_OK)
+                continue;
+            if (!eof && lept_push_find_quote(json + 1, end, &p->escape) == end) {
+                //还没有结尾的引号, 出错是因为输入不完整
+                p->token = LEPT_PUSH_TOKEN_STRING;
+                lept_push_pend(p, json, end - json);
+                return LEPT_PARSE_NEED_MORE;
+            }
+            p->escape = 0;
+            return ret;
+        }
+        for (q = json; q != end && ISSCALAR(*q); q++);
+        if (q == end && q != json && !eof) {
+            p->token = LEPT_PUSH_TOKEN_SCALAR;
+            lept_push_pend(p, json, end - json);
+            return LEPT_PARSE_NEED_MORE;
+        }
+        if ((ret = lept_push_token(p)) != LEPT_PARSE_OK)
+            return ret;
+    }
+
+    if (eof)
+        return p->state == LEPT_PUSH_DONE ? LEPT_PARSE_OK : lept_push_unexpected(p);
+    return p->state == LEPT_PUSH_DONE ? LEPT_PARSE_OK : LEPT_PARSE_NEED_MORE;
+}
+
+int lept_push_parse(lept_push_parser *p, const char *json, size_t len) {
+
+    assert(p != NULL && (json != NULL || len == 0));
+    if (p->error == LEPT_PARSE_OK) {
+        int ret = lept_push_run(p, json, len, 0);
+        if (ret != LEPT_PARSE_OK && ret != LEPT_PARSE_NEED_MORE) {
+            lept_push_reset(p);
+            p->error = ret;
+        }
+        return ret;
+    }
+    return p->error;
+}
+
+int lept_push_finish(lept_push_parser *p, lept_value *v) {
+
+    int ret;
+    assert(p != NULL && v != NULL);
+    lept_init(v);
+    if ((ret = p->error) == LEPT_PARSE_OK && (ret = lept_push_run(p, "", 0, 1)) == LEPT_PARSE_OK) {
+        *v = p->root;
+        lept_init(&p->root);
+    }
+    lept_push_reset(p);
+    return ret;
+}
+
+/* 工作队列: 线程每次领取一块连续的任务, 任务结果按下标存放, 所以和输入的顺序一致 */
+typedef struct {
+    size_t next; //下一个没有被领取的任务
+    size_t count;
+    size_t block; //每次领取的任务数
+    int failed; //有任务失败时其他线程不再领取
+#ifdef LEPT_THREADS
+    pthread_mutex_t lock;
+#endif
+} lept_work_queue;
+
+static void lept_work_init(lept_work_queue *q, size_t count, size_t block) {
+
+    q->next = 0;
+    q->count = count;
+    q->block = block;
+    q->failed = 0;
+}
+
+/* 返回领取的第一个任务, 大于等于 count 表示没有任务了 */
+static size_t lept_work_take(lept_work_queue *q) {
+
+    size_t i;
+#ifdef LEPT_THREADS
+    pthread_mutex_lock(&q->lock);
+#endif
+    i = q->failed ? q->count : q->next;
+    if (i < q->count)
+        q->next += q->block;
+#ifdef LEPT_THREADS
+    pthread_mutex_unlock(&q->lock);
+#endif
+    return i;
+}
+
+static void lept_work_fail(lept_work_queue *q) {
+
+#ifdef LEPT_THREADS
+    pthread_mutex_lock(&q->lock);
+#endif
+    q->failed = 1;
+#ifdef LEPT_THREADS
+    pthread_mutex_unlock(&q->lock);
+#endif
+}
+
+/* 当前线程和另外 threads - 1 个线程一起运行 worker(q), q 必须是 worker 参数的第一个成员 */
+static void lept_work_run(lept_work_queue *q, void *(*worker)(void *), unsigned threads) {
+
+#ifdef LEPT_THREADS
+    size_t blocks = (q->count + q->block - 1) / q->block;
+    if (threads == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = n > 0 ? (unsigned) n : 1;
+    }
+    if (threads > blocks)
+        threads = (unsigned) blocks;
+    pthread_mutex_init(&q->lock, NULL);
+    if (threads > 1) {
+        pthread_t *workers = (pthread_t *) malloc((threads - 1) * sizeof(pthread_t));
+        unsigned started;
+        for (started = 0; started < threads - 1; started++)
+            if (pthread_create(&workers[started], NULL, worker, q) != 0)
+                break; //创建失败时用已有的线程继续
+        worker(q); //当前线程也参与
+        while (started)
+            pthread_join(workers[--started], NULL);
+        free(workers);
+    } else {
+        worker(q);
+    }
+    pthread_mutex_destroy(&q->lock);
+#else
+    (void) threads;
+    worker(q);
+#endif
+}
+
+/* NDJSON: 先顺序地按 '\n' 切出记录, 再由多个线程按块领取记录并行解析
+ * 每个线程只有一个 lept_context, 解析栈在记录之间复用
+ */
+
+#ifndef LEPT_NDJSON_BLOCK
+#define LEPT_NDJSON_BLOCK 256 //线程每次领取的记录数
+#endif
+
+typedef struct {
+    lept_work_queue q;
+    const char *json;
+    const size_t *ranges; //第 i 条记录是 [ranges[2i], ranges[2i+1])
+    lept_batch *b;
+} lept_ndjson_job;
+
+static void *lept_ndjson_worker(void *arg) {
+
+    lept_ndjson_job *job = (lept_ndjson_job *) arg;
+    lept_batch *b = job->b;
+    lept_context c;
+    size_t i, n;
+
+    lept_context_init(&c);
+    while ((i = lept_work_take(&job->q)) < b->count) {
+        for (n = i + LEPT_NDJSON_BLOCK < b->count ? i + LEPT_NDJSON_BLOCK : b->count; i < n; i++) {
+            c.json = job->json + job->ranges[2 * i];
+            c.end = job->json + job->ranges[2 * i + 1];
+            b->errors[i] = lept_parse_root(&c, &b->values[i]);
+        }
+    }
+    lept_mem_free(c.alloc, c.stack);
+    return NULL;
+}
+
+void lept_batch_init(lept_batch *b) {
+
+    assert(b != NULL);
+    b->values = NULL;
+    b->errors = NULL;
+    b->lines = NULL;
+    b->count = 0;
+}
+
+void lept_batch_free(lept_batch *b) {
+
+    assert(b != NULL);
+    for (size_t i = 0; i < b->count; i++)
+        lept_free(&b->values[i]);
+    free(b->values);
+    free(b->errors);
+    free(b->lines);
+    lept_batch_init(b);
+}
+
+int lept_parse_ndjson(lept_batch *b, const char *json, size_t len, unsigned threads) {
+
+    lept_ndjson_job job;
+    size_t *ranges = NULL, cap = 0, line = 0, i;
+    const char *p = json, *end = json + len;
+    assert(b != NULL && (json != NULL || len == 0));
+
+    lept_batch_free(b);
+    //切分记录, 只有空白的行不算记录
+    while (p != end) {
+        const char *q = (const char *) memchr(p, '\n', end - p);
+        if (q == NULL)
+            q = end;
+        line++;
+        if (lept_skip_whitespace(p, q) != q) {
+            if (b->count == cap) {
+                cap = cap ? cap + (cap >> 1) : 64;
+                ranges = (size_t *) realloc(ranges, 2 * cap * sizeof(size_t));
+                b->lines = (size_t *) realloc(b->lines, cap * sizeof(size_t));
+            }
+            ranges[2 * b->count] = p - json;
+            ranges[2 * b->count + 1] = q - json;
+            b->lines[b->count++] = line;
+        }
+        p = q != end ? q + 1 : end;
+    }
+    if (b->count == 0) {
+        free(ranges);
+        return LEPT_PARSE_OK;
+    }
+    b->values = (lept_value *) malloc(b->count * sizeof(lept_value));
+    b->errors = (int *) malloc(b->count * sizeof(int));
+
+    lept_work_init(&job.q, b->count, LEPT_NDJSON_BLOCK);
+    job.json = json;
+    job.ranges = ranges;
+    job.b = b;
+    lept_work_run(&job.q, lept_ndjson_worker, threads);
+    free(ranges);
+
+    for (i = 0; i < b->count; i++)
+        if (b->errors[i] != LEPT_PARSE_OK)
+            return b->errors[i];
+    return LEPT_PARSE_OK;
+}
+
+/* 单个大文档的并行解析: 根是数组时, 先找出第一层元素的边界, 再让多个线程分别解析各个元素
+ * 第一阶段每 64 字节用 SIMD 算出引号, '\\' 和括号/逗号的位图, 去掉转义的引号和字符串内部的字符,
+ * 只按顺序遍历剩下的括号和逗号计算深度; 第二阶段每个元素仍由 lept_parse_value 解析
+ * 出错时重新顺序解析一遍, 得到和 lept_parse_n 一样的错误码
+ */
+
+#ifndef LEPT_PARALLEL_MIN_SIZE
+#define LEPT_PARALLEL_MIN_SIZE (256 * 1024) //更小的文档直接顺序解析
+#endif
+#ifndef LEPT_PARALLEL_BLOCK
+#define LEPT_PARALLEL_BLOCK 64 //线程每次领取的元素数
+#endif
+
+typedef struct {
+    uint64_t quote, backslash, open, close, comma;
+} lept_block_masks;
+
+static unsigned lept_ctz64(uint64_t x) {
+
+    assert(x != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned) __builtin_ctzll(x);
+#else
+    unsigned n = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+//'[' 和 '{', ']' 和 '}' 只差 0x20 这一位
+#ifdef LEPT_AVX2
+__attribute__((target("avx2")))
+static void lept_block_masks_avx2(const char *p, lept_block_masks *m) {
+
+    const __m256i quote = _mm256_set1_epi8('"'), backslash = _mm256_set1_epi8('\\');
+    const __m256i open = _mm256_set1_epi8('{'), close = _mm256_set1_epi8('}');
+    const __m256i comma = _mm256_set1_epi8(','), lower = _mm256_set1_epi8(0x20);
+    memset(m, 0, sizeof(*m));
+    for (int i = 0; i < 2; i++) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) (p + 32 * i)), y = _mm256_or_si256(x, lower);
+        m->quote |= (uint64_t) (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, quote)) << 32 * i;
+        m->backslash |= (uint64_t) (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, backslash)) << 32 * i;
+        m->open |= (uint64_t) (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(y, open)) << 32 * i;
+        m->close |= (uint64_t) (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(y, close)) << 32 * i;
+        m->comma |= (uint64_t) (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, comma)) << 32 * i;
+    }
+}
+#endif
+
+static void lept_block_masks_compute(const char *p, lept_block_masks *m) {
+
+#ifdef LEPT_SSE2
+    const __m128i quote = _mm_set1_epi8('"'), backslash = _mm_set1_epi8('\\');
+    const __m128i open = _mm_set1_epi8('{'), close = _mm_set1_epi8('}');
+    const __m128i comma = _mm_set1_epi8(','), lower = _mm_set1_epi8(0x20);
+    memset(m, 0, sizeof(*m));
+    for (int i = 0; i < 4; i++) {
+        __m128i x = _mm_loadu_si128((const __m128i *) (p + 16 * i)), y = _mm_or_si128(x, lower);
+        m->quote |= (uint64_t) _mm_movemask_epi8(_mm_cmpeq_epi8(x, quote)) << 16 * i;
+        m->backslash |= (uint64_t) _mm_movemask_epi8(_mm_cmpeq_epi8(x, backslash)) << 16 * i;
+        m->open |= (uint64_t) _mm_movemask_epi8(_mm_cmpeq_epi8(y, open)) << 16 * i;
+        m->close |= (uint64_t) _mm_movemask_epi8(_mm_cmpeq_epi8(y, close)) << 16 * i;
+        m->comma |= (uint64_t) _mm_movemask_epi8(_mm_cmpeq_epi8(x, comma)) << 16 * i;
+    }
+#else
+    memset(m, 0, sizeof(*m));
+    for (int i = 0; i < 64; i++) {
+        char ch = p[i];
+        uint64_t bit = (uint64_t) 1 << i;
+        if (ch == '"') m->quote |= bit;
+        else if (ch == '\\') m->backslash |= bit;
+        else if ((ch | 0x20) == '{') m->open |= bit;
+        else if ((ch | 0x20) == '}') m->close |= bit;
+        else if (ch == ',') m->comma |= bit;
+    }
+#endif
+}
+
+/* 被奇数个连续的 '\\' 转义的字符; *carry 表示上一块以奇数个 '\\' 结尾 */
+static uint64_t lept_escaped_mask(uint64_t bs, uint64_t *carry) {
+
+    const uint64_t even_bits = 0x5555555555555555u, odd_bits = ~even_bits;
+    uint64_t start_edges = bs & ~(bs << 1);
+    uint64_t even_start_mask = even_bits ^ *carry; //上一块转义了第 0 位时, 奇偶要反过来算
+    uint64_t even_starts = start_edges & even_start_mask;
+    uint64_t odd_starts = start_edges & ~even_start_mask;
+    uint64_t even_carries = bs + even_starts;
+    uint64_t odd_carries = bs + odd_starts;
+    uint64_t overflow = odd_carries < bs;
+    odd_carries |= *carry;
+    *carry = overflow;
+    //一串 '\\' 之后的第一个字符, 串的起点和终点奇偶不同时说明长度是奇数
+    uint64_t even_carry_ends = even_carries & ~bs;
+    uint64_t odd_carry_ends = odd_carries & ~bs;
+    return (even_carry_ends & odd_bits) | (odd_carry_ends & even_bits);
+}
+
+static uint64_t lept_prefix_xor(uint64_t x) {
+
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+/* 第一阶段: 根数组的 '[' 的位置, 第一层每个 ',' 的位置和对应的 ']' 的位置依次存入 *seps
+ * 返回找到的位置个数, 0 表示没有找到对应的 ']'; 括号只按开闭分类, 最后一个位置也可能是 '}', 由调用者检查
+ */
+static size_t lept_index_array(const char *json, size_t len, size_t **seps) {
+
+    size_t count = 0, cap = 0, base;
+    uint64_t escape_carry = 0, in_string = 0;
+    long depth = 0;
+    char tail[64];
+#ifdef LEPT_AVX2
+    int avx2 = __builtin_cpu_supports("avx2");
+#endif
+    *seps = NULL;
+    for (base = 0; base < len; base += 64) {
+        const char *p = json + base;
+        lept_block_masks m;
+        uint64_t escaped, quote, structural;
+        if (len - base < 64) {
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, p, len - base);
+            p = tail;
+        }
+#ifdef LEPT_AVX2
+        if (avx2)
+            lept_block_masks_avx2(p, &m);
+        else
+#endif
+        lept_block_masks_compute(p, &m);
+
+        escaped = lept_escaped_mask(m.backslash, &escape_carry);
+        quote = m.quote & ~escaped;
+        //字符串内部: 从开始的引号 (含) 到结束的引号 (不含)
+        in_string = lept_prefix_xor(quote) ^ in_string;
+        structural = (m.open | m.close | m.comma) & ~in_string;
+        in_string = (uint64_t) -(int64_t) (in_string >> 63); //最高位扩展到整个字
+
+        while (structural) {
+            unsigned i = lept_ctz64(structural);
+            char ch = p[i];
+            structural &= structural - 1;
+            if (ch == ',') {
+                if (depth != 1)
+                    continue;
+            } else if ((ch | 0x20) == '{') {
+                if (depth++ != 0)
+                    continue;
+            } else if (--depth != 0) {
+                if (depth < 0)
+                    break;
+                continue;
+            }
+            if (count == cap) {
+                cap = cap ? cap + (cap >> 1) : 1024;
+                *seps = (size_t *) realloc(*seps, cap * sizeof(size_t));
+            }
+            (*seps)[count++] = base + i;
+            if (depth == 0)
+                return count;
+        }
+        if (depth < 0)
+            break;
+    }
+    free(*seps);
+    *seps = NULL;
+    return 0;
+}
+
+typedef struct {
+    lept_work_queue q;
+    const char *json, *end;
+    const size_t *seps;
+    lept_value *e;
+} lept_array_job;
+
+static void *lept_array_worker(void *arg) {
+
+    lept_array_job *job = (lept_array_job *) arg;
+    lept_context c;
+    size_t i, n;
+    int ret = LEPT_PARSE_OK;
+
+    lept_context_init(&c);
+    while (ret == LEPT_PARSE_OK && (i = lept_work_take(&job->q)) < job->q.count) {
+        for (n = i + LEPT_PARALLEL_BLOCK < job->q.count ? i + LEPT_PARALLEL_BLOCK : job->q.count; i < n; i++) {
+            //元素自己确定结尾, 解析完之后必须正好停在第一阶段找到的分隔符上
+            c.json = job->json + job->seps[i] + 1;
+            c.end = job->end;
+            lept_parse_whitespace(&c);
+            if ((ret = lept_parse_value(&c, &job->e[i])) == LEPT_PARSE_OK) {
+                lept_parse_whitespace(&c);
+                if (c.json != job->json + job->seps[i + 1])
+                    ret = LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+            }
+            if (ret != LEPT_PARSE_OK) {
+                lept_work_fail(&job->q);
+                break;
+            }
+        }
+    }
+    lept_mem_free(c.alloc, c.stack);
+    return NULL;
+}
+
+int lept_parse_parallel(lept_value *v, const char *json, size_t len, unsigned threads) {
+
+    lept_array_job job;
+    size_t *seps, count, i;
+    const char *p;
+    assert(v != NULL && (json != NULL || len == 0));
+
+#ifndef LEPT_THREADS
+    threads = 1;
+#endif
+    p = lept_skip_whitespace(json, json + len);
+    if (threads == 1 || len < LEPT_PARALLEL_MIN_SIZE || p == json + len || *p != '[' ||
+        (count = lept_index_array(json, len, &seps)) == 0)
+        return lept_parse_n(v, json, len);
+
+    //"[1, 2}" 也能配对, 和元素太多一样交给顺序解析报错
+    if (json[seps[--count]] != ']' || count > LEPT_SIZE_MAX) {
+        free(seps);
+        return lept_parse_n(v, json, len);
+    }
+    //"[ ]": 唯一的一段只有空白
+    if (count == 1 && lept_skip_whitespace(json + seps[0] + 1, json + seps[1]) == json + seps[1])
+        count = 0;
+    job.json = json;
+    job.end = json + len;
+    job.seps = seps;
+    job.e = count ? (lept_value *) malloc(count * sizeof(lept_value)) : NULL;
+    for (i = 0; i < count; i++)
+        lept_init(&job.e[i]);
+    lept_work_init(&job.q, count, LEPT_PARALLEL_BLOCK);
+    if (count)
+        lept_work_run(&job.q, lept_array_worker, threads);
+
+    p = lept_skip_whitespace(json + seps[count ? count : 1] + 1, json + len);
+    free(seps);
+    if (job.q.failed || p != json + len) {
+        for (i = 0; i < count; i++)
+            lept_free(&job.e[i]);
+        free(job.e);
+        return lept_parse_n(v, json, len);
+    }
+    lept_init(v);
+    v->type = LEPT_ARRAY;
+    v->size = count;
+    v->u.e = job.e;
+    return LEPT_PARSE_OK;
+}
+
+/* key 驻留表: 按哈希的高位分成 LEPT_INTERN_SHARDS 份, 每份是一个开放寻址的哈希表, 各自加锁 (没有 LEPT_THREADS 时不加锁, 不是线程安全的)
+ * key 的内容从每份自己的 arena 中分配, 驻留之后不会移动也不会释放, 直到整个表释放
+ */
+typedef struct {
+    const char *s;
+    size_t len;
+    uint32_t hash;
+} lept_intern_entry;
+
+typedef struct {
+#ifdef LEPT_THREADS
+    pthread_mutex_t lock;
+#endif
+    lept_intern_entry *entries;
+    size_t count, cap; //cap 是 2 的幂, 负载不超过 1/2
+    lept_arena arena;
+} lept_intern_shard;
+
+struct lept_intern_table {
+    lept_intern_shard shards[LEPT_INTERN_SHARDS];
+};
+
+lept_intern_table *lept_intern_table_new(void) {
+
+    lept_intern_table *t = (lept_intern_table *) malloc(sizeof(lept_intern_table));
+    for (size_t i = 0; i < LEPT_INTERN_SHARDS; i++) {
+        lept_intern_shard *shard = &t->shards[i];
+#ifdef LEPT_THREADS
+        pthread_mutex_init(&shard->lock, NULL);
+#endif
+        shard->entries = NULL;
+        shard->count = shard->cap = 0;
+        shard->arena.head = NULL;
+        shard->arena.chunk_size = 0;
+        shard->arena.alloc = NULL;
+    }
+    return t;
+}
+
+void lept_intern_table_free(lept_intern_table *t) {
+
+    if (t == NULL)
+        return;
+    for (size_t i = 0; i < LEPT_INTERN_SHARDS; i++) {
+        lept_intern_shard *shard = &t->shards[i];
+#ifdef LEPT_THREADS
+        pthread_mutex_destroy(&shard->lock);
+#endif
+        free(shard->entries);
+        lept_arena_free(&shard->arena);
+    }
+    free(t);
+}
+
+static void lept_intern_grow(lept_intern_shard *shard) {
+
+    size_t cap = shard->cap ? shard->cap * 2 : 64;
+    lept_intern_entry *entries = (lept_intern_entry *) calloc(cap, sizeof(lept_intern_entry));
+    for (size_t i = 0; i < shard->cap; i++) {
+        const lept_intern_entry *e = &shard->entries[i];
+        if (e->s) {
+            size_t j = e->hash & (cap - 1);
+            while (entries[j].s)
+                j = (j + 1) & (cap - 1);
+            entries[j] = *e;
+        }
+    }
+    free(shard->entries);
+    shard->entries = entries;
+    shard->cap = cap;
+}
+
+const char *lept_intern(lept_intern_table *t, const char *s, size_t len) {
+
+    lept_intern_shard *shard;
+    const char *ret;
+    uint32_t h;
+    size_t j;
+    assert(t != NULL && (s != NULL || len == 0));
+    h = lept_hash_key(s, len);
+    shard = &t->shards[(h >> 24) & (LEPT_INTERN_SHARDS - 1)]; //槽位用的是低位
+#ifdef LEPT_THREADS
+    pthread_mutex_lock(&shard->lock);
+#endif
+    if (2 * (shard->count + 1) > shard->cap)
+        lept_intern_grow(shard);
+    for (j = h & (shard->cap - 1); shard->entries[j].s; j = (j + 1) & (shard->cap - 1)) {
+        const lept_intern_entry *e = &shard->entries[j];
+        if (e->hash == h && e->len == len && memcmp(e->s, s, len) == 0) {
+            ret = e->s;
+            goto done;
+        }
+    }
+    {
+        char *p = (char *) lept_arena_alloc(&shard->arena, len + 1);
+        memcpy(p, s, len);
+        p[len] = '\0';
+        shard->entries[j].s = ret = p;
+        shard->entries[j].len = len;
+        shard->entries[j].hash = h;
+        shard->count++;
+    }
+done:
+#ifdef LEPT_THREADS
+    pthread_mutex_unlock(&shard->lock);
+#endif
+    return ret;
+}
+
+void lept_document_init(lept_document *d) {
+
+    assert(d != NULL);
+    lept_init(&d->root);
+    d->arena.head = NULL;
+    d->arena.chunk_size = 0;
+    d->arena.alloc = NULL;
+    d->keys = NULL;
+    d->map = NULL;
+    d->map_size = 0;
+}
+
+/* 所有文档解析入口的公共设置: 先释放 d 原有的内容, 值从 d 的 arena 分配, 长 key 用 d 的驻留表
+ * 入口只需要再设置自己不同的字段 (insitu, borrow 等)
+ */
+static void lept_document_context(lept_document *d, lept_context *c, const char *json, size_t len) {
+
+    lept_document_free(d);
+    lept_context_init(c);
+    c->json = json;
+    c->end = json + len;
+    c->arena = &d->arena;
+    c->alloc = d->arena.alloc;
+    c->keys = d->keys;
+    c->flags = LEPT_VALUE_BORROWED;
+}
+
+static int lept_lazy_scan_value(lept_context *c);
+static void lept_workspace_leave(lept_workspace *w, const lept_context *c);
+
+/* 解析根值, 然后释放栈 (w 不为 NULL 时把栈还给工作区)
+ * lazy 时先用一遍扫描检查整个输入, 记录搬到 arena 里, 再 "解析" 根: 根是数组/对象时只生成一个延迟的值, 标量直接解析
+ */
+static int lept_document_parse_context(lept_document *d, lept_context *c, int lazy, lept_workspace *w) {
+
+    int ret = LEPT_PARSE_OK;
+    if (lazy) {
+        const char *json = c->json;
+        lept_parse_whitespace(c);
+        if ((ret = lept_lazy_scan_value(c)) == LEPT_PARSE_OK) {
+            lept_parse_whitespace(c);
+            if (c->json != c->end)
+                ret = LEPT_PARSE_ROOT_NOT_SINGULAR;
+        }
+        if (ret == LEPT_PARSE_OK && c->top) {
+            lept_lazy *nodes = (lept_lazy *) lept_arena_alloc(&d->arena, c->top);
+            memcpy(nodes, c->stack, c->top);
+            for (size_t i = 0; i < c->top / sizeof(lept_lazy); i++)
+                nodes[i].doc = d;
+            c->lazy = nodes;
+            c->top = 0;
+        }
+        c->json = json;
+    }
+    if (ret == LEPT_PARSE_OK) {
+        ret = lept_parse_root(c, &d->root);
+        assert(!lazy || ret == LEPT_PARSE_OK);
+    }
+    if (w)
+        lept_workspace_leave(w, c);
+    else
+        lept_mem_free(c->alloc, c->stack);
+    return ret;
+}
+
+int lept_document_parse(lept_document *d, const char *json) {
+
+    assert(d != NULL && json != NULL);
+    return lept_document_parse_n(d, json, strlen(json));
+}
+
+int lept_document_parse_n(lept_document *d, const char *json, size_t len) {
+
+    lept_context c;
+    assert(d != NULL && (json != NULL || len == 0));
+
+    lept_document_context(d, &c, json, len);
+    return lept_document_parse_context(d, &c, 0, NULL);
+}
+
+int lept_parse_with(lept_value *v, const char *json, size_t len, const lept_allocator *a) {
+
+    lept_context c;
+    assert(v != NULL && (json != NULL || len == 0));
+
+    lept_context_init(&c);
+    c.json = json;
+    c.end = json + len;
+    c.alloc = a;
+    int ret = lept_parse_root(&c, v);
+    lept_mem_free(c.alloc, c.stack);
+
+    return ret;
+}
+
+int lept_parse_insitu(lept_value *v, char *json) {
+
+    lept_context c;
+    assert(v != NULL && json != NULL);
+
+    lept_context_init(&c);
+    c.json = json;
+    c.end = json + strlen(json);
+    c.insitu = 1;
+    int ret = lept_parse_root(&c, v);
+    lept_mem_free(c.alloc, c.stack);
+
+    return ret;
+}
+
+int lept_document_parse_insitu(lept_document *d, char *json) {
+
+    lept_context c;
+    assert(d != NULL && json != NULL);
+
+    lept_document_context(d, &c, json, strlen(json));
+    c.insitu = 1;
+    return lept_document_parse_context(d, &c, 0, NULL);
+}
+
+#ifndef _WIN32
+/* 只读映射整个文件, 按顺序读的提示让内核预读并尽早回收读过的页
+ * 空文件不能映射, *data 为 NULL, *len 为 0
+ */
+static int lept_map_file(const char *path, const char **data, size_t *len) {
+
+    struct stat st;
+    void *p;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return LEPT_PARSE_FILE_ERROR;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (uint64_t) st.st_size > SIZE_MAX) {
+        close(fd);
+        return LEPT_PARSE_FILE_ERROR;
+    }
+    *data = NULL;
+    if ((*len = (size_t) st.st_size) == 0) {
+        close(fd);
+        return LEPT_PARSE_OK;
+    }
+    p = mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); //映射不依赖 fd
+    if (p == MAP_FAILED)
+        return LEPT_PARSE_FILE_ERROR;
+#ifdef MADV_SEQUENTIAL
+    madvise(p, *len, MADV_SEQUENTIAL);
+#endif
+    *data = (const char *) p;
+    return LEPT_PARSE_OK;
+}
+
+int lept_parse_file(lept_value *v, const char *path) {
+
+    const char *json;
+    size_t len;
+    int ret;
+    assert(v != NULL && path != NULL);
+
+    lept_init(v);
+    if ((ret = lept_map_file(path, &json, &len)) != LEPT_PARSE_OK)
+        return ret;
+    ret = lept_parse_n(v, json ? json : "", len);
+    if (json)
+        munmap((void *) json, len);
+    return ret;
+}
+
+int lept_document_parse_file(lept_document *d, const char *path) {
+
+    lept_context c;
+    const char *json;
+    size_t len;
+    int ret;
+    assert(d != NULL && path != NULL);
+
+    if ((ret = lept_map_file(path, &json, &len)) != LEPT_PARSE_OK) {
+        lept_document_free(d);
+        return ret;
+    }
+    lept_document_context(d, &c, json ? json : "", len); //先释放原来的映射, 再记下新的
+    d->map = (void *) json;
+    d->map_size = len;
+    c.borrow = c.json;
+    ret = lept_document_parse_context(d, &c, 0, NULL);
+#ifdef MADV_NORMAL
+    if (json)
+        madvise((void *) json, len, MADV_NORMAL); //之后按需访问字符串, 不再是顺序读
+#endif
+    return ret;
+}
+#endif
+
+/* 延迟解析的扫描: 和 lept_parse_value 检查同样的语法 (容器走同一个 lept_parse_container), 返回同样的错误码, 但不解码也不分配内存
+ * 每遇到一个数组/对象就在栈上追加一条 lept_lazy 记录, 栈上只有这些记录
+ */
+static int lept_lazy_scan_value(lept_context *c);
+
+/* 不解码, 但要算出解码后的长度, 和 lept_parse_string 一样检查 LEPT_SIZE_MAX */
+static int lept_lazy_scan_string(lept_context *c) {
+
+    const char *p = c->json, *end = c->end, *q;
+    char buf[4];
+    size_t n, len = 0;
+    int ret;
+    EXPECT(c, '"');
+    for (p++;; ) {
+        q = lept_scan_string(p, end);
+        len += q - p;
+        p = q;
+        if (p == end)
+            return LEPT_PARSE_MISS_QUOTATION_MARK;
+        if (*p == '"')
+            break;
+        if (*p != '\\')
+            return LEPT_PARSE_INVALID_STRING_CHAR;
+        p++;
+        if ((ret = lept_parse_escape(&p, end, buf, &n)) != LEPT_PARSE_OK)
+            return ret;
+        len += n;
+    }
+    c->json = p + 1;
+    return len > LEPT_SIZE_MAX ? LEPT_PARSE_TOO_LARGE : LEPT_PARSE_OK;
+}
+
+/* 只检查语法; 整数部分不超过 308 位又没有指数的数字不可能溢出, 其余的交给 lept_parse_number 检查范围 */
+static int lept_lazy_scan_number(lept_context *c) {
+
+#define CH(p) ((p) != end ? *(p) : '\0')
+    const char *p = c->json, *end = c->end, *digits;
+    lept_value v;
+    if (CH(p) == '-')
+        p++;
+    digits = p;
+    if (CH(p) == '0')
+        p++;
+    else {
+        if (!ISDIGIT1TO9(CH(p)))
+            return LEPT_PARSE_INVALID_VALUE;
+        while (ISDIGIT(CH(p)))
+            p++;
+    }
+    if (CH(p) == '.') {
+        p++;
+        if (!ISDIGIT(CH(p)))
+            return LEPT_PARSE_INVALID_VALUE;
+        while (ISDIGIT(CH(p)))
+            p++;
+    }
+    if (CH(p) == 'e' || CH(p) == 'E' || p - digits > 308)
+        return lept_parse_number(c, &v);
+#undef CH
+    c->json = p;
+    return LEPT_PARSE_OK;
+}
+
+/* frame 是这个容器的记录在栈上的下标: 扫描子容器时栈可能重新分配, 不能保存指针 */
+static int lept_lazy_begin(lept_context *c, void *frame) {
+
+    *(size_t *) frame = c->top / sizeof(lept_lazy);
+    ((lept_lazy *) lept_context_push(c, sizeof(lept_lazy)))->json = c->json;
+    return LEPT_PARSE_OK;
+}
+
+static int lept_lazy_key(lept_context *c, void *frame) {
+
+    (void) frame;
+    return lept_lazy_scan_string(c);
+}
+
+static int lept_lazy_value(lept_context *c, void *frame) {
+
+    (void) frame;
+    return lept_lazy_scan_value(c);
+}
+
+static int lept_lazy_end(lept_context *c, void *frame, size_t size) {
+
+    size_t index = *(size_t *) frame;
+    lept_lazy *node = (lept_lazy *) c->stack + index;
+    if (size > LEPT_SIZE_MAX)
+        return LEPT_PARSE_TOO_LARGE;
+    node->end = c->json;
+    node->size = size;
+    node->descendants = c->top / sizeof(lept_lazy) - index - 1;
+    return LEPT_PARSE_OK;
+}
+
+static const lept_grammar lept_lazy_array = {
+    LEPT_ARRAY, lept_lazy_begin, NULL, lept_lazy_value, lept_lazy_end, NULL
+};
+static const lept_grammar lept_lazy_object = {
+    LEPT_OBJECT, lept_lazy_begin, lept_lazy_key, lept_lazy_value, lept_lazy_end, NULL
+};
+
+static int lept_lazy_scan_value(lept_context *c) {
+
+    lept_value v;
+    size_t index;
+    if (c->json == c->end)
+        return LEPT_PARSE_EXPECT_VALUE;
+    switch (*c->json) {
+        case 'n':
+            return lept_parse_literal(c, &v, LEPT_NULL);
+        case 't':
+            return lept_parse_literal(c, &v, LEPT_TRUE);
+        case 'f':
+            return lept_parse_literal(c, &v, LEPT_FALSE);
+        case '"':
+            return lept_lazy_scan_string(c);
+        case '[':
+            return lept_parse_container(c, &lept_lazy_array, &index);
+        case '{':
+            return lept_parse_container(c, &lept_lazy_object, &index);
+        default:
+            return lept_lazy_scan_number(c);
+    }
+}
+
+int lept_document_parse_lazy(lept_document *d, const char *json, size_t len) {
+
+    lept_context c;
+    assert(d != NULL && (json != NULL || len == 0));
+
+    lept_document_context(d, &c, json, len);
+    return lept_document_parse_context(d, &c, 1, NULL);
+}
+
+void lept_document_free(lept_document *d) {
+
+    assert(d != NULL);
+    //整棵树都在 arena 里, 不需要遍历, 按 chunk 释放即可
+    lept_arena_free(&d->arena);
+#ifndef _WIN32
+    if (d->map)
+        munmap(d->map, d->map_size);
+#endif
+    d->map = NULL;
+    d->map_size = 0;
+    lept_init(&d->root);
+}
+
+/* 展开延迟的数组/对象: 只解析这一层, 子数组/对象的记录从 node + 1 开始
+ * 内容在扫描时已经检查过, 不会出错; 访问函数的参数是 const 的, 但值本身是可写的
+ */
+static void lept_lazy_expand(const lept_value *v) {
+
+    const lept_lazy *node = v->u.l;
+    lept_context c;
+    int ret;
+    lept_context_init(&c);
+    c.json = node->json;
+    c.end = node->end;
+    c.arena = &node->doc->arena;
+    c.alloc = node->doc->arena.alloc;
+    c.keys = node->doc->keys;
+    c.flags = LEPT_VALUE_BORROWED;
+    c.lazy = node + 1;
+    if (v->type == LEPT_ARRAY)
+        ret = lept_parse_array(&c, (lept_value *) v);
+    else
+        ret = lept_parse_object(&c, (lept_value *) v);
+    assert(ret == LEPT_PARSE_OK && c.top == 0);
+    (void) ret;
+    lept_mem_free(c.alloc, c.stack);
+}
+
+#define LEPT_LAZY_EXPAND(v) do { if ((v)->flags & LEPT_VALUE_LAZY) lept_lazy_expand(v); } while(0)
+
+/* Access functions */
+lept_type lept_get_type(const lept_value *v) {
+
+    assert(v != NULL);
+    return (lept_type) v->type;
+}
+
+int lept_get_boolean(const lept_value *v) {
+
+    assert(v != NULL && (v->type == LEPT_TRUE || v->type == LEPT_FALSE));
+    return v->type == LEPT_TRUE;
+}
+
+void lept_set_boolean(lept_value *v, int bool) {
+
+    lept_set_boolean_with(v, bool, NULL);
+}
+
+void lept_set_boolean_with(lept_value *v, int bool, const lept_allocator *a) {
+
+    assert(v != NULL);
+    lept_free_value(v, a); //容易内存泄露
+    v->type = bool ? LEPT_TRUE : LEPT_FALSE;
+}
+
+double lept_get_number(const lept_value *v) {
+
+    assert(v != NULL && v->type == LEPT_NUMBER);
+    return v->u.n;
+}
+
+void lept_set_number(lept_value *v, double n) {
+
+    lept_set_number_with(v, n, NULL);
+}
+
+void lept_set_number_with(lept_value *v, double n, const lept_allocator *a) {
+
+    assert(v != NULL);
+    lept_free_value(v, a); //memory leak
+    v->u.n = n;
+    v->type = LEPT_NUMBER;
+}
+
+const char *lept_get_string(const lept_value *v) {
+
+    assert(v != NULL && v->type == LEPT_STRING);
+    return LEPT_STRING(v);
+}
+
+void lept_set_string(lept_value *v, const char *s, size_t len) {
+
+    lept_set_string_with(v, s, len, NULL);
+}
+
+void lept_set_string_with(lept_value *v, const char *s, size_t len, const lept_allocator *a) {
+
+    assert(v != NULL && (s != NULL || len == 0) && len <= LEPT_SIZE_MAX);
+    lept_free_value(v, a);
+    if (len <= LEPT_INLINE_MAX) {
+        lept_set_inline_string(v, s, len);
+        return;
+    }
+    v->u.s = (char *) lept_mem_alloc(a, len + 1);
+    // Copies count characters from the object pointed to by src to the object pointed to by dest.
+    // Both objects are interpreted as arrays of unsigned char.
+    memcpy(v->u.s, s, len);
+    v->u.s[len] = '\0';
+    v->size = (uint32_t) len;
+    v->type = LEPT_STRING;
+}
+
+size_t lept_get_string_length(const lept_value *v) {
+
+    assert(v != NULL && v->type == LEPT_STRING);
+    return LEPT_STRING_LENGTH(v);
+}
+
+size_t lept_get_array_size(const lept_value *v) {
+
+    assert(v != NULL && v->type == LEPT_ARRAY);
+    return v->size; //延迟的数组也不需要展开
+}
+
+lept_value *lept_get_array_element(const lept_value *v, size_t index) {
+
+    assert(lept_get_type(v) == LEPT_ARRAY);
+    LEPT_LAZY_EXPAND(v);
+    assert(index < v->size);
+    return &v->u.e[index];
+}
+
+size_t lept_get_object_size(const lept_value *v) {
+
+    assert(v != NULL && v->type == LEPT_OBJECT);
+    return v->size;
+}
+
+const char *lept_get_object_key(const lept_value *v, size_t index) {
+
+    assert(v != NULL && v->type == LEPT_OBJECT);
+    LEPT_LAZY_EXPAND(v);
+    assert(index < v->size);
+    return LEPT_STRING(&v->u.m[index].k);
+}
+
+size_t lept_get_object_key_length(const lept_value *v, size_t index) {
+
+    assert(v != NULL && v->type == LEPT_OBJECT);
+    LEPT_LAZY_EXPAND(v);
+    assert(index < v->size);
+    return LEPT_STRING_LENGTH(&v->u.m[index].k);
+}
+
+lept_value *lept_get_object_value(const lept_value *v, size_t index) {
+
+    assert(v != NULL && v->type == LEPT_OBJECT);
+    LEPT_LAZY_EXPAND(v);
+    assert(index < v->size);
+    return &v->u.m[index].v;
+}
+
+/* h 是 lept_hash_key(key, klen), 由调用者算好; 没有索引的小对象用不到 */
+static size_t lept_find_member(const lept_value *v, const char *key, size_t klen, uint32_t h) {
+
+    LEPT_LAZY_EXPAND(v);
+    size_t size = v->size, cap = lept_object_index_capacity(size);
+    if (cap) {
+        const lept_member_slot *slots = (const lept_member_slot *) (v->u.m + size);
+        for (size_t j = h & (cap - 1); slots[j].index; j = (j + 1) & (cap - 1))
+            if (slots[j].hash == h && lept_member_key_equal(&v->u.m[slots[j].index - 1], key, klen))
+                return slots[j].index - 1;
+        return LEPT_KEY_NOT_EXIST;
+    }
+    for (size_t i = 0; i < size; i++)
+        if (lept_member_key_equal(&v->u.m[i], key, klen))
+            return i;
+    return LEPT_KEY_NOT_EXIST;
+}
+
+size_t lept_find_object_index(const lept_value *v, const char *key, size_t klen) {
+
+    assert(v != NULL && v->type == LEPT_OBJECT && (key != NULL || klen == 0));
+    if (lept_object_index_capacity(lept_get_object_size(v)) == 0)
+        return lept_find_member(v, key, klen, 0);
+    return lept_find_member(v, key, klen, lept_hash_key(key, klen));
+}
+
+lept_value *lept_find_object_value(const lept_value *v, const char *key, size_t klen) {
+
+    size_t index = lept_find_object_index(v, key, klen);
+    return index != LEPT_KEY_NOT_EXIST ? &v->u.m[index].v : NULL;
+}
+
+/* JSON Pointer: 编译时把每一段反转义, 预先算好哈希和数组下标; 指针, 各段和反转义后的 key 在同一次分配的内存里 */
+typedef struct {
+    const char *k; //反转义后的一段, 不以 '\0' 结尾
+    size_t klen;
+    size_t index; //作为数组下标的值; "-", 有前导 0, 不是数字或者溢出时为 LEPT_KEY_NOT_EXIST
+    uint32_t hash; //lept_hash_key(k, klen)
+} lept_pointer_token;
+
+struct lept_pointer {
+    size_t count;
+    lept_pointer_token *t;
+};
+
+static size_t lept_pointer_index(const char *k, size_t klen) {
+
+    size_t index = 0;
+    if (klen == 0 || (klen > 1 && k[0] == '0'))
+        return LEPT_KEY_NOT_EXIST;
+    for (size_t i = 0; i < klen; i++) {
+        if (!ISDIGIT(k[i]) || index > (LEPT_KEY_NOT_EXIST - 1 - (k[i] - '0')) / 10)
+            return LEPT_KEY_NOT_EXIST;
+        index = index * 10 + (k[i] - '0');
+    }
+    return index;
+}
+
+lept_pointer *lept_pointer_compile(const char *path, size_t len) {
+
+    size_t count = 0, i, n;
+    lept_pointer *p;
+    char *k;
+    assert(path != NULL || len == 0);
+    if (len && path[0] != '/')
+        return NULL;
+    for (i = 0; i < len; i++) {
+        if (path[i] == '/')
+            count++;
+        else if (path[i] == '~' && (i + 1 == len || (path[i + 1] != '0' && path[i + 1] != '1')))
+            return NULL;
+    }
+    //反转义之后不会比原文长, key 的总长度不超过 len
+    p = (lept_pointer *) malloc(sizeof(lept_pointer) + count * sizeof(lept_pointer_token) + len);
+    p->count = count;
+    p->t = (lept_pointer_token *) (p + 1);
+    k = (char *) (p->t + count);
+    for (i = 0, n = 0; n < count; n++) {
+        lept_pointer_token *t = &p->t[n];
+        t->k = k;
+        for (i++; i < len && path[i] != '/'; i++) {
+            if (path[i] == '~')
+                *k++ = path[++i] == '0' ? '~' : '/';
+            else
+                *k++ = path[i];
+        }
+        t->klen = k - t->k;
+        t->hash = lept_hash_key(t->k, t->klen);
+        t->index = lept_pointer_index(t->k, t->klen);
+    }
+    return p;
+}
+
+void lept_pointer_free(lept_pointer *p) {
+
+    free(p);
+}
+
+static lept_value *lept_pointer_step(const lept_value *v, const lept_pointer_token *t) {
+
+    size_t index;
+    switch (v->type) {
+        case LEPT_OBJECT:
+            index = lept_find_member(v, t->k, t->klen, t->hash);
+            return index != LEPT_KEY_NOT_EXIST ? &v->u.m[index].v : NULL;
+        case LEPT_ARRAY:
+            return t->index < lept_get_array_size(v) ? lept_get_array_element(v, t->index) : NULL;
+        default:
+            return NULL;
+    }
+}
+
+lept_value *lept_pointer_get(const lept_pointer *p, const lept_value *v) {
+
+    assert(p != NULL && v != NULL);
+    for (size_t i = 0; i < p->count && v; i++)
+        v = lept_pointer_step(v, &p->t[i]);
+    return (lept_value *) v;
+}
+
+static int lept_pointer_token_equal(const lept_pointer_token *a, const lept_pointer_token *b) {
+
+    return a->hash == b->hash && a->klen == b->klen && memcmp(a->k, b->k, a->klen) == 0;
+}
+
+/* order 中的 n 个指针的前 depth 段都相同, 都指向 v; 下一段相同的指针换到一起, 只查找一次 */
+static void lept_pointer_get_group(lept_pointer *const *ps, size_t *order, size_t n, size_t depth,
+                                   const lept_value *v, lept_value **results) {
+
+    size_t i = 0, j, k;
+    while (i < n) {
+        const lept_pointer *p = ps[order[i]];
+        const lept_pointer_token *t;
+        const lept_value *child;
+        if (p->count == depth) {
+            results[order[i++]] = (lept_value *) v;
+            continue;
+        }
+        t = &p->t[depth];
+        for (j = i + 1, k = i + 1; k < n; k++) {
+            const lept_pointer *q = ps[order[k]];
+            if (q->count > depth && lept_pointer_token_equal(&q->t[depth], t)) {
+                size_t tmp = order[j];
+                order[j++] = order[k];
+                order[k] = tmp;
+            }
+        }
+        if ((child = lept_pointer_step(v, t)) != NULL)
+            lept_pointer_get_group(ps, order + i, j - i, depth + 1, child, results);
+        else
+            for (k = i; k < j; k++)
+                results[order[k]] = NULL;
+        i = j;
+    }
+}
+
+void lept_pointer_get_all(lept_pointer *const *ps, size_t count, const lept_value *v, lept_value **results) {
+
+    size_t *order;
+    assert(v != NULL && ((ps != NULL && results != NULL) || count == 0));
+    if (count == 0)
+        return;
+    order = (size_t *) malloc(count * sizeof(size_t));
+    for (size_t i = 0; i < count; i++)
+        order[i] = i;
+    lept_pointer_get_group(ps, order, count, 0, v, results);
+    free(order);
+}
+
+/* Stringify function */
+
+/* 数字格式化: Ryu 算法求出能 round-trip 的最短十进制表示, 再按照 %g 的规则输出 (不依赖 locale)
+ * 整数值的 double 直接输出整数
+ */
+
+static const uint64_t lept_ryu_pow5_inv_split[342][2] = {
+    {0x0000000000000001u, 0x2000000000000000u},
+    {0x999999999999999au, 0x1999999999999999u},
+    {0x47ae147ae147ae15u, 0x147ae147ae147ae1u},
+    {0x6c8b4395810624deu, 0x10624dd2f1a9fbe7u},
+    {0x7a786c226809d496u, 0x1a36e2eb1c432ca5u},
+    {0x61f9f01b866e43abu, 0x14f8b588e368f084u},
+    {0xb4c7f34938583622u, 0x10c6f7a0b5ed8d36u},
+    {0x87a6520ec08d236au, 0x1ad7f29abcaf4857u},
+    {0x9fb841a566d74f88u, 0x15798ee2308c39dfu},
+    {0xe62d01511f12a607u, 0x112e0be826d694b2u},
+    {0xd6ae6881cb5109a4u, 0x1b7cdfd9d7bdbab7u},
+    {0xdef1ed34a2a73aeau, 0x15fd7fe17964955fu},
+    {0x7f27f0f6e885c8bbu, 0x119799812dea1119u},
+    {0x650cb4be40d60df8u, 0x1c25c268497681c2u},
+    {0xea70909833de7193u, 0x16849b86a12b9b01u},
+    {0x21f3a6e0297ec143u, 0x1203af9ee756159bu},
+    {0x6985d7cd0f313537u, 0x1cd2b297d889bc2bu},
+    {0x2137dfd73f5a90f9u, 0x170ef54646d49689u},
+    {0xe75fe645cc4873fau, 0x12725dd1d243aba0u},
+    {0xa5663d3c7a0d865du, 0x1d83c94fb6d2ac34u},
+    {0x511e976394d79eb1u, 0x179ca10c9242235du},
+    {0xda7edf82dd794bc1u, 0x12e3b40a0e9b4f7du},
+    {0x2a6498d1625bac68u, 0x1e392010175ee596u},
+    {0xeeb6e0a781e2f053u, 0x182db34012b25144u},
+    {0x58924d52ce4f26a9u, 0x1357c299a88ea76au},
+    {0x27507bb7b07ea441u, 0x1ef2d0f5da7dd8aau},
+    {0x52a6c95fc0655034u, 0x18c240c4aecb13bbu},
+    {0x0eebd44c99eaa690u, 0x13ce9a36f23c0fc9u},
+    {0xb17953adc3110a80u, 0x1fb0f6be50601941u},
+    {0xc12ddc8b02740867u, 0x195a5efea6b34767u},
+    {0x3424b06f3529a052u, 0x14484bfeebc29f86u},
+    {0x901d59f290ee19dbu, 0x1039d66589687f9eu},
+    {0x4cfbc31db4b0295fu, 0x19f623d5a8a73297u},
+    {0x3d9635b15d59bab2u, 0x14c4e977ba1f5bacu},
+    {0x97ab5e277de16228u, 0x109d8792fb4c4956u},
+    {0xf2abc9d8c9689d0du, 0x1a95a5b7f87a0ef0u},
+    {0x5bbca17a3aba173eu, 0x154484932d2e725au},
+    {0xafca1ac82efb45cbu, 0x11039d428a8b8eaeu},
+    {0xb2dcf7a6b1920945u, 0x1b38fb9daa78e44au},
+    {0xf57d92ebc141a104u, 0x15c72fb1552d836eu},
+    {0xc46475896767b403u, 0x116c262777579c58u},
+    {0x6d6d88dbd8a5ecd2u, 0x1be03d0bf225c6f4u},
+    {0x8abe071646eb23dbu, 0x164cfda3281e38c3u},
+    {0x6efe6c11d255b649u, 0x11d7314f534b609cu},
+    {0xb197134fb6ef8a0eu, 0x1c8b821885456760u},
+    {0x27ac0f72f8bfa1a5u, 0x16d601ad376ab91au},
+    {0xb95672c260994e1eu, 0x1244ce242c5560e1u},
+    {0xf5571e03cdc21695u, 0x1d3ae36d13bbce35u},
+    {0x2aac18030b01ababu, 0x17624f8a762fd82bu},
+    {0xbbbce0026f348956u, 0x12b50c6ec4f31355u},
+    {0x92c7ccd0b1eda889u, 0x1dee7a4ad4b81eefu},
+    {0xdbd30a408e57ba07u, 0x17f1fb6f10934bf2u},
+    {0x7ca8d50071dfc806u, 0x1327fc58da0f6ff5u},
+    {0xfaa7bb33e9660cd6u, 0x1ea6608e29b24cbbu},
+    {0x9552fc298784d711u, 0x18851a0b548ea3c9u},
+    {0xaaa8c9bad2d0ac0eu, 0x139dae6f76d88307u},
+    {0xdddadc5e1e1aace3u, 0x1f62b0b257c0d1a5u},
+    {0x7e48b04b4b488a4fu, 0x191bc08eac9a4151u},
+    {0xcb6d59d5d5d3a1d9u, 0x141633a556e1cddau},
+    {0x3c577b1177dc817bu, 0x1011c2eaabe7d7e2u},
+    {0xc6f25e825960cf2au, 0x19b604aaaca62636u},
+    {0x6bf518684780a5bbu, 0x14919d5556eb51c5u},
+    {0x232a79ed06008496u, 0x10747ddddf22a7d1u},
+    {0xd1dd8fe1a3340756u, 0x1a53fc9631d10c81u},
+    {0xa7e4731ae8f66c45u, 0x150ffd44f4a73d34u},
+    {0x531d28e253f8569eu, 0x10d9976a5d52975du},
+    {0xeb61db03b98d5762u, 0x1af5bf109550f22eu},
+    {0xbc4e48cfc7a445e8u, 0x159165a6ddda5b58u},
+    {0x6371d3d96c836b20u, 0x11411e1f17e1e2adu},
+    {0x9f1c8628ad9f11cdu, 0x1b9b6364f3030448u},
+    {0xe5b06b53be18db0bu, 0x1615e91d8f359d06u},
+    {0xeaf3890fcb4715a2u, 0x11ab20e472914a6bu},
+    {0x44b8db4c7871bc37u, 0x1c45016d841baa46u},
+    {0x03c715d6c6c1635fu, 0x169d9abe03495505u},
+    {0x3638de456bcde919u, 0x1217aefe69077737u},
+    {0x56c163a2461641c1u, 0x1cf2b1970e725858u},
+    {0xdf011c81d1ab67ceu, 0x17288e1271f51379u},
+    {0x7f3416ce4155eca5u, 0x1286d80ec190dc61u},
+    {0x6520247d3556476eu, 0x1da48ce468e7c702u},
+    {0xea801d30f7783925u, 0x17b6d71d20b96c01u},
+    {0xbb99b0f3f92cfa84u, 0x12f8ac174d612334u},
+    {0x5f5c4e532847f739u, 0x1e5aacf215683854u},
+    {0x7f7d0b75b9d32c2eu, 0x18488a5b44536043u},
+    {0x9930d5f7c7dc2358u, 0x136d3b7c36a919cfu},
+    {0x8eb4898c72f9d226u, 0x1f152bf9f10e8fb2u},
+    {0x722a07a38f2e41b8u, 0x18ddbcc7f40ba628u},
+    {0xc1bb394fa5be9afau, 0x13e497065cd61e86u},
+    {0x9c5ec2190930f7f6u, 0x1fd424d6faf030d7u},
+    {0x49e56814075a5ff8u, 0x197683df2f268d79u},
+    {0x6e51201005e1e660u, 0x145ecfe5bf520ac7u},
+    {0xf1da800cd181851au, 0x104bd984990e6f05u},
+    {0x4fc400148268d4f5u, 0x1a12f5a0f4e3e4d6u},
+    {0xd96999aa01ed772bu, 0x14dbf7b3f71cb711u},
+    {0xadee1488018ac5bcu, 0x10aff95cc5b09274u},
+    {0x497ceda668de092cu, 0x1ab328946f80ea54u},
+    {0x3aca57b853e4d424u, 0x155c2076bf9a5510u},
+    {0x623b7960431d7683u, 0x1116805effaeaa73u},
+    {0x9d2bf566d1c8bd9eu, 0x1b5733cb32b110b8u},
+    {0x7dbcc452416d647fu, 0x15df5ca28ef40d60u},
+    {0xcafd69db678ab6ccu, 0x117f7d4ed8c33de6u},
+    {0xab2f0fc572778adfu, 0x1bff2ee48e052fd7u},
+    {0x88f273045b92d580u, 0x1665bf1d3e6a8cacu},
+    {0xd3f528d049424466u, 0x11eaff4a98553d56u},
+    {0xb988414d4203a0a3u, 0x1cab3210f3bb9557u},
+    {0x6139cdd76802e6e9u, 0x16ef5b40c2fc7779u},
+    {0xe761717920025254u, 0x125915cd68c9f92du},
+    {0xa568b58e999d5086u, 0x1d5b561574765b7cu},
+    {0x5120913ee14aa6d2u, 0x177c44ddf6c515fdu},
+    {0xa74d40ff1aa21f0eu, 0x12c9d0b1923744cau},
+    {0x0baece64f769cb4au, 0x1e0fb44f50586e11u},
+    {0x3c8bd850c5ee3c3bu, 0x180c903f7379f1a7u},
+    {0xca0979da37f1c9c9u, 0x133d4032c2c7f485u},
+    {0xa9a8c2f6bfe942dbu, 0x1ec866b79e0cba6fu},
+    {0x2153cf2bccba9be3u, 0x18a0522c7e709526u},
+    {0x1aa9728970954982u, 0x13b374f06526ddb8u},
+    {0xf775840f1a88759du, 0x1f8587e7083e2f8cu},
+    {0x5f9136727ba05e17u, 0x19379fec0698260au},
+    {0x1940f85b9619e4dfu, 0x142c7ff0054684d5u},
+    {0xe100c6afab47ea4cu, 0x1023998cd1053710u},
+    {0xce67a44c453fdd47u, 0x19d28f47b4d524e7u},
+    {0xd852e9d69dccb106u, 0x14a8729fc3ddb71fu},
+    {0x79dbee454b0a2738u, 0x1086c219697e2c19u},
+    {0x295fe3a211a9d859u, 0x1a71368f0f30468fu},
+    {0xbab31c81a7bb137au, 0x15275ed8d8f36ba5u},
+    {0x6228e39aec95a92fu, 0x10ec4be0ad8f8951u},
+    {0x9d0e38f7e0ef7517u, 0x1b13ac9aaf4c0ee8u},
+    {0xb0d82d931a592a79u, 0x15a956e225d67253u},
+    {0x8d79be0f4847552eu, 0x11544581b7dec1dcu},
+    {0x158f967eda0bbb7cu, 0x1bba08cf8c979c94u},
+    {0x77a611ff14d62f97u, 0x162e6d72d6dfb076u},
+    {0xf951a7ff43de8c79u, 0x11bebdf578b2f391u},
+    {0xc21c3ffed2fdad8eu, 0x1c6463225ab7ec1cu},
+    {0x01b0333242648ad8u, 0x16b6b5b5155ff017u},
+    {0x0159c28e9b83a246u, 0x122bc490dde659acu},
+    {0xcef604175f3903a3u, 0x1d12d41afca3c2acu},
+    {0x725e69ac4c2d9c83u, 0x17424348ca1c9bbdu},
+    {0xf5185489d68ae39cu, 0x129b69070816e2fdu},
+    {0xee8d540fbdab05c6u, 0x1dc574d80cf16b2fu},
+    {0xbed77672fe226b05u, 0x17d12a4670c1228cu},
+    {0xff12c528cb4ebc04u, 0x130dbb6b8d674ed6u},
+    {0xcb513b74787df9a0u, 0x1e7c5f127bd87e24u},
+    {0x090dc929f9fe614du, 0x18637f41fcad31b7u},
+    {0xa0d7d42194cb810au, 0x1382cc34ca2427c5u},
+    {0x67bfb9cf5478ce77u, 0x1f37ad21436d0c6fu},
+    {0x1fcc94a5dd2d71f9u, 0x18f9574dcf8a7059u},
+    {0x7fd6dd517dbdf4c7u, 0x13faac3e3fa1f37au},
+    {0xffbe2ee8c92fee0bu, 0x1ff779fd329cb8c3u},
+    {0x6631bf20a0f324d6u, 0x1992c7fdc216fa36u},
+    {0xb827cc1a1a5c1d78u, 0x14756ccb01abfb5eu},
+    {0x935309ae7b7ce460u, 0x105df0a267bcc918u},
+    {0x1eeb42b0c594a099u, 0x1a2fe76a3f9474f4u},
+    {0xe58902270476e6e1u, 0x14f31f8832dd2a5cu},
+    {0xb7a0ce859d2bebe7u, 0x10c27fa028b0eeb0u},
+    {0x59014a6f61dfdfd8u, 0x1ad0cc33744e4ab4u},
+    {0xe0cdd525e7e64cadu, 0x1573d68f903ea229u},
+    {0x4d7177518651d6f1u, 0x11297872d9cbb4eeu},
+    {0x7be8bee8d6e957e8u, 0x1b758d848fac54b0u},
+    {0xfcba3253df211320u, 0x15f7a46a0c89dd59u},
+    {0x63c8284318e74280u, 0x1192e9ee706e4aaeu},
+    {0x060d0d3827d86a66u, 0x1c1e43171a4a1117u},
+    {0x6b3da42cecad21ebu, 0x167e9c127b6e7412u},
+    {0x88fe1cf0bd574e56u, 0x11fee341fc585cdbu},
+    {0x419694b462254a23u, 0x1ccb0536608d615fu},
+    {0x67abaa29e81dd4e9u, 0x1708d0f84d3de77fu},
+    {0xb95621bb2017dd87u, 0x126d73f9d764b932u},
+    {0xc223692b668c95a5u, 0x1d7becc2f23ac1eau},
+    {0xce82ba891ed6de1du, 0x179657025b6234bbu},
+    {0xa53562074bdf1818u, 0x12deac01e2b4f6fcu},
+    {0x3b889cd87964f359u, 0x1e3113363787f194u},
+    {0xfc6d4a46c783f5e1u, 0x18274291c6065adcu},
+    {0x30576e9f06032b1au, 0x13529ba7d19eaf17u},
+    {0x1a257dcb3cd1de90u, 0x1eea92a61c311825u},
+    {0x481dfe3c30a7e540u, 0x18bba884e35a79b7u},
+    {0xd34b31c9c0865100u, 0x13c9539d82aec7c5u},
+    {0x5211e942cda3b4cdu, 0x1fa885c8d117a609u},
+    {0x74db21023e1c90a4u, 0x19539e3a40dfb807u},
+    {0xf715b401cb4a0d50u, 0x1442e4fb67196005u},
+    {0xf8de299b09080aa7u, 0x103583fc527ab337u},
+    {0x8e304291a80cddd7u, 0x19ef3993b72ab859u},
+    {0x3e8d020e200a4b13u, 0x14bf6142f8eef9e1u},
+    {0x653d9b3e80083c0fu, 0x10991a9bfa58c7e7u},
+    {0x6ec8f864000d2ce4u, 0x1a8e90f9908e0ca5u},
+    {0x8bd3f9e999a423eau, 0x153eda614071a3b7u},
+    {0x3ca994bae1501cbbu, 0x10ff151a99f482f9u},
+    {0xc775bac49bb3612bu, 0x1b31bb5dc320d18eu},
+    {0xd2c4956a16291a89u, 0x15c162b168e70e0bu},
+    {0xdbd0778811ba7ba1u, 0x11678227871f3e6fu},
+    {0x2c80bf401c5d929bu, 0x1bd8d03f3e9863e6u},
+    {0xbd33cc3349e47549u, 0x16470cff6546b651u},
+    {0xca8fd68f6e505dd4u, 0x11d270cc51055ea7u},
+    {0x4419574be3b3c953u, 0x1c83e7ad4e6efdd9u},
+    {0x0347790982f63aa9u, 0x16cfec8aa52597e1u},
+    {0xcf6c60d468c4fbbau, 0x123ff06eea847980u},
+    {0xe57a34870e07f92au, 0x1d331a4b10d3f59au},
+    {0x512e906c0b399422u, 0x175c1508da432ae2u},
+    {0xda8ba6bcd5c7a9b5u, 0x12b010d3e1cf5581u},
+    {0x90df712e22d90f87u, 0x1de6815302e5559cu},
+    {0xda4c5a8b4f140c6cu, 0x17eb9aa8cf1dde16u},
+    {0xaea37ba2a5a9a38au, 0x1322e220a5b17e78u},
+    {0x7dd25f6aa2a905a9u, 0x1e9e369aa2b59727u},
+    {0x97db7f888220d154u, 0x187e92154ef7ac1fu},
+    {0x797c6606ce80a777u, 0x139874ddd8c6234cu},
+    {0x8f2d700ae4010bf1u, 0x1f5a549627a36badu},
+    {0x0c2459a25000d65au, 0x191510781fb5efbeu},
+    {0x701d1481d99a4515u, 0x1410d9f9b2f7f2feu},
+    {0xc017439b147b6a77u, 0x100d7b2e28c65bfeu},
+    {0xccf205c4ed9243f2u, 0x19af2b7d0e0a2ccau},
+    {0x0a5b37d0be0e9cc2u, 0x148c22ca71a1bd6fu},
+    {0x0848f973cb3ee3ceu, 0x10701bd527b4978cu},
+    {0xda0e5bec78649fb0u, 0x1a4cf9550c5425acu},
+    {0x7b3eaff060507fc0u, 0x150a6110d6a9b7bdu},
+    {0x95cbbff380406633u, 0x10d51a73deee2c97u},
+    {0xefac665266cd7052u, 0x1aee90b964b04758u},
+    {0x2623850eb8a459dbu, 0x158ba6fab6f36c47u},
+    {0x1e82d0d893b6ae49u, 0x113c85955f29236cu},
+    {0xfd9e1af41f8ab075u, 0x1b9408eefea838acu},
+    {0x97b1af29b2d559f7u, 0x16100725988693bdu},
+    {0xac8e25baf5777b2cu, 0x11a66c1e139edc97u},
+    {0x7a7d092b2258c513u, 0x1c3d79c9b8fe2dbfu},
+    {0x61fda0ef4ead6a76u, 0x169794a160cb57ccu},
+    {0xe7fe1a590bbdeec5u, 0x1212dd4de7091309u},
+    {0xa6635d5b45fcb13au, 0x1ceafbafd80e84dcu},
+    {0x851c4aaf6b308dc8u, 0x172262f3133ed0b0u},
+    {0xd0e36ef2bc26d7d4u, 0x1281e8c275cbda26u},
+    {0xb49f17eac6a48c86u, 0x1d9ca79d894629d7u},
+    {0x2a18dfef0550706bu, 0x17b08617a104ee46u},
+    {0x54e0b3259dd9f389u, 0x12f39e794d9d8b6bu},
+    {0x87cdeb6f62f65274u, 0x1e5297287c2f4578u},
+    {0xd30b22bf825ea85du, 0x18421286c9bf6ac6u},
+    {0x0f3c1bcc684bb9e4u, 0x13680ed23aff889fu},
+    {0x18602c7a4079296du, 0x1f0ce4839198da98u},
+    {0x46b356c833942124u, 0x18d71d360e13e213u},
+    {0x388f78a029434db6u, 0x13df4a91a4dcb4dcu},
+    {0x5a7f2766a86baf8au, 0x1fcbaa82a1612160u},
+    {0x153285ebb9efbfa2u, 0x196fbb9bb44db44du},
+    {0xaa8ed189618c994eu, 0x145962e2f6a4903du},
+    {0xeed8a7a11ad6e10cu, 0x1047824f2bb6d9cau},
+    {0x7e27729b5e249b45u, 0x1a0c03b1df8af611u},
+    {0xfe85f549181d4904u, 0x14d6695b193bf80du},
+    {0xcb9e5dd4134aa0d0u, 0x10ab877c142ff9a4u},
+    {0xdf63c9535211014du, 0x1aac0bf9b9e65c3au},
+    {0x191ca10f74da6771u, 0x15566ffafb1eb02fu},
+    {0xadb080d92a4852c1u, 0x1111f32f2f4bc025u},
+    {0x15e7348eaa0d5134u, 0x1b4feb7eb212cd09u},
+    {0xab1f5d3eee710dc4u, 0x15d98932280f0a6du},
+    {0xbc1917658b8da49du, 0x117ad428200c0857u},
+    {0x2cf4f23c127c3a94u, 0x1bf7b9d9cce00d59u},
+    {0xf0c3f4fcdb969543u, 0x165fc7e170b33de0u},
+    {0x5a365d9716121103u, 0x11e6398126f5cb1au},
+    {0x9056fc24f01ce804u, 0x1ca38f350b22de90u},
+    {0xd9df301d8ce3ecd0u, 0x16e93f5da2824ba6u},
+    {0xe17f59b13d8323dau, 0x125432b14ecea2ebu},
+    {0x68cbc2b52f38395cu, 0x1d53844ee47dd179u},
+    {0x53d6355dbf602de3u, 0x177603725064a794u},
+    {0xa9782ab165e68b1cu, 0x12c4cf8ea6b6ec76u},
+    {0x0f26aab56fd744fau, 0x1e07b27dd78b13f1u},
+    {0x3f52222abfdf6a62u, 0x18062864ac6f4327u},
+    {0x65db4e88997f884eu, 0x1338205089f29c1fu},
+    {0x6fc54a7428cc0d4au, 0x1ec033b40fea9365u},
+    {0x596aa1f68709a43bu, 0x1899c2f673220f84u},
+    {0xadeee7f86c07b696u, 0x13ae3591f5b4d936u},
+    {0x497e3ff3e00c5756u, 0x1f7d228322baf524u},
+    {0xd464fff64cd6ac45u, 0x1930e868e89590e9u},
+    {0x4383fff83d7889d1u, 0x14272053ed4473eeu},
+    {0xcf9cccc69793a174u, 0x101f4d0ff1038ff1u},
+    {0x7f6147a425b90252u, 0x19cbae7fe805b31cu},
+    {0xcc4dd2e9b7c7350fu, 0x14a2f1ffecd15c16u},
+    {0x3d0b0f215fd290d9u, 0x10825b3323dab012u},
+    {0x61ab4b689950e7c1u, 0x1a6a2b85062ab350u},
+    {0x4e22a2ba1440b967u, 0x1521bc6a6b555c40u},
+    {0x0b4ee894dd009453u, 0x10e7c9eebc4449cdu},
+    {0x1217da87c800ed51u, 0x1b0c764ac6d3a948u},
+    {0xdb46486ca000bddau, 0x15a391d56bdc876cu},
+    {0x490506bd4ccd64afu, 0x114fa7ddefe39f8au},
+    {0xa8080ac87ae23ab1u, 0x1bb2a62fe638ff43u},
+    {0x5339a239fbe82ef4u, 0x162884f31e93ff69u},
+    {0x75c7b4fb2fecf25du, 0x11ba03f5b20fff87u},
+    {0x22d92191e647ea2eu, 0x1c5cd322b67fff3fu},
+    {0xb57a8141850654f2u, 0x16b0a8e891ffff65u},
+    {0xc4620101373843f5u, 0x1226ed86db3332b7u},
+    {0x3a366801f1f39feeu, 0x1d0b15a491eb8459u},
+    {0xfb5eb99b27f6198bu, 0x173c115074bc69e0u},
+    {0x2f7efae2865e7ad6u, 0x129674405d6387e7u},
+    {0xe597f7d0d6fd9156u, 0x1dbd86cd6238d971u},
+    {0x8479930d78cadaabu, 0x17cad23de82d7ac1u},
+    {0xd06142712d6f1556u, 0x1308a831868ac89au},
+    {0x4d686a4eaf182222u, 0x1e74404f3daada91u},
+    {0xa453883ef279b4e8u, 0x185d003f6488aedau},
+    {0xe9dc6cff28615d87u, 0x137d99cc506d58aeu},
+    {0xa960ae650d6895a4u, 0x1f2f5c7a1a488de4u},
+    {0xbab3beb73ded4483u, 0x18f2b061aea07183u},
+    {0x2ef6322c318a9d36u, 0x13f559e7bee6c136u},
+    {0xe4bd1d13827761f0u, 0x1feef63f97d79b89u},
+    {0x83ca7da9352c4e5au, 0x198bf832dfdfafa1u},
+    {0x9ca1fe20f756a515u, 0x146ff9c24cb2f2e7u},
+    {0x4a1b31b3f9121daau, 0x1059949b708f28b9u},
+    {0x435eb5ecc1b695ddu, 0x1a28edc580e50df5u},
+    {0x35e55e57015ede4au, 0x14ed8b04671da4c4u},
+    {0xc4b77eac0118b1d5u, 0x10be08d0527e1d69u},
+    {0xa12597799b5ab622u, 0x1ac9a7b3b7302f0fu},
+    {0x4db7ac6149155e81u, 0x156e1fc2f8f358d9u},
+    {0xd7c6238107444b9bu, 0x1124e63593f5e0adu},
+    {0x593d059b3ed3ac2bu, 0x1b6e3d2286563449u},
+    {0xe0fd9e15cbdc89bcu, 0x15f1ca820511c36du},
+    {0xb3fe18116fe3a163u, 0x118e3b9b37416924u},
+    {0x866359b57fd29bd1u, 0x1c16c5c525357507u},
+    {0xd1e91491330ee30eu, 0x16789e3750f790d2u},
+    {0x74ba76da8f3f1c0bu, 0x11fa182c40c60d75u},
+    {0xedf72490e531c678u, 0x1cc359e067a348bbu},
+    {0x8b2c1d40b75b052du, 0x1702ae4d1fb5d3c9u},
+    {0x6f567dcd5f7c0424u, 0x12688b70e62b0fd4u},
+    {0x7ef0c94898c66d06u, 0x1d74124e3d11b2edu},
+    {0x98c0a106e09ebd9fu, 0x17900ea4fda7c257u},
+    {0x470080d24d4bcae6u, 0x12d9a550caec9b79u},
+    {0xd800ce1d487944a2u, 0x1e29088144adc58eu},
+    {0x1333d8176d2dd082u, 0x1820d39a9d57d13fu},
+    {0xa8f646792424a6ceu, 0x134d76154aaca765u},
+    {0x74bd3d8ea03aa47du, 0x1ee25688777aa56fu},
+    {0x5d64313ee6955064u, 0x18b51206c5fbb78cu},
+    {0x4ab68dcbebaaa6b7u, 0x13c40e6bd1962c70u},
+    {0x1124161312aaa457u, 0x1fa01712e8f0471au},
+    {0xda8344dc0eeee9dfu, 0x194cdf4253f36c14u},
+    {0xe2029d7cd8bf2180u, 0x143d7f6843292343u},
+    {0x4e687dfd7a328133u, 0x103132b9cf541c36u},
+    {0x4a40c9959050ceb8u, 0x19e851294bb9c6bdu},
+    {0x0833d477a6a70bc6u, 0x14b9da876fc7d231u},
+    {0xa02976c61eec096bu, 0x1094aed2bfd30e8du},
+    {0x004257a364acdbdfu, 0x1a877e1dffb81749u},
+    {0xcd01dfb5ea23e319u, 0x153931b1996012a0u},
+    {0x70ce4c91881cb5aeu, 0x10fa8e27ade6754du},
+    {0x1ae3adb5a69455e2u, 0x1b2a7d0c4970bbafu},
+    {0x7be957c4854377e8u, 0x15bb973d078d62f2u},
+    {0xc987796a0435f987u, 0x1162df64060ab58eu},
+    {0x75a58f1006bcc271u, 0x1bd1656cd67788e4u},
+    {0xf7b7a5a66bca3527u, 0x16411df0ab92d3e9u},
+    {0x5fc61e1ebca1c41fu, 0x11cdb18d560f0feeu},
+    {0xffa363646102d365u, 0x1c7c4f4889b1b316u},
+    {0x32e91c504d9bdc51u, 0x16c9d906d48e28dfu},
+    {0x8f20e37371497d0eu, 0x123b140576d820b2u},
+    {0x7e9b0585820f2e7cu, 0x1d2b533bf159cdeau},
+    {0xcbaf379e01a5becau, 0x1755dc2ff447d7eeu},
+    {0x0958f94b348498a1u, 0x12ab168cc36cacbfu},
+};
+
+static const uint64_t lept_ryu_pow5_split[326][2] = {
+    {0x0000000000000000u, 0x1000000000000000u},
+    {0x0000000000000000u, 0x1400000000000000u},
+    {0x0000000000000000u, 0x1900000000000000u},
+    {0x0000000000000000u, 0x1f40000000000000u},
+    {0x0000000000000000u, 0x1388000000000000u},
+    {0x0000000000000000u, 0x186a000000000000u},
+    {0x0000000000000000u, 0x1e84800000000000u},
+    {0x0000000000000000u, 0x1312d00000000000u},
+    {0x0000000000000000u, 0x17d7840000000000u},
+    {0x0000000000000000u, 0x1dcd650000000000u},
+    {0x0000000000000000u, 0x12a05f2000000000u},
+    {0x0000000000000000u, 0x174876e800000000u},
+    {0x0000000000000000u, 0x1d1a94a200000000u},
+    {0x0000000000000000u, 0x12309ce540000000u},
+    {0x0000000000000000u, 0x16bcc41e90000000u},
+    {0x0000000000000000u, 0x1c6bf52634000000u},
+    {0x0000000000000000u, 0x11c37937e0800000u},
+    {0x0000000000000000u, 0x16345785d8a00000u},
+    {0x0000000000000000u, 0x1bc16d674ec80000u},
+    {0x0000000000000000u, 0x1158e460913d0000u},
+    {0x0000000000000000u, 0x15af1d78b58c4000u},
+    {0x0000000000000000u, 0x1b1ae4d6e2ef5000u},
+    {0x0000000000000000u, 0x10f0cf064dd59200u},
+    {0x0000000000000000u, 0x152d02c7e14af680u},
+    {0x0000000000000000u, 0x1a784379d99db420u},
+    {0x0000000000000000u, 0x108b2a2c28029094u},
+    {0x0000000000000000u, 0x14adf4b7320334b9u},
+    {0x4000000000000000u, 0x19d971e4fe8401e7u},
+    {0x8800000000000000u, 0x1027e72f1f128130u},
+    {0xaa00000000000000u, 0x1431e0fae6d7217cu},
+    {0xd480000000000000u, 0x193e5939a08ce9dbu},
+    {0xc9a0000000000000u, 0x1f8def8808b02452u},
+    {0xbe04000000000000u, 0x13b8b5b5056e16b3u},
+    {0xad85000000000000u, 0x18a6e32246c99c60u},
+    {0xd8e6400000000000u, 0x1ed09bead87c0378u},
+    {0x878fe80000000000u, 0x13426172c74d822bu},
+    {0x6973e20000000000u, 0x1812f9cf7920e2b6u},
+    {0x03d0da8000000000u, 0x1e17b84357691b64u},
+    {0x8262889000000000u, 0x12ced32a16a1b11eu},
+    {0x22fb2ab400000000u, 0x178287f49c4a1d66u},
+    {0xabb9f56100000000u, 0x1d6329f1c35ca4bfu},
+    {0xcb54395ca0000000u, 0x125dfa371a19e6f7u},
+    {0xbe2947b3c8000000u, 0x16f578c4e0a060b5u},
+    {0x2db399a0ba000000u, 0x1cb2d6f618c878e3u},
+    {0xfc90400474400000u, 0x11efc659cf7d4b8du},
+    {0x7bb4500591500000u, 0x166bb7f0435c9e71u},
+    {0xdaa16406f5a40000u, 0x1c06a5ec5433c60du},
+    {0xa8a4de8459868000u, 0x118427b3b4a05bc8u},
+    {0xd2ce16256fe82000u, 0x15e531a0a1c872bau},
+    {0x87819baecbe22800u, 0x1b5e7e08ca3a8f69u},
+    {0xf4b1014d3f6d5900u, 0x111b0ec57e6499a1u},
+    {0x71dd41a08f48af40u, 0x1561d276ddfdc00au},
+    {0x0e549208b31adb10u, 0x1aba4714957d300du},
+    {0x28f4db456ff0c8eau, 0x10b46c6cdd6e3e08u},
+    {0x33321216cbecfb24u, 0x14e1878814c9cd8au},
+    {0xbffe969c7ee839edu, 0x1a19e96a19fc40ecu},
+    {0xf7ff1e21cf512434u, 0x105031e2503da893u},
+    {0xf5fee5aa43256d41u, 0x14643e5ae44d12b8u},
+    {0x337e9f14d3eec892u, 0x197d4df19d605767u},
+    {0x005e46da08ea7ab6u, 0x1fdca16e04b86d41u},
+    {0xa03aec4845928cb2u, 0x13e9e4e4c2f34448u},
+    {0xc849a75a56f72fdeu, 0x18e45e1df3b0155au},
+    {0x7a5c1130ecb4fbd6u, 0x1f1d75a5709c1ab1u},
+    {0xec798abe93f11d65u, 0x13726987666190aeu},
+    {0xa797ed6e38ed64bfu, 0x184f03e93ff9f4dau},
+    {0x517de8c9c728bdefu, 0x1e62c4e38ff87211u},
+    {0xd2eeb17e1c7976b5u, 0x12fdbb0e39fb474au},
+    {0x87aa5ddda397d462u, 0x17bd29d1c87a191du},
+    {0xe994f5550c7dc97bu, 0x1dac74463a989f64u},
+    {0x11fd195527ce9dedu, 0x128bc8abe49f639fu},
+    {0xd67c5faa71c24568u, 0x172ebad6ddc73c86u},
+    {0x8c1b77950e32d6c2u, 0x1cfa698c95390ba8u},
+    {0x57912abd28dfc639u, 0x121c81f7dd43a749u},
+    {0xad75756c7317b7c8u, 0x16a3a275d494911bu},
+    {0x98d2d2c78fdda5bau, 0x1c4c8b1349b9b562u},
+    {0x9f83c3bcb9ea8794u, 0x11afd6ec0e14115du},
+    {0x0764b4abe8652979u, 0x161bcca7119915b5u},
+    {0x493de1d6e27e73d7u, 0x1ba2bfd0d5ff5b22u},
+    {0x6dc6ad264d8f0866u, 0x1145b7e285bf98f5u},
+    {0xc938586fe0f2ca80u, 0x159725db272f7f32u},
+    {0x7b866e8bd92f7d20u, 0x1afcef51f0fb5effu},
+    {0xad34051767bdae34u, 0x10de1593369d1b5fu},
+    {0x9881065d41ad19c1u, 0x15159af804446237u},
+    {0x7ea147f492186032u, 0x1a5b01b605557ac5u},
+    {0x6f24ccf8db4f3c1fu, 0x1078e111c3556cbbu},
+    {0x4aee003712230b27u, 0x14971956342ac7eau},
+    {0xdda98044d6abcdf0u, 0x19bcdfabc13579e4u},
+    {0x0a89f02b062b60b6u, 0x10160bcb58c16c2fu},
+    {0xcd2c6c35c7b638e4u, 0x141b8ebe2ef1c73au},
+    {0x8077874339a3c71du, 0x1922726dbaae3909u},
+    {0xe0956914080cb8e4u, 0x1f6b0f092959c74bu},
+    {0x6c5d61ac8507f38eu, 0x13a2e965b9d81c8fu},
+    {0x4774ba17a649f072u, 0x188ba3bf284e23b3u},
+    {0x1951e89d8fdc6c8fu, 0x1eae8caef261aca0u},
+    {0x0fd3316279e9c3d9u, 0x132d17ed577d0be4u},
+    {0x13c7fdbb186434cfu, 0x17f85de8ad5c4eddu},
+    {0x58b9fd29de7d4203u, 0x1df67562d8b36294u},
+    {0xb7743e3a2b0e4942u, 0x12ba095dc7701d9cu},
+    {0xe5514dc8b5d1db92u, 0x17688bb5394c2503u},
+    {0xdea5a13ae3465277u, 0x1d42aea2879f2e44u},
+    {0x0b2784c4ce0bf38au, 0x1249ad2594c37cebu},
+    {0xcdf165f6018ef06du, 0x16dc186ef9f45c25u},
+    {0x416dbf7381f2ac88u, 0x1c931e8ab871732fu},
+    {0x88e497a83137abd5u, 0x11dbf316b346e7fdu},
+    {0xeb1dbd923d8596cau, 0x1652efdc6018a1fcu},
+    {0x25e52cf6cce6fc7du, 0x1be7abd3781eca7cu},
+    {0x97af3c1a40105dceu, 0x1170cb642b133e8du},
+    {0xfd9b0b20d0147542u, 0x15ccfe3d35d80e30u},
+    {0x3d01cde904199292u, 0x1b403dcc834e11bdu},
+    {0x462120b1a28ffb9bu, 0x1108269fd210cb16u},
+    {0xd7a968de0b33fa82u, 0x154a3047c694fddbu},
+    {0xcd93c3158e00f923u, 0x1a9cbc59b83a3d52u},
+    {0xc07c59ed78c09bb6u, 0x10a1f5b813246653u},
+    {0xb09b7068d6f0c2a3u, 0x14ca732617ed7fe8u},
+    {0xdcc24c830cacf34cu, 0x19fd0fef9de8dfe2u},
+    {0xc9f96fd1e7ec180fu, 0x103e29f5c2b18bedu},
+    {0x3c77cbc661e71e13u, 0x144db473335deee9u},
+    {0x8b95beb7fa60e598u, 0x1961219000356aa3u},
+    {0x6e7b2e65f8f91efeu, 0x1fb969f40042c54cu},
+    {0xc50cfcffbb9bb35fu, 0x13d3e2388029bb4fu},
+    {0xb6503c3faa82a037u, 0x18c8dac6a0342a23u},
+    {0xa3e44b4f95234844u, 0x1efb1178484134acu},
+    {0xe66eaf11bd360d2bu, 0x135ceaeb2d28c0ebu},
+    {0xe00a5ad62c839075u, 0x183425a5f872f126u},
+    {0x980cf18bb7a47493u, 0x1e412f0f768fad70u},
+    {0x5f0816f752c6c8dcu, 0x12e8bd69aa19cc66u},
+    {0xf6ca1cb527787b13u, 0x17a2ecc414a03f7fu},
+    {0xf47ca3e2715699d7u, 0x1d8ba7f519c84f5fu},
+    {0xf8cde66d86d62026u, 0x127748f9301d319bu},
+    {0xf7016008e88ba830u, 0x17151b377c247e02u},
+    {0xb4c1b80b22ae923cu, 0x1cda62055b2d9d83u},
+    {0x50f91306f5ad1b65u, 0x12087d4358fc8272u},
+    {0xe53757c8b318623fu, 0x168a9c942f3ba30eu},
+    {0x9e852dbadfde7acfu, 0x1c2d43b93b0a8bd2u},
+    {0xa3133c94cbeb0cc1u, 0x119c4a53c4e69763u},
+    {0x8bd80bb9fee5cff1u, 0x16035ce8b6203d3cu},
+    {0xaece0ea87e9f43eeu, 0x1b843422e3a84c8bu},
+    {0x4d40c9294f238a75u, 0x1132a095ce492fd7u},
+    {0x2090fb73a2ec6d12u, 0x157f48bb41db7bcdu},
+    {0x68b53a508ba78856u, 0x1adf1aea12525ac0u},
+    {0x417144725748b536u, 0x10cb70d24b7378b8u},
+    {0x51cd958eed1ae283u, 0x14fe4d06de5056e6u},
+    {0xe640faf2a8619b24u, 0x1a3de04895e46c9fu},
+    {0xefe89cd7a93d00f7u, 0x1066ac2d5daec3e3u},
+    {0xebe2c40d938c4134u, 0x14805738b51a74dcu},
+    {0x26db7510f86f5181u, 0x19a06d06e2611214u},
+    {0x9849292a9b4592f1u, 0x100444244d7cab4cu},
+    {0xbe5b73754216f7adu, 0x1405552d60dbd61fu},
+    {0xadf25052929cb598u, 0x1906aa78b912cba7u},
+    {0x996ee4673743e2ffu, 0x1f485516e7577e91u},
+    {0xffe54ec0828a6ddfu, 0x138d352e5096af1au},
+    {0xbfdea270a32d0957u, 0x18708279e4bc5ae1u},
+    {0x2fd64b0ccbf84badu, 0x1e8ca3185deb719au},
+    {0x5de5eee7ff7b2f4cu, 0x1317e5ef3ab32700u},
+    {0x755f6aa1ff59fb1fu, 0x17dddf6b095ff0c0u},
+    {0x92b7454a7f3079e7u, 0x1dd55745cbb7ecf0u},
+    {0x5bb28b4e8f7e4c30u, 0x12a5568b9f52f416u},
+    {0xf29f2e22335ddf3cu, 0x174eac2e8727b11bu},
+    {0xef46f9aac035570bu, 0x1d22573a28f19d62u},
+    {0xd58c5c0ab8215667u, 0x123576845997025du},
+    {0x4aef730d6629ac01u, 0x16c2d4256ffcc2f5u},
+    {0x9dab4fd0bfb41701u, 0x1c73892ecbfbf3b2u},
+    {0xa28b11e277d08e60u, 0x11c835bd3f7d784fu},
+    {0x8b2dd65b15c4b1f9u, 0x163a432c8f5cd663u},
+    {0x6df94bf1db35de77u, 0x1bc8d3f7b3340bfcu},
+    {0xc4bbcf772901ab0au, 0x115d847ad000877du},
+    {0x35eac354f34215cdu, 0x15b4e5998400a95du},
+    {0x8365742a30129b40u, 0x1b221effe500d3b4u},
+    {0xd21f689a5e0ba108u, 0x10f5535fef208450u},
+    {0x06a742c0f58e894au, 0x1532a837eae8a565u},
+    {0x4851137132f22b9du, 0x1a7f5245e5a2cebeu},
+    {0xed32ac26bfd75b42u, 0x108f936baf85c136u},
+    {0xa87f57306fcd3212u, 0x14b378469b673184u},
+    {0xd29f2cfc8bc07e97u, 0x19e056584240fde5u},
+    {0xa3a37c1dd7584f1eu, 0x102c35f729689eafu},
+    {0x8c8c5b254d2e62e6u, 0x14374374f3c2c65bu},
+    {0x6faf71eea079fb9fu, 0x1945145230b377f2u},
+    {0x0b9b4e6a48987a87u, 0x1f965966bce055efu},
+    {0x674111026d5f4c94u, 0x13bdf7e0360c35b5u},
+    {0xc111554308b71fbau, 0x18ad75d8438f4322u},
+    {0x7155aa93cae4e7a8u, 0x1ed8d34e547313ebu},
+    {0x26d58a9c5ecf10c9u, 0x13478410f4c7ec73u},
+    {0xf08aed437682d4fbu, 0x1819651531f9e78fu},
+    {0xecada89454238a3au, 0x1e1fbe5a7e786173u},
+    {0x73ec895cb4963664u, 0x12d3d6f88f0b3ce8u},
+    {0x90e7abb3e1bbc3fdu, 0x1788ccb6b2ce0c22u},
+    {0x352196a0da2ab4fdu, 0x1d6affe45f818f2bu},
+    {0x0134fe24885ab11eu, 0x1262dfeebbb0f97bu},
+    {0xc1823dadaa715d65u, 0x16fb97ea6a9d37d9u},
+    {0x31e2cd19150db4bfu, 0x1cba7de5054485d0u},
+    {0x1f2dc02fad2890f7u, 0x11f48eaf234ad3a2u},
+    {0xa6f9303b9872b535u, 0x1671b25aec1d888au},
+    {0x50b77c4a7e8f6282u, 0x1c0e1ef1a724eaadu},
+    {0x5272adae8f199d91u, 0x1188d357087712acu},
+    {0x670f591a32e004f6u, 0x15eb082cca94d757u},
+    {0x40d32f60bf980633u, 0x1b65ca37fd3a0d2du},
+    {0x4883fd9c77bf03e0u, 0x111f9e62fe44483cu},
+    {0x5aa4fd0395aec4d8u, 0x156785fbbdd55a4bu},
+    {0x314e3c447b1a760eu, 0x1ac1677aad4ab0deu},
+    {0xded0e5aaccf089c9u, 0x10b8e0acac4eae8au},
+    {0x96851f15802cac3bu, 0x14e718d7d7625a2du},
+    {0xfc2666dae037d74au, 0x1a20df0dcd3af0b8u},
+    {0x9d980048cc22e68eu, 0x10548b68a044d673u},
+    {0x84fe005aff2ba032u, 0x1469ae42c8560c10u},
+    {0xa63d8071bef6883eu, 0x198419d37a6b8f14u},
+    {0xcfcce08e2eb42a4eu, 0x1fe52048590672d9u},
+    {0x21e00c58dd309a70u, 0x13ef342d37a407c8u},
+    {0x2a580f6f147cc10du, 0x18eb0138858d09bau},
+    {0xb4ee134ad99bf150u, 0x1f25c186a6f04c28u},
+    {0x7114cc0ec80176d2u, 0x137798f428562f99u},
+    {0xcd59ff127a01d486u, 0x18557f31326bbb7fu},
+    {0xc0b07ed7188249a8u, 0x1e6adefd7f06aa5fu},
+    {0xd86e4f466f516e09u, 0x1302cb5e6f642a7bu},
+    {0xce89e3180b25c98bu, 0x17c37e360b3d351au},
+    {0x822c5bde0def3beeu, 0x1db45dc38e0c8261u},
+    {0xf15bb96ac8b58575u, 0x1290ba9a38c7d17cu},
+    {0x2db2a7c57ae2e6d2u, 0x1734e940c6f9c5dcu},
+    {0x391f51b6d99ba086u, 0x1d022390f8b83753u},
+    {0x03b3931248014454u, 0x1221563a9b732294u},
+    {0x04a077d6da019569u, 0x16a9abc9424feb39u},
+    {0x45c895cc9081fac3u, 0x1c5416bb92e3e607u},
+    {0x8b9d5d9fda513cbau, 0x11b48e353bce6fc4u},
+    {0xae84b507d0e58be8u, 0x1621b1c28ac20bb5u},
+    {0x1a25e249c51eeee3u, 0x1baa1e332d728ea3u},
+    {0xf057ad6e1b33554du, 0x114a52dffc679925u},
+    {0x6c6d98c9a2002aa1u, 0x159ce797fb817f6fu},
+    {0x4788fefc0a803549u, 0x1b04217dfa61df4bu},
+    {0x0cb59f5d8690214eu, 0x10e294eebc7d2b8fu},
+    {0xcfe30734e83429a1u, 0x151b3a2a6b9c7672u},
+    {0x83dbc9022241340au, 0x1a6208b50683940fu},
+    {0xb2695da15568c086u, 0x107d457124123c89u},
+    {0x1f03b509aac2f0a7u, 0x149c96cd6d16cbacu},
+    {0x26c4a24c1573acd1u, 0x19c3bc80c85c7e97u},
+    {0x783ae56f8d684c03u, 0x101a55d07d39cf1eu},
+    {0x16499ecb70c25f03u, 0x1420eb449c8842e6u},
+    {0x9bdc067e4cf2f6c4u, 0x19292615c3aa539fu},
+    {0x82d3081de02fb476u, 0x1f736f9b3494e887u},
+    {0xb1c3e512ac1dd0c9u, 0x13a825c100dd1154u},
+    {0xde34de57572544fcu, 0x18922f31411455a9u},
+    {0x55c215ed2cee963bu, 0x1eb6bafd91596b14u},
+    {0xb5994db43c151de5u, 0x133234de7ad7e2ecu},
+    {0xe2ffa1214b1a655eu, 0x17fec216198ddba7u},
+    {0xdbbf89699de0feb6u, 0x1dfe729b9ff15291u},
+    {0x2957b5e202ac9f31u, 0x12bf07a143f6d39bu},
+    {0xf3ada35a8357c6feu, 0x176ec98994f48881u},
+    {0x70990c31242db8bdu, 0x1d4a7bebfa31aaa2u},
+    {0x865fa79eb69c9376u, 0x124e8d737c5f0aa5u},
+    {0xe7f791866443b854u, 0x16e230d05b76cd4eu},
+    {0xa1f575e7fd54a669u, 0x1c9abd04725480a2u},
+    {0xa53969b0fe54e801u, 0x11e0b622c774d065u},
+    {0x0e87c41d3dea2202u, 0x1658e3ab7952047fu},
+    {0xd229b5248d64aa82u, 0x1bef1c9657a6859eu},
+    {0x435a1136d85eea91u, 0x117571ddf6c81383u},
+    {0x143095848e76a536u, 0x15d2ce55747a1864u},
+    {0x193cbae5b2144e83u, 0x1b4781ead1989e7du},
+    {0x2fc5f4cf8f4cb112u, 0x110cb132c2ff630eu},
+    {0xbbb77203731fdd56u, 0x154fdd7f73bf3bd1u},
+    {0x2aa54e844fe7d4acu, 0x1aa3d4df50af0ac6u},
+    {0xdaa75112b1f0e4ebu, 0x10a6650b926d66bbu},
+    {0xd15125575e6d1e26u, 0x14cffe4e7708c06au},
+    {0x85a56ead360865b0u, 0x1a03fde214caf085u},
+    {0x7387652c41c53f8eu, 0x10427ead4cfed653u},
+    {0x50693e7752368f71u, 0x14531e58a03e8be8u},
+    {0x64838e1526c4334eu, 0x1967e5eec84e2ee2u},
+    {0xfda4719a70754022u, 0x1fc1df6a7a61ba9au},
+    {0xde86c70086494815u, 0x13d92ba28c7d14a0u},
+    {0x162878c0a7db9a1au, 0x18cf768b2f9c59c9u},
+    {0x5bb296f0d1d280a1u, 0x1f03542dfb83703bu},
+    {0x194f9e5683239064u, 0x1362149cbd322625u},
+    {0x5fa385ec23ec747eu, 0x183a99c3ec7eafaeu},
+    {0xf78c67672ce7919du, 0x1e494034e79e5b99u},
+    {0x3ab7c0a07c10bb02u, 0x12edc82110c2f940u},
+    {0x4965b0c89b14e9c3u, 0x17a93a2954f3b790u},
+    {0x5bbf1cfac1da2433u, 0x1d9388b3aa30a574u},
+    {0xb957721cb92856a0u, 0x127c35704a5e6768u},
+    {0xe7ad4ea3e7726c48u, 0x171b42cc5cf60142u},
+    {0xa198a24ce14f075au, 0x1ce2137f74338193u},
+    {0x44ff65700cd16498u, 0x120d4c2fa8a030fcu},
+    {0x563f3ecc1005bdbeu, 0x16909f3b92c83d3bu},
+    {0x2bcf0e7f14072d2eu, 0x1c34c70a777a4c8au},
+    {0x5b61690f6c847c3du, 0x11a0fc668aac6fd6u},
+    {0xf239c35347a59b4cu, 0x16093b802d578bcbu},
+    {0xeec83428198f021fu, 0x1b8b8a6038ad6ebeu},
+    {0x553d20990ff96153u, 0x1137367c236c6537u},
+    {0x2a8c68bf53f7b9a8u, 0x1585041b2c477e85u},
+    {0x752f82ef28f5a812u, 0x1ae64521f7595e26u},
+    {0x093db1d57999890bu, 0x10cfeb353a97dad8u},
+    {0x0b8d1e4ad7ffeb4eu, 0x1503e602893dd18eu},
+    {0x8e7065dd8dffe622u, 0x1a44df832b8d45f1u},
+    {0xf9063faa78bfefd5u, 0x106b0bb1fb384bb6u},
+    {0xb747cf9516efebcau, 0x1485ce9e7a065ea4u},
+    {0xe519c37a5cabe6bdu, 0x19a742461887f64du},
+    {0xaf301a2c79eb7036u, 0x1008896bcf54f9f0u},
+    {0xdafc20b798664c43u, 0x140aabc6c32a386cu},
+    {0x11bb28e57e7fdf54u, 0x190d56b873f4c688u},
+    {0x1629f31ede1fd72au, 0x1f50ac6690f1f82au},
+    {0x4dda37f34ad3e67au, 0x13926bc01a973b1au},
+    {0xe150c5f01d88e019u, 0x187706b0213d09e0u},
+    {0x19a4f76c24eb181fu, 0x1e94c85c298c4c59u},
+    {0xb0071aa39712ef13u, 0x131cfd3999f7afb7u},
+    {0x9c08e14c7cd7aad8u, 0x17e43c8800759ba5u},
+    {0x030b199f9c0d958eu, 0x1ddd4baa0093028fu},
+    {0x61e6f003c1887d79u, 0x12aa4f4a405be199u},
+    {0xba60ac04b1ea9cd7u, 0x1754e31cd072d9ffu},
+    {0xa8f8d705de65440du, 0x1d2a1be4048f907fu},
+    {0xc99b8663aaff4a88u, 0x123a516e82d9ba4fu},
+    {0xbc0267fc95bf1d2au, 0x16c8e5ca239028e3u},
+    {0xab0301fbbb2ee474u, 0x1c7b1f3cac74331cu},
+    {0xeae1e13d54fd4ec9u, 0x11ccf385ebc89ff1u},
+    {0x659a598caa3ca27bu, 0x1640306766bac7eeu},
+    {0xff00efefd4cbcb1au, 0x1bd03c81406979e9u},
+    {0x3f6095f5e4ff5ef0u, 0x116225d0c841ec32u},
+    {0xcf38bb735e3f36acu, 0x15baaf44fa52673eu},
+    {0x8306ea5035cf0457u, 0x1b295b1638e7010eu},
+    {0x11e4527221a162b6u, 0x10f9d8ede39060a9u},
+    {0x565d670eaa09bb64u, 0x15384f295c7478d3u},
+    {0x2bf4c0d2548c2a3du, 0x1a8662f3b3919708u},
+    {0x1b78f88374d79a66u, 0x1093fdd8503afe65u},
+    {0x625736a4520d8100u, 0x14b8fd4e6449bdfeu},
+    {0xfaed044d6690e140u, 0x19e73ca1fd5c2d7du},
+    {0xbcd422b0601a8cc8u, 0x103085e53e599c6eu},
+    {0x6c092b5c78212ffau, 0x143ca75e8df0038au},
+    {0x070b763396297bf8u, 0x194bd136316c046du},
+    {0x48ce53c07bb3daf6u, 0x1f9ec583bdc70588u},
+    {0x2d80f4584d5068dau, 0x13c33b72569c6375u},
+    {0x78e1316e60a48310u, 0x18b40a4eec437c52u},
+};
+
+static uint64_t lept_ryu_mul_shift(uint64_t m, const uint64_t *mul, int j) {
+
+    //(m * mul) >> j, mul 是 128 位, j >= 64
+    uint64_t hi0, lo0, hi1, lo1, lo, hi;
+    int dist = j - 64;
+    lept_mul128(m, mul[0], &hi0, &lo0);
+    lept_mul128(m, mul[1], &hi1, &lo1);
+    lo = lo1 + hi0;
+    hi = hi1 + (lo < lo1);
+    assert(dist > 0 && dist < 64);
+    return (hi << (64 - dist)) | (lo >> dist);
+}
+
+static unsigned lept_ryu_pow5_factor(uint64_t v) {
+
+    unsigned count = 0;
+    while (v % 5 == 0) {
+        v /= 5;
+        count++;
+    }
+    return count;
+}
+
+/* 把有限的正数 (bits 不含符号位) 转换为最短的 output * 10^exp */
+static void lept_ryu(uint64_t bits, uint64_t *output, int *exp) {
+
+    const uint64_t ieee_mantissa = bits & (((uint64_t) 1 << 52) - 1);
+    const int ieee_exponent = (int) (bits >> 52);
+    int e2, e10, removed = 0;
+    uint64_t m2, mv, vr, vp, vm;
+    unsigned mm_shift, last_removed_digit = 0;
+    int even, vm_trailing_zeros = 0, vr_trailing_zeros = 0;
+
+    if (ieee_exponent == 0) {
+        e2 = 1 - 1023 - 52 - 2;
+        m2 = ieee_mantissa;
+    } else {
+        e2 = ieee_exponent - 1023 - 52 - 2;
+        m2 = ((uint64_t) 1 << 52) | ieee_mantissa;
+    }
+    even = (m2 & 1) == 0;
+
+    //合法的十进制表示的区间是 (mm, mp) * 2^e2, 偶数尾数时包含两端
+    mv = 4 * m2;
+    mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+    if (e2 >= 0) {
+        //floor(log10(2^e2)), 再减 1 是为了保证 vp 和 vm 至少有一位可以去掉
+        const int q = ((e2 * 78913) >> 18) - (e2 > 3);
+        const int k = 125 + (((q * 1217359) >> 19) + 1) - 1;
+        const int i = -e2 + q + k;
+        e10 = q;
+        vr = lept_ryu_mul_shift(4 * m2, lept_ryu_pow5_inv_split[q], i);
+        vp = lept_ryu_mul_shift(4 * m2 + 2, lept_ryu_pow5_inv_split[q], i);
+        vm = lept_ryu_mul_shift(4 * m2 - 1 - mm_shift, lept_ryu_pow5_inv_split[q], i);
+        if (q <= 21) {
+            //mp, mv, mm 中最多只有一个是 5 的倍数
+            if (mv % 5 == 0)
+                vr_trailing_zeros = lept_ryu_pow5_factor(mv) >= (unsigned) q;
+            else if (even)
+                vm_trailing_zeros = lept_ryu_pow5_factor(mv - 1 - mm_shift) >= (unsigned) q;
+            else
+                vp -= lept_ryu_pow5_factor(mv + 2) >= (unsigned) q;
+        }
+    } else {
+        const int q = ((-e2 * 732923) >> 20) - (-e2 > 1);
+        const int i = -e2 - q;
+        const int k = (((i * 1217359) >> 19) + 1) - 125;
+        const int j = q - k;
+        e10 = q + e2;
+        vr = lept_ryu_mul_shift(4 * m2, lept_ryu_pow5_split[i], j);
+        vp = lept_ryu_mul_shift(4 * m2 + 2, lept_ryu_pow5_split[i], j);
+        vm = lept_ryu_mul_shift(4 * m2 - 1 - mm_shift, lept_ryu_pow5_split[i], j);
+        if (q <= 1) {
+            //mv = 4 * m2 至少有两个结尾的 0 位
+            vr_trailing_zeros = 1;
+            if (even)
+                vm_trailing_zeros = mm_shift == 1;
+            else
+                --vp;
+        } else if (q < 63) {
+            vr_trailing_zeros = (mv & (((uint64_t) 1 << q) - 1)) == 0;
+        }
+    }
+
+    //去掉尽可能多的低位, 直到 vp 和 vm 不能再区分
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        //少见的情况 (~0.7%): 需要精确地处理正好一半和区间的端点
+        while (vp / 10 > vm / 10) {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed_digit == 0;
+            last_removed_digit = (unsigned) (vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vm_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= last_removed_digit == 0;
+                last_removed_digit = (unsigned) (vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        if (vr_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0)
+            last_removed_digit = 4; //正好是 ...50..0 时向偶数舍入
+        *output = vr + ((vr == vm && (!even || !vm_trailing_zeros)) || last_removed_digit >= 5);
+    } else {
+        int round_up = 0;
+        if (vp / 100 > vm / 100) {
+            //一次去掉两位
+            round_up = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        while (vp / 10 > vm / 10) {
+            round_up = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        *output = vr + (vr == vm || round_up);
+    }
+    *exp = e10 + removed;
+}
+
+/* 按照 %g 的规则 (精度 17) 输出: 十进制指数在 [-4, 17) 之间用小数形式, 否则用科学计数法 */
+static int lept_format_number(char *buffer, double d) {
+
+    char digits[20];
+    char *p = buffer;
+    uint64_t bits, output;
+    int exp, n = 0, point, i;
+
+    if (d != d || d - d != 0)
+        return sprintf(buffer, "%.17g", d); //inf 和 nan 不是合法的 JSON, 保持原来的输出
+    memcpy(&bits, &d, sizeof(d));
+    if (bits >> 63) {
+        *p++ = '-';
+        bits &= ~((uint64_t) 1 << 63);
+        d = -d;
+    }
+    if (bits == 0) {
+        *p++ = '0';
+        return (int) (p - buffer);
+    }
+    if (d < 9007199254740992.0 && d == (double) (uint64_t) d) {
+        //整数: 2^53 以内的整数最多 16 位, 不会用到科学计数法
+        output = (uint64_t) d;
+        exp = 0;
+    } else {
+        lept_ryu(bits, &output, &exp);
+    }
+    for (; output; output /= 10)
+        digits[n++] = (char) ('0' + output % 10); //低位在前
+    point = exp + n; //小数点在第 point 位数字之后
+    //忽略结尾的 0
+    for (i = 0; digits[i] == '0'; i++)
+        ;
+
+    if (point - 1 >= -4 && point - 1 < 17) {
+        if (point <= 0) {
+            *p++ = '0';
+            *p++ = '.';
+            for (; point < 0; point++)
+                *p++ = '0';
+            while (n > i)
+                *p++ = digits[--n];
+        } else {
+            for (; n > i; point--) {
+                if (point == 0)
+                    *p++ = '.';
+                *p++ = digits[--n];
+            }
+            for (; point > 0; point--)
+                *p++ = '0';
+        }
+    } else {
+        int e = point - 1;
+        *p++ = digits[--n];
+        if (n > i) {
+            *p++ = '.';
+            while (n > i)
+                *p++ = digits[--n];
+        }
+        *p++ = 'e';
+        *p++ = e < 0 ? '-' : '+';
+        if (e < 0)
+            e = -e;
+        if (e >= 100)
+            *p++ = (char) ('0' + e / 100);
+        *p++ = (char) ('0' + e / 10 % 10);
+        *p++ = (char) ('0' + e % 10);
+    }
+    return (int) (p - buffer);
+}
+
+
+/* 流式输出: 缓冲区超过 LEPT_STRINGIFY_BUFFER_SIZE 时整块交给 write
+ * 每次 push 最多 LEPT_STRINGIFY_PIECE * 6 + 2 字节, 所以缓冲区的大小是有上限的
+ */
+#define LEPT_STRINGIFY_PIECE 1024 //长字符串分段转义
+
+static int lept_stringify_flush(lept_context *c) {
+
+    if (c->top && c->write(c->user, c->stack, c->top) != 0)
+        return LEPT_STRINGIFY_WRITE_ERROR;
+    LEPT_STAT(lept_stats_current.bytes += c->top);
+    c->top = 0;
+    return LEPT_STRINGIFY_OK;
+}
+
+#define STRINGIFY_FLUSH(c) \
+    do { \
+        if ((c)->write && (c)->top >= LEPT_STRINGIFY_BUFFER_SIZE && lept_stringify_flush(c) != LEPT_STRINGIFY_OK) \
+            return LEPT_STRINGIFY_WRITE_ERROR; \
+    } while(0)
+
+/* 把 s 转义后写到 p, p 至少要有 len * 6 字节; 返回写入之后的位置 */
+/* 不需要转义的一段用 lept_scan_string (和解析时找字符串结尾是同一组字节) 找出来整块拷贝, 只有需要转义的字节才逐个处理 */
+static char *lept_escape_string(char *p, const char *s, size_t len) {
+
+    static const char hex_digits[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
+    const char *end = s + len;
+    for (;;) {
+        const char *q = lept_scan_string(s, end);
+        memcpy(p, s, q - s);
+        p += q - s;
+        if (q == end)
+            return p;
+        s = q + 1;
+        unsigned char ch = (unsigned char) *q;
+        *p++ = '\\';
+        switch (ch) {
+            case '\"':
+                *p++ = '"';
+                break;
             case '\\':
-                *p++ = '\\';
                 *p++ = '\\';
                 break;
             case '\b':
-                *p++ = '\\';
                 *p++ = 'b';
                 break;
             case '\f':
-                *p++ = '\\';
                 *p++ = 'f';
                 break;
             case '\n':
-                *p++ = '\\';
                 *p++ = 'n';
                 break;
             case '\r':
-                *p++ = '\\';
                 *p++ = 'r';
                 break;
             case '\t':
-                *p++ = '\\';
                 *p++ = 't';
                 break;
             default:
-                //处理非法 非转义字符 => 转成 0x00XX的形式
-                if (ch < 0x20) {
-                    *p++ = '\\';
-                    *p++ = 'u';
-                    *p++ = '0';
-                    *p++ = '0';
-                    *p++ = hex_digits[ch >> 4];
-                    *p++ = hex_digits[ch & 15];
-                } else
-                    //合法的非转义字符
-                    *p++ = s[i];
+                //其余的控制字符 => 转成 \u00XX 的形式
+                *p++ = 'u';
+                *p++ = '0';
+                *p++ = '0';
+                *p++ = hex_digits[ch >> 4];
+                *p++ = hex_digits[ch & 15];
         }
     }
-    *p++ = '"';
-    c->top -= size - (p - head);
+}
+
+/* 转义之后的长度, 和 lept_escape_string 写入的字节数一致 */
+static size_t lept_escape_length(const char *s, size_t len) {
+
+    const char *end = s + len;
+    size_t n = len;
+    while ((s = lept_scan_string(s, end)) != end) {
+        unsigned char ch = (unsigned char) *s++;
+        if (ch == '"' || ch == '\\' || ch == '\b' || ch == '\f' || ch == '\n' || ch == '\r' || ch == '\t')
+            n += 1;
+        else
+            n += 5;
+    }
+    return n;
+}
+
+static int lept_stringify_string(lept_context *c, const char *s, size_t len) {
+
+    assert(s != NULL);
+    size_t size, i = 0;
+    char *head;
+
+    PUTC(c, '"');
+    while (i < len) {
+        size_t n = len - i < LEPT_STRINGIFY_PIECE ? len : i + LEPT_STRINGIFY_PIECE;
+        STRINGIFY_FLUSH(c);
+        size = (n - i) * 6; //这一段转换之后的最大长度
+        head = lept_context_push(c, size);
+        LEPT_STAT_TIME(string_cycles, c->top -= size - (lept_escape_string(head, s + i, n - i) - head));
+        i = n;
+    }
+    PUTC(c, '"');
+    return LEPT_STRINGIFY_OK;
 }
 
 static int lept_stringify_value(lept_context *c, const lept_value *v) {
 
     int ret;
+    STRINGIFY_FLUSH(c);
+    LEPT_LAZY_EXPAND(v);
+    LEPT_STAT(lept_stats_current.nodes[v->type]++);
     switch (v->type) {
         case LEPT_NULL:
             PUTS(c, "null", 4);
@@ -662,59 +4953,681 @@ static int lept_stringify_value(lept_context *c, const lept_value *v) {
         case LEPT_NUMBER: {
             //先分配32bytes的空间，写入转为字符串的数字，回收多余的空间
             char *buffer = lept_context_push(c, 32);
-            int length = sprintf(buffer, "%.17g", v->u.n);
+            int length;
+            LEPT_STAT_TIME(number_cycles, length = lept_format_number(buffer, v->u.n));
             c->top -= 32 - length;
         }
             break;
         case LEPT_STRING:
-            lept_stringify_string(c, v->u.s.s, v->u.s.len);
-            break;
+            return lept_stringify_string(c, LEPT_STRING(v), LEPT_STRING_LENGTH(v));
         case LEPT_ARRAY:
+            LEPT_STAT_ENTER(); //出错时整个 stringify 都停止, 不需要配对的 LEPT_STAT_LEAVE
             PUTC(c, '[');
-            for (size_t i = 0; i < v->u.a.size; i++) {
+            for (size_t i = 0; i < v->size; i++) {
                 if (i > 0)
                     PUTC(c, ',');
-                lept_stringify_value(c, &v->u.a.e[i]);
+                if ((ret = lept_stringify_value(c, &v->u.e[i])) != LEPT_STRINGIFY_OK)
+                    return ret;
             }
             PUTC(c, ']');
+            LEPT_STAT_LEAVE();
             break;
         case LEPT_OBJECT:
+            LEPT_STAT_ENTER();
             PUTC(c, '{');
-            for (size_t i = 0; i < v->u.o.size; i++) {
+            for (size_t i = 0; i < v->size; i++) {
                 if (i > 0)
                     PUTC(c, ',');
-                lept_stringify_string(c, v->u.o.m[i].k, v->u.o.m[i].klen);
+                if ((ret = lept_stringify_string(c, LEPT_STRING(&v->u.m[i].k), LEPT_STRING_LENGTH(&v->u.m[i].k))) != LEPT_STRINGIFY_OK)
+                    return ret;
                 PUTC(c, ':');
-                lept_stringify_value(c, &v->u.o.m[i].v);
+                if ((ret = lept_stringify_value(c, &v->u.m[i].v)) != LEPT_STRINGIFY_OK)
+                    return ret;
             }
             PUTC(c, '}');
+            LEPT_STAT_LEAVE();
             break;
     }
+    STRINGIFY_FLUSH(c); //深层嵌套的结尾括号
     return LEPT_STRINGIFY_OK;
 }
 
 int lept_stringify(const lept_value *v, char **json, size_t *length) {
 
+    return lept_stringify_with(v, json, length, NULL);
+}
+
+int lept_stringify_with(const lept_value *v, char **json, size_t *length, const lept_allocator *a) {
+
     lept_context c;
     int ret;
     assert(v != NULL);
     assert(json != NULL);
+#ifdef LEPT_STATS
+    uint64_t t0 = lept_cycles();
+    lept_stats_reset();
+    lept_stats_current.mallocs = 1;
+    lept_stats_current.malloc_bytes = LEPT_PARSE_STRINGIFY_INIT_SIZE;
+#endif
     lept_context_init(&c);
-    c.stack = malloc(c.size = LEPT_PARSE_STRINGIFY_INIT_SIZE);
+    c.alloc = a;
+    c.stack = lept_mem_alloc(a, c.size = LEPT_PARSE_STRINGIFY_INIT_SIZE);
 
     ret = lept_stringify_value(&c, v);
     if (ret != LEPT_STRINGIFY_OK) {
-        free(c.stack);
+        lept_mem_free(c.alloc, c.stack);
         *json = NULL;
         return ret;
     }
 
+    LEPT_STAT(lept_stats_current.bytes = c.top; lept_stats_current.cycles = lept_cycles() - t0);
     if (length) *length = c.top;
     PUTC(&c, '\0');
     *json = c.stack;
     return LEPT_STRINGIFY_OK;
 }
 
+/* 精确长度: 先算出输出的长度, 再直接写入调用者的缓冲区, 不经过 lept_context 也不分配内存 */
+size_t lept_stringify_length(const lept_value *v) {
+
+    char buffer[32];
+    size_t n, i;
+    assert(v != NULL);
+    LEPT_LAZY_EXPAND(v);
+    switch (v->type) {
+        case LEPT_NULL:
+        case LEPT_TRUE:
+            return 4;
+        case LEPT_FALSE:
+            return 5;
+        case LEPT_NUMBER:
+            return (size_t) lept_format_number(buffer, v->u.n);
+        case LEPT_STRING:
+            return lept_escape_length(LEPT_STRING(v), LEPT_STRING_LENGTH(v)) + 2;
+        case LEPT_ARRAY:
+            n = v->size ? v->size + 1 : 2; //括号和逗号
+            for (i = 0; i < v->size; i++)
+                n += lept_stringify_length(&v->u.e[i]);
+            return n;
+        case LEPT_OBJECT:
+            n = v->size ? 2 * v->size + 1 : 2; //括号, 逗号和冒号
+            for (i = 0; i < v->size; i++)
+                n += lept_stringify_length(&v->u.m[i].k) + lept_stringify_length(&v->u.m[i].v);
+            return n;
+    }
+    return 0;
+}
+
+static char *lept_stringify_direct(char *p, const lept_value *v) {
+
+    char buffer[32];
+    size_t i;
+    int length;
+    LEPT_LAZY_EXPAND(v);
+    switch (v->type) {
+        case LEPT_NULL:
+            memcpy(p, "null", 4);
+            return p + 4;
+        case LEPT_TRUE:
+            memcpy(p, "true", 4);
+            return p + 4;
+        case LEPT_FALSE:
+            memcpy(p, "false", 5);
+            return p + 5;
+        case LEPT_NUMBER:
+            //缓冲区的结尾可能不足 32 字节
+            length = lept_format_number(buffer, v->u.n);
+            memcpy(p, buffer, length);
+            return p + length;
+        case LEPT_STRING:
+            *p++ = '"';
+            p = lept_escape_string(p, LEPT_STRING(v), LEPT_STRING_LENGTH(v));
+            *p++ = '"';
+            return p;
+        case LEPT_ARRAY:
+            *p++ = '[';
+            for (i = 0; i < v->size; i++) {
+                if (i > 0)
+                    *p++ = ',';
+                p = lept_stringify_direct(p, &v->u.e[i]);
+            }
+            *p++ = ']';
+            return p;
+        case LEPT_OBJECT:
+            *p++ = '{';
+            for (i = 0; i < v->size; i++) {
+                if (i > 0)
+                    *p++ = ',';
+                *p++ = '"';
+                p = lept_escape_string(p, LEPT_STRING(&v->u.m[i].k), LEPT_STRING_LENGTH(&v->u.m[i].k));
+                *p++ = '"';
+                *p++ = ':';
+                p = lept_stringify_direct(p, &v->u.m[i].v);
+            }
+            *p++ = '}';
+            return p;
+    }
+    return p;
+}
+
+int lept_stringify_buffer(const lept_value *v, char *buf, size_t size, size_t *length) {
+
+    size_t n = lept_stringify_length(v);
+    assert(buf != NULL || size == 0);
+    if (length) *length = n;
+    if (n > size)
+        return LEPT_STRINGIFY_BUFFER_TOO_SMALL;
+    char *end = lept_stringify_direct(buf, v);
+    assert(end == buf + n);
+    (void) end;
+    return LEPT_STRINGIFY_OK;
+}
+
+int lept_stringify_to(const lept_value *v, lept_write_func write, void *user) {
+
+    return lept_stringify_to_with(v, write, user, NULL);
+}
+
+int lept_stringify_to_with(const lept_value *v, lept_write_func write, void *user, const lept_allocator *a) {
+
+    lept_context c;
+    int ret;
+    assert(v != NULL && write != NULL);
+#ifdef LEPT_STATS
+    uint64_t t0 = lept_cycles();
+    lept_stats_reset();
+    lept_stats_current.mallocs = 1;
+    lept_stats_current.malloc_bytes = LEPT_STRINGIFY_BUFFER_SIZE + LEPT_STRINGIFY_PIECE * 6 + 64;
+#endif
+    lept_context_init(&c);
+    c.alloc = a;
+    //预留最大的一次 push, 缓冲区不会再 realloc
+    c.stack = lept_mem_alloc(a, c.size = LEPT_STRINGIFY_BUFFER_SIZE + LEPT_STRINGIFY_PIECE * 6 + 64);
+    c.write = write;
+    c.user = user;
+
+    if ((ret = lept_stringify_value(&c, v)) == LEPT_STRINGIFY_OK)
+        ret = lept_stringify_flush(&c);
+    LEPT_STAT(lept_stats_current.cycles = lept_cycles() - t0);
+    lept_mem_free(c.alloc, c.stack);
+    return ret;
+}
+
+struct lept_workspace {
+    char *stack;
+    size_t size;
+    size_t initial_size;
+    size_t shrink_size;
+};
+
+lept_workspace *lept_workspace_new(size_t initial_size, size_t shrink_size) {
+
+    lept_workspace *w = (lept_workspace *) malloc(sizeof(lept_workspace));
+    w->initial_size = initial_size ? initial_size : LEPT_PARSE_STACK_INIT_SIZE;
+    w->shrink_size = shrink_size;
+    w->stack = (char *) malloc(w->size = w->initial_size);
+    return w;
+}
+
+void lept_workspace_free(lept_workspace *w) {
+
+    if (w == NULL)
+        return;
+    free(w->stack);
+    free(w);
+}
+
+/* 把工作区的栈借给已经初始化的 c; 上一次调用留下的大栈在这里收缩, 这样 stringify 的结果在下一次调用之前一直有效 */
+static void lept_workspace_enter(lept_workspace *w, lept_context *c) {
+
+    if (w->shrink_size && w->size > w->shrink_size) {
+        free(w->stack);
+        w->stack = (char *) malloc(w->size = w->initial_size);
+    }
+    c->stack = w->stack;
+    c->size = w->size;
+}
+
+/* 栈可能在调用中被 realloc 过 */
+static void lept_workspace_leave(lept_workspace *w, const lept_context *c) {
+
+    w->stack = c->stack;
+    w->size = c->size;
+}
+
+int lept_workspace_parse(lept_workspace *w, lept_value *v, const char *json, size_t len) {
+
+    lept_context c;
+    assert(w != NULL && v != NULL && (json != NULL || len == 0));
+
+    lept_context_init(&c);
+    lept_workspace_enter(w, &c);
+    c.json = json;
+    c.end = json + len;
+    int ret = lept_parse_root(&c, v);
+    lept_workspace_leave(w, &c);
+
+    return ret;
+}
+
+int lept_workspace_parse_document(lept_workspace *w, lept_document *d, const char *json, size_t len) {
+
+    lept_context c;
+    assert(w != NULL && d != NULL && (json != NULL || len == 0));
+
+    lept_document_context(d, &c, json, len);
+    c.alloc = NULL; //arena 仍然用文档自己的分配器, 栈属于工作区, 用 malloc
+    lept_workspace_enter(w, &c);
+    return lept_document_parse_context(d, &c, 0, w);
+}
+
+int lept_workspace_stringify(lept_workspace *w, const lept_value *v, const char **json, size_t *length) {
+
+    lept_context c;
+    int ret;
+    assert(w != NULL && v != NULL && json != NULL);
+#ifdef LEPT_STATS
+    uint64_t t0 = lept_cycles();
+    lept_stats_reset();
+#endif
+    lept_context_init(&c);
+    lept_workspace_enter(w, &c);
+
+    ret = lept_stringify_value(&c, v);
+    if (ret == LEPT_STRINGIFY_OK) {
+        LEPT_STAT(lept_stats_current.bytes = c.top; lept_stats_current.cycles = lept_cycles() - t0);
+        if (length) *length = c.top;
+        PUTC(&c, '\0');
+        *json = c.stack;
+    } else
+        *json = NULL;
+    lept_workspace_leave(w, &c);
+    return ret;
+}
+
+static int lept_write_file(void *user, const char *data, size_t len) {
+
+    return fwrite(data, 1, len, (FILE *) user) != len;
+}
+
+int lept_stringify_file(const lept_value *v, FILE *fp) {
+
+    assert(fp != NULL);
+    return lept_stringify_to(v, lept_write_file, fp);
+}
+
+#ifndef _WIN32
+static int lept_write_fd(void *user, const char *data, size_t len) {
+
+    int fd = *(const int *) user;
+    while (len) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        data += n;
+        len -= (size_t) n;
+    }
+    return 0;
+}
+
+int lept_stringify_fd(const lept_value *v, int fd) {
+
+    return lept_stringify_to(v, lept_write_fd, &fd);
+}
+#endif
+
+/* 二进制编码: 格式见 leptjson.h; 读写都按字节拼小端整数, 不要求对齐, 也和机器的字节序无关 */
+
+static const char lept_binary_magic[8] = { 'L', 'E', 'P', 'T', 'B', 'I', 'N', '1' };
+
+static void lept_binary_put_u32(char *p, size_t x) {
+
+    assert(x <= UINT32_MAX);
+    p[0] = (char) (x & 0xff);
+    p[1] = (char) ((x >> 8) & 0xff);
+    p[2] = (char) ((x >> 16) & 0xff);
+    p[3] = (char) ((x >> 24) & 0xff);
+}
+
+static size_t lept_binary_get_u32(const char *p) {
+
+    const unsigned char *q = (const unsigned char *) p;
+    return (size_t) q[0] | (size_t) q[1] << 8 | (size_t) q[2] << 16 | (size_t) q[3] << 24;
+}
+
+static void lept_binary_put_string(lept_context *c, const char *s, size_t len) {
+
+    char *p = (char *) lept_context_push(c, len + 5);
+    lept_binary_put_u32(p, len);
+    memcpy(p + 4, s, len);
+    p[4 + len] = '\0';
+}
+
+static void lept_binary_encode_value(lept_context *c, const lept_value *v) {
+
+    LEPT_LAZY_EXPAND(v);
+    PUTC(c, (char) v->type);
+    switch (v->type) {
+        case LEPT_NUMBER: {
+            uint64_t bits;
+            char *p = (char *) lept_context_push(c, 8);
+            memcpy(&bits, &v->u.n, 8);
+            for (int i = 0; i < 8; i++)
+                p[i] = (char) ((bits >> (8 * i)) & 0xff);
+            break;
+        }
+        case LEPT_STRING:
+            lept_binary_put_string(c, LEPT_STRING(v), LEPT_STRING_LENGTH(v));
+            break;
+        case LEPT_ARRAY:
+        case LEPT_OBJECT: {
+            //栈会 realloc, 偏移表只记位置, 每写一个元素回填一项
+            size_t start = c->top - 1, table;
+            lept_binary_put_u32((char *) lept_context_push(c, 4), v->size);
+            table = c->top;
+            if (v->size)
+                lept_context_push(c, 4 * (size_t) v->size);
+            for (size_t i = 0; i < v->size; i++) {
+                lept_binary_put_u32(c->stack + table + 4 * i, c->top - start);
+                if (v->type == LEPT_ARRAY)
+                    lept_binary_encode_value(c, &v->u.e[i]);
+                else {
+                    lept_binary_put_string(c, LEPT_STRING(&v->u.m[i].k), LEPT_STRING_LENGTH(&v->u.m[i].k));
+                    lept_binary_encode_value(c, &v->u.m[i].v);
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/* 编码后的字节数, 同时检查格式的限制, 超过时返回 SIZE_MAX: 在写之前发现, 不会先写出几个 GB 再失败
+ * 长度和个数来自 32 位的 size, 总是放得下; 要检查的是容器内元素的偏移和嵌套的层数
+ */
+static size_t lept_binary_size(const lept_value *v, size_t depth) {
+
+    size_t n, len;
+    LEPT_LAZY_EXPAND(v);
+    switch (v->type) {
+        case LEPT_NUMBER:
+            return 9;
+        case LEPT_STRING:
+            return 6 + LEPT_STRING_LENGTH(v);
+        case LEPT_ARRAY:
+        case LEPT_OBJECT:
+            if (depth == LEPT_BINARY_MAX_DEPTH)
+                return SIZE_MAX;
+            n = 5 + 4 * (size_t) v->size; //n 是下一个元素的偏移
+            for (size_t i = 0; i < v->size; i++) {
+                if (n > UINT32_MAX)
+                    return SIZE_MAX;
+                if (v->type == LEPT_ARRAY)
+                    len = lept_binary_size(&v->u.e[i], depth + 1);
+                else if ((len = lept_binary_size(&v->u.m[i].v, depth + 1)) != SIZE_MAX)
+                    len += 5 + LEPT_STRING_LENGTH(&v->u.m[i].k);
+                if (len >= SIZE_MAX - n)
+                    return SIZE_MAX;
+                n += len;
+            }
+            return n;
+        default:
+            return 1;
+    }
+}
+
+int lept_encode_binary(const lept_value *v, char **data, size_t *length) {
+
+    lept_context c;
+    size_t n;
+    assert(v != NULL && data != NULL);
+    *data = NULL;
+    if ((n = lept_binary_size(v, 0)) >= SIZE_MAX - sizeof(lept_binary_magic))
+        return LEPT_STRINGIFY_TOO_LARGE;
+    lept_context_init(&c);
+    //总长度已知, 一次分配 (push 正好填满时也会增长, 多留一个字节)
+    c.stack = malloc(c.size = sizeof(lept_binary_magic) + n + 1);
+
+    PUTS(&c, lept_binary_magic, sizeof(lept_binary_magic));
+    lept_binary_encode_value(&c, v);
+    if (length) *length = c.top;
+    *data = c.stack;
+    return LEPT_STRINGIFY_OK;
+}
+
+static double lept_binary_number_at(const char *p) {
+
+    const unsigned char *q = (const unsigned char *) p;
+    uint64_t bits = 0;
+    double n;
+    for (int i = 7; i >= 0; i--)
+        bits = bits << 8 | q[i];
+    memcpy(&n, &bits, 8);
+    return n;
+}
+
+/* 字符串内容 (长度, 内容, '\0') 的结尾, 越界时返回 NULL */
+static const char *lept_binary_check_string(const char *p, const char *end) {
+
+    size_t len;
+    if (end - p < 4)
+        return NULL;
+    len = lept_binary_get_u32(p);
+    if (len > LEPT_SIZE_MAX || (size_t) (end - p - 4) <= len || p[4 + len] != '\0')
+        return NULL;
+    return p + 5 + len;
+}
+
+/* 返回 p 处的值的结尾; 偏移必须和元素实际的位置一致, number 必须是有限的
+ * depth 是外面的容器层数, 超过 LEPT_BINARY_MAX_DEPTH 时拒绝, 恶意的深层嵌套不会把栈用完
+ */
+static const char *lept_binary_check(const char *p, const char *end, size_t depth) {
+
+    if (p == end)
+        return NULL;
+    switch ((unsigned char) *p) {
+        case LEPT_NULL:
+        case LEPT_FALSE:
+        case LEPT_TRUE:
+            return p + 1;
+        case LEPT_NUMBER: {
+            double n;
+            if (end - p < 9)
+                return NULL;
+            n = lept_binary_number_at(p + 1);
+            return n - n == 0.0 ? p + 9 : NULL; //inf 和 nan 都不是 JSON 的数字
+        }
+        case LEPT_STRING:
+            return lept_binary_check_string(p + 1, end);
+        case LEPT_ARRAY:
+        case LEPT_OBJECT: {
+            const char *q;
+            size_t n;
+            if (end - p < 5 || depth == LEPT_BINARY_MAX_DEPTH)
+                return NULL;
+            n = lept_binary_get_u32(p + 1);
+            if (n > LEPT_SIZE_MAX || (size_t) (end - p - 5) / 4 < n)
+                return NULL;
+            q = p + 5 + 4 * n;
+            for (size_t i = 0; i < n; i++) {
+                if (lept_binary_get_u32(p + 5 + 4 * i) != (size_t) (q - p))
+                    return NULL;
+                if (*p == LEPT_OBJECT && (q = lept_binary_check_string(q, end)) == NULL)
+                    return NULL;
+                if ((q = lept_binary_check(q, end, depth + 1)) == NULL)
+                    return NULL;
+            }
+            return q;
+        }
+        default:
+            return NULL;
+    }
+}
+
+const char *lept_binary_root(const void *data, size_t len) {
+
+    const char *p = (const char *) data;
+    assert(data != NULL || len == 0);
+    if (len < sizeof(lept_binary_magic) || memcmp(p, lept_binary_magic, sizeof(lept_binary_magic)) != 0)
+        return NULL;
+    if (lept_binary_check(p + sizeof(lept_binary_magic), p + len, 0) != p + len)
+        return NULL;
+    return p + sizeof(lept_binary_magic);
+}
+
+/* 编码已经检查过, 个数都是已知的, 每个数组/成员块只分配一次 */
+static const char *lept_binary_build(lept_context *c, lept_value *v, const char *p) {
+
+    size_t n;
+    switch ((unsigned char) *p) {
+        case LEPT_NUMBER:
+            v->u.n = lept_binary_number_at(p + 1);
+            v->flags = 0;
+            v->type = LEPT_NUMBER;
+            return p + 9;
+        case LEPT_STRING:
+            n = lept_binary_get_u32(p + 1);
+            lept_parse_set_string(c, v, (char *) p + 5, n);
+            return p + 6 + n;
+        case LEPT_ARRAY:
+            n = lept_binary_get_u32(p + 1);
+            v->u.e = n ? (lept_value *) lept_parse_alloc(c, n * sizeof(lept_value)) : NULL;
+            p += 5 + 4 * n;
+            for (size_t i = 0; i < n; i++)
+                p = lept_binary_build(c, &v->u.e[i], p);
+            v->size = (uint32_t) n;
+            v->flags = c->flags;
+            v->type = LEPT_ARRAY;
+            return p;
+        case LEPT_OBJECT:
+            n = lept_binary_get_u32(p + 1);
+            v->u.m = n ? (lept_member *) lept_parse_alloc(c, n * sizeof(lept_member)
+                                                           + lept_object_index_capacity(n) * sizeof(lept_member_slot)) : NULL;
+            p += 5 + 4 * n;
+            for (size_t i = 0; i < n; i++) {
+                size_t klen = lept_binary_get_u32(p);
+                lept_parse_set_key(c, &v->u.m[i].k, (char *) p + 4, klen);
+                p = lept_binary_build(c, &v->u.m[i].v, p + 5 + klen);
+            }
+            if (n)
+                lept_object_build_index(v->u.m, n);
+            v->size = (uint32_t) n;
+            v->flags = c->flags;
+            v->type = LEPT_OBJECT;
+            return p;
+        default:
+            v->flags = 0;
+            v->type = (lept_type) *p;
+            return p + 1;
+    }
+}
+
+int lept_decode_binary(lept_value *v, const void *data, size_t len) {
+
+    lept_context c;
+    const char *root = lept_binary_root(data, len);
+    assert(v != NULL);
+    lept_init(v);
+    if (root == NULL)
+        return LEPT_PARSE_INVALID_BINARY;
+
+    lept_context_init(&c);
+    lept_binary_build(&c, v, root);
+    return LEPT_PARSE_OK;
+}
+
+int lept_document_decode_binary(lept_document *d, const void *data, size_t len) {
+
+    lept_context c;
+    const char *root;
+    assert(d != NULL);
+
+    lept_document_context(d, &c, "", 0); //不解析文本, 只用它的 arena 和驻留表
+    if ((root = lept_binary_root(data, len)) == NULL)
+        return LEPT_PARSE_INVALID_BINARY;
+    lept_binary_build(&c, &d->root, root);
+    return LEPT_PARSE_OK;
+}
+
+lept_type lept_binary_get_type(const char *b) {
+
+    assert(b != NULL);
+    return (lept_type) *b;
+}
+
+int lept_binary_get_boolean(const char *b) {
+
+    assert(b != NULL && (*b == LEPT_TRUE || *b == LEPT_FALSE));
+    return *b == LEPT_TRUE;
+}
+
+double lept_binary_get_number(const char *b) {
+
+    assert(b != NULL && *b == LEPT_NUMBER);
+    return lept_binary_number_at(b + 1);
+}
+
+const char *lept_binary_get_string(const char *b) {
+
+    assert(b != NULL && *b == LEPT_STRING);
+    return b + 5;
+}
+
+size_t lept_binary_get_string_length(const char *b) {
+
+    assert(b != NULL && *b == LEPT_STRING);
+    return lept_binary_get_u32(b + 1);
+}
+
+size_t lept_binary_get_size(const char *b) {
+
+    assert(b != NULL && (*b == LEPT_ARRAY || *b == LEPT_OBJECT));
+    return lept_binary_get_u32(b + 1);
+}
+
+const char *lept_binary_get_element(const char *b, size_t index) {
+
+    assert(b != NULL && *b == LEPT_ARRAY);
+    assert(index < lept_binary_get_u32(b + 1));
+    return b + lept_binary_get_u32(b + 5 + 4 * index);
+}
+
+/* 成员从 key 的长度开始 */
+static const char *lept_binary_member(const char *b, size_t index) {
+
+    assert(b != NULL && *b == LEPT_OBJECT);
+    assert(index < lept_binary_get_u32(b + 1));
+    return b + lept_binary_get_u32(b + 5 + 4 * index);
+}
+
+const char *lept_binary_get_object_key(const char *b, size_t index) {
+
+    return lept_binary_member(b, index) + 4;
+}
+
+size_t lept_binary_get_object_key_length(const char *b, size_t index) {
+
+    return lept_binary_get_u32(lept_binary_member(b, index));
+}
+
+const char *lept_binary_get_object_value(const char *b, size_t index) {
 
+    const char *m = lept_binary_member(b, index);
+    return m + 5 + lept_binary_get_u32(m);
+}
 
+const char *lept_binary_find_object_value(const char *b, const char *key, size_t klen) {
 
+    assert(b != NULL && *b == LEPT_OBJECT);
+    assert(key != NULL || klen == 0);
+    for (size_t i = 0, n = lept_binary_get_u32(b + 1); i < n; i++) {
+        const char *m = b + lept_binary_get_u32(b + 5 + 4 * i);
+        if (lept_binary_get_u32(m) == klen && (klen == 0 || memcmp(m + 4, key, klen) == 0))
+            return m + 5 + klen;
+    }
+    return NULL;
+}
@@ -2,25 +2,45 @@
 #define LEPTJSON_H__
 
 #include <stddef.h> //size_t
+#include <stdio.h> //FILE
+#include <stdint.h> //uint32_t
 
 typedef enum { LEPT_NULL, LEPT_FALSE, LEPT_TRUE, LEPT_NUMBER, LEPT_STRING, LEPT_ARRAY, LEPT_OBJECT } lept_type;
 
 typedef struct lept_value lept_value; //后面直接使用 lept_value 声明变量的地方就等于使用了 struct lept_value
 typedef struct lept_member lept_member;
+typedef struct lept_lazy lept_lazy; //延迟解析时记录的数组/对象的范围
+
+/* lept_value.flags */
+#define LEPT_VALUE_BORROWED 0x1 /* 字符串/数组/成员块的内存不归这个值所有, lept_free 时不释放 */
+#define LEPT_VALUE_LAZY 0x4 /* 数组/对象还没有展开, 内容在 u.l 中; 第一次访问元素时展开 */
+#define LEPT_VALUE_INLINE 0x8 /* 短字符串直接存放在值里, 见下面 */
+
+/* 16 字节: 长度和元素个数用 32 位, type 和 flags 各占一个字节
+ * 长度不超过 LEPT_INLINE_MAX 的字符串不单独分配内存, 从值的第一个字节开始存放 (覆盖 u 和 size), 由 end 结尾, 长度在 slen 中
+ * (in situ 解析出的字符串除外, 仍然指向输入缓冲区); 值被移动之后, 之前取得的短字符串指针就失效了
+ * 字符串, 数组和对象的长度都不能超过 UINT32_MAX (编译时可以用 LEPT_SIZE_MAX 设得更小):
+ * 解析时遇到更长的字符串或者更多的元素返回 LEPT_PARSE_TOO_LARGE, 传给 lept_set_string 是调用者的错误 (断言)
+ */
+#define LEPT_INLINE_MAX 12
 
 struct lept_value { // 放在 struct 关键字后面的是结构体类型的名字，放在后面的是这个结构体类型的一个变量
-    lept_type type;
     union {
-        struct { lept_member *m; size_t size; } o;
-        struct { char *s; size_t len; } s;
+        lept_member *m;
+        char *s;
         double n;
-        struct { lept_value *e; size_t size; } a; //数组用什么实现, 动态数组还是链表? 还要实现访问, 添加, 插入的函数
+        lept_value *e; //数组用什么实现, 动态数组还是链表? 还要实现访问, 添加, 插入的函数
+        const lept_lazy *l; //LEPT_VALUE_LAZY
     } u;
+    uint32_t size; //字符串的长度, 数组的元素个数或者对象的成员个数
+    char end; //长度为 LEPT_INLINE_MAX 的短字符串的 '\0'
+    unsigned char slen; //短字符串的长度
+    unsigned char flags; //LEPT_VALUE_*
+    unsigned char type; //lept_type
 };
 
 struct lept_member {
-    char *k; //memebr key string
-    size_t klen; //member key string length
+    lept_value k; //member key, 总是字符串, 短的 key 也直接放在里面
     lept_value v; //member key value
 };
 
@@ -40,28 +60,67 @@ enum {
     LEPT_PARSE_MISS_COLON, //12
     LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET, //13
     LEPT_STRINGIFY_OK, //14
+    LEPT_PARSE_ABORTED, //15 handler 要求停止解析
+    LEPT_PARSE_NEED_MORE, //16 增量解析: 输入还不完整
+    LEPT_STRINGIFY_WRITE_ERROR, //17 输出回调返回了错误
+    LEPT_STRINGIFY_BUFFER_TOO_SMALL, //18
+    LEPT_PARSE_INVALID_BINARY, //19 二进制编码的格式不对或者被截断
+    LEPT_PARSE_FILE_ERROR, //20 打不开, 不是普通文件或者映射失败, 原因见 errno
+    LEPT_PARSE_TOO_LARGE, //21 字符串或者数组/对象超过了 lept_value 能记录的长度, 见上
+    LEPT_STRINGIFY_TOO_LARGE, //22 超出了二进制编码的限制, 见 lept_encode_binary
 };
 
-#define lept_init(v) do{ (v)->type = LEPT_NULL; } while(0)
+#define lept_init(v) do{ (v)->type = LEPT_NULL; (v)->flags = 0; } while(0)
 
 
+/* 分配器: 每次调用 (lept_*_with) 或者每个文档 (lept_arena.alloc) 可以指定自己的分配器, 为 NULL 时用 malloc/realloc/free
+ * realloc 的 p 可能为 NULL; free 的 p 不为 NULL; user 原样传给每个回调
+ */
+typedef struct {
+    void *(*malloc)(void *user, size_t size);
+    void *(*realloc)(void *user, void *p, size_t size);
+    void (*free)(void *user, void *p);
+    void *user;
+} lept_allocator;
+
 int lept_parse(lept_value *v, const char *json);
+/* 只解析 json 的前 len 个字节, 不要求以 '\0' 结尾; 其中出现的 '\0' 是非法字符 */
+int lept_parse_n(lept_value *v, const char *json, size_t len);
+#ifndef _WIN32
+/* 直接解析文件: 只读映射 (MADV_SEQUENTIAL), 不读进缓冲区, 解析完就解除映射; 打不开时返回 LEPT_PARSE_FILE_ERROR */
+int lept_parse_file(lept_value *v, const char *path);
+#endif
 
 void lept_free(lept_value *v);
 
+/* 值的内存 (和解析时临时的栈) 都从 a 分配, 必须用同一个 a 的 lept_free_with 释放
+ * 之后修改要用同一个 a 的 lept_set_*_with, 混用 lept_set_* 会把 malloc 和 a 的内存混在一棵树里
+ */
+int lept_parse_with(lept_value *v, const char *json, size_t len, const lept_allocator *a);
+void lept_free_with(lept_value *v, const lept_allocator *a);
+
+/* in situ 解析: 在 json 缓冲区中原地反转义, 字符串和 key 直接指向 json, 不再拷贝和 malloc */
+/* json 会被改写 (即使解析失败), 并且必须比解析出的值活得更久 */
+int lept_parse_insitu(lept_value *v, char *json);
+
 lept_type lept_get_type(const lept_value *v);
 
 #define lept_set_null(v) lept_free(v)
 
 int lept_get_boolean(const lept_value *v);
 void lept_set_boolean(lept_value *v, int bool);
+void lept_set_boolean_with(lept_value *v, int bool, const lept_allocator *a);
 
 double lept_get_number(const lept_value *v);
 void lept_set_number(lept_value *v, double n);
+void lept_set_number_with(lept_value *v, double n, const lept_allocator *a);
 
-char *lept_get_string(const lept_value *v);
+/* 和 key 一样是只读的: 字符串可能指向调用者的输入或者 lept_document_parse_file 的只读映射, 要修改请用 lept_set_string */
+const char *lept_get_string(const lept_value *v);
 size_t lept_get_string_length(const lept_value *v);
 void lept_set_string(lept_value *v, const char *s, size_t len);
+/* 旧值用 a 释放, 新字符串从 a 分配 */
+void lept_set_string_with(lept_value *v, const char *s, size_t len, const lept_allocator *a);
 
 size_t lept_get_array_size(const lept_value *v);
 lept_value *lept_get_array_element(const lept_value *v, size_t index);
@@ -70,6 +129,220 @@ size_t lept_get_object_size(const lept_value *v);
 const char *lept_get_object_key(const lept_value *v, size_t index);
 size_t lept_get_object_key_length(const lept_value *v, size_t index);
 lept_value *lept_get_object_value(const lept_value *v, size_t index);
+/* 按 key 查找成员, 有重复的 key 时返回第一个; 大对象在解析时建立了哈希索引, 查找是 O(1) 的 */
+#define LEPT_KEY_NOT_EXIST ((size_t) -1)
+size_t lept_find_object_index(const lept_value *v, const char *key, size_t klen);
+lept_value *lept_find_object_value(const lept_value *v, const char *key, size_t klen); //找不到时返回 NULL
+
+/* JSON Pointer (RFC 6901): 路径编译一次, 可以反复对不同的文档求值
+ * path 不要求以 '\0' 结尾; 语法错误 (不以 '/' 开头, '~' 后面不是 0 或 1) 时返回 NULL, "" 指向根
+ */
+typedef struct lept_pointer lept_pointer;
+
+lept_pointer *lept_pointer_compile(const char *path, size_t len);
+void lept_pointer_free(lept_pointer *p);
+/* 找不到时返回 NULL; 数组下标 "-" 总是找不到; 在延迟解析的文档上只展开路径经过的容器 */
+lept_value *lept_pointer_get(const lept_pointer *p, const lept_value *v);
+/* 批量求值: results[i] 是 ps[i] 的结果, 前缀相同的指针只走一次 */
+void lept_pointer_get_all(lept_pointer *const *ps, size_t count, const lept_value *v, lept_value **results);
 
 int lept_stringify(const lept_value *v, char **json, size_t *length);
+/* 输出缓冲区 (和增长时的 realloc) 都通过 a, 用 a->free 释放 */
+int lept_stringify_with(const lept_value *v, char **json, size_t *length, const lept_allocator *a);
+
+/* 精确长度: lept_stringify_length 返回输出的字节数 (不含 '\0'), 不产生输出
+ * lept_stringify_buffer 一次写入调用者的缓冲区, 不分配内存, 也不写 '\0'; *length 总是设为需要的长度
+ * 缓冲区不够时返回 LEPT_STRINGIFY_BUFFER_TOO_SMALL, buf 的内容不变
+ */
+size_t lept_stringify_length(const lept_value *v);
+int lept_stringify_buffer(const lept_value *v, char *buf, size_t size, size_t *length);
+
+/* 流式输出: 通过固定大小的缓冲区分块写出, 内存占用和文档大小无关
+ * write 返回 0 表示成功, 非 0 时停止输出并返回 LEPT_STRINGIFY_WRITE_ERROR, 已经写出的部分不会撤回
+ */
+typedef int (*lept_write_func)(void *user, const char *data, size_t len);
+int lept_stringify_to(const lept_value *v, lept_write_func write, void *user);
+int lept_stringify_to_with(const lept_value *v, lept_write_func write, void *user, const lept_allocator *a); //固定缓冲区从 a 分配
+int lept_stringify_file(const lept_value *v, FILE *fp);
+#ifndef _WIN32
+int lept_stringify_fd(const lept_value *v, int fd); //处理部分写入和 EINTR
+#endif
+
+/* SAX: 解析时依次回调 handler, 不构建 lept_value 树
+ * 回调返回 0 继续解析, 返回非 0 时解析立即停止并返回 LEPT_PARSE_ABORTED; 为 NULL 的回调直接跳过
+ * string/key 的 s 不以 '\0' 结尾, 可能指向 json 或解析器内部的缓冲区, 只在回调期间有效
+ * 解析失败时, 出错之前的事件已经回调过了
+ */
+typedef struct {
+    int (*null)(void *user);
+    int (*boolean)(void *user, int b);
+    int (*number)(void *user, double n);
+    int (*string)(void *user, const char *s, size_t len);
+    int (*key)(void *user, const char *s, size_t len);
+    int (*start_object)(void *user);
+    int (*end_object)(void *user, size_t size); //size 是成员个数
+    int (*start_array)(void *user);
+    int (*end_array)(void *user, size_t size); //size 是元素个数
+} lept_handler;
+
+int lept_sax_parse(const lept_handler *h, void *user, const char *json);
+int lept_sax_parse_n(const lept_handler *h, void *user, const char *json, size_t len);
+
+/* 增量解析: 输入可以在任意位置切成多块, 依次传给 lept_push_parse, 解析器在块之间保存状态 */
+typedef struct lept_push_parser lept_push_parser;
+
+lept_push_parser *lept_push_parser_new(void);
+void lept_push_parser_free(lept_push_parser *p);
+/* 返回 LEPT_PARSE_NEED_MORE 表示根值还不完整; LEPT_PARSE_OK 表示根值已经完整, 之后的块只能是空白
+ * 根是 number 时要到 lept_push_finish 才能确定结束; 出错后的调用都返回同一个错误
+ */
+int lept_push_parse(lept_push_parser *p, const char *json, size_t len);
+/* 输入结束: 成功时结果移动到 v 中; 之后解析器回到初始状态, 可以继续解析下一个文档 */
+int lept_push_finish(lept_push_parser *p, lept_value *v);
+
+/* NDJSON / JSON Lines: 每行一个 JSON 值, 只有空白的行被跳过; 多个线程并行解析, 结果按输入的顺序存放 */
+typedef struct {
+    lept_value *values; //每条记录的值, 出错的记录为 null
+    int *errors; //每条记录的解析结果
+    size_t *lines; //每条记录所在的行号, 从 1 开始
+    size_t count; //记录数
+} lept_batch;
+
+void lept_batch_init(lept_batch *b);
+/* threads 为 0 时使用全部在线的 CPU; 解析前先释放 b 中原有的内容
+ * 全部成功时返回 LEPT_PARSE_OK, 否则返回第一条出错记录的错误码, 每条记录的结果见 errors
+ */
+int lept_parse_ndjson(lept_batch *b, const char *json, size_t len, unsigned threads);
+void lept_batch_free(lept_batch *b);
+
+/* 并行解析一个大文档: 根是数组时多个线程分别解析数组的元素, 结果和 lept_parse_n 一样
+ * 根不是数组, 文档较小或者 threads 为 1 时就是 lept_parse_n; threads 为 0 时使用全部在线的 CPU
+ */
+int lept_parse_parallel(lept_value *v, const char *json, size_t len, unsigned threads);
+
+/* Document: 整棵树的节点, 字符串和 key 都从 arena 中分配, 释放时只需要释放 arena 的 chunk */
+#ifndef LEPT_ARENA_CHUNK_SIZE
+#define LEPT_ARENA_CHUNK_SIZE (64 * 1024)
+#endif
+
+typedef struct lept_arena_chunk lept_arena_chunk;
+
+typedef struct {
+    lept_arena_chunk *head; //最近分配的 chunk, 通过 next 串起来
+    size_t chunk_size; //新 chunk 的默认大小, 0 表示 LEPT_ARENA_CHUNK_SIZE
+    const lept_allocator *alloc; //chunk 从这里分配, 文档解析时的临时栈也用它; 为 NULL 时用 malloc
+} lept_arena;
+
+/* key 驻留表: 相同内容的 key 只保存一份, 可以被多个文档 (和多个线程) 共享
+ * 加锁用 pthreads: 定义了 LEPT_NO_THREADS 或者在 Windows 上没有锁, 这时表只能在一个线程中使用
+ * 驻留的 key 直到 lept_intern_table_free 才释放, 表必须比使用它的文档活得更久
+ */
+typedef struct lept_intern_table lept_intern_table;
+
+lept_intern_table *lept_intern_table_new(void);
+void lept_intern_table_free(lept_intern_table *t);
+/* 返回 s 的驻留副本, 以 '\0' 结尾; 内容相同时总是返回同一个指针; 有 pthreads 时线程安全 (见上) */
+const char *lept_intern(lept_intern_table *t, const char *s, size_t len);
+
+typedef struct {
+    lept_value root;
+    lept_arena arena;
+    /* 不为 NULL 时, 解析出的长度超过 LEPT_INLINE_MAX 的 key 都指向这个表中的副本, 不再分配内存
+     * 用同一个表驻留过的 key 去查找成员时只需要比较指针
+     */
+    lept_intern_table *keys;
+    void *map; //lept_document_parse_file 映射的文件, 字符串直接指向它, lept_document_free 时解除映射
+    size_t map_size;
+} lept_document;
+
+void lept_document_init(lept_document *d);
+/* 重新解析前会先释放 d 中原有的内容; 失败时 root 为 null */
+int lept_document_parse(lept_document *d, const char *json);
+int lept_document_parse_n(lept_document *d, const char *json, size_t len);
+int lept_document_parse_insitu(lept_document *d, char *json);
+/* 延迟解析: 先用一遍不分配内存的扫描检查整个 json, 记下每个数组/对象的范围, 错误码和 lept_document_parse_n 一样
+ * 数组/对象在第一次通过 lept_get_* (或者 stringify) 访问元素时才展开, 每次只展开一层, 子数组和子对象仍然是延迟的
+ * json 不会被拷贝, 必须比 d 活得更久; 访问会修改树, 同一个文档不能在多个线程中同时访问, d 也不能移动
+ */
+int lept_document_parse_lazy(lept_document *d, const char *json, size_t len);
+#ifndef _WIN32
+/* 把文件只读映射进来解析, 不写映射, 也不拷贝整个文件: 比 LEPT_INLINE_MAX 长又没有转义的字符串和 key 直接指向映射
+ * 这些字符串不以 '\0' 结尾, 要用 lept_get_string_length / lept_get_object_key_length 取长度; 映射是只读的, 写入会 SIGSEGV;
+ * 带转义的反转义到 arena 中, 短的仍然放在值里; 映射归 d 所有, 和 arena 一起释放
+ */
+int lept_document_parse_file(lept_document *d, const char *path);
+#endif
+/* 文档中的值通过 lept_set_* 修改后新分配的内存不归 arena 管理, 需要先自行 lept_free */
+void lept_document_free(lept_document *d);
+
+/* 可复用的工作区: 保存解析和 stringify 用的栈, 反复调用时不再从 256 字节重新增长, 也不再每次 malloc/free
+ * initial_size 为 0 时用 LEPT_PARSE_STACK_INIT_SIZE; 每次调用开始时, 如果栈超过了 shrink_size, 先缩回 initial_size
+ * (shrink_size 为 0 表示从不收缩); 不是线程安全的, 每个线程用自己的工作区
+ */
+typedef struct lept_workspace lept_workspace;
+
+lept_workspace *lept_workspace_new(size_t initial_size, size_t shrink_size);
+void lept_workspace_free(lept_workspace *w);
+/* 和 lept_parse_n / lept_document_parse_n 一样 */
+int lept_workspace_parse(lept_workspace *w, lept_value *v, const char *json, size_t len);
+int lept_workspace_parse_document(lept_workspace *w, lept_document *d, const char *json, size_t len);
+/* *json 以 '\0' 结尾, 指向工作区自己的缓冲区, 不需要 free, 在下一次使用 w 之前有效 */
+int lept_workspace_stringify(lept_workspace *w, const lept_value *v, const char **json, size_t *length);
+
+/* 二进制编码: 用于缓存解析结果, 重新加载时不需要再解析文本
+ * 8 字节的头部之后是根值; 每个值是一个类型字节 (lept_type) 加上内容, 多字节整数和 double 都是小端
+ *   number: 8 字节的 double
+ *   string: uint32 长度, 内容, '\0'
+ *   array/object: uint32 个数, 每个元素/成员一个 uint32 偏移 (相对于容器的类型字节), 然后依次是元素/成员
+ *   成员: key (和 string 的内容一样, 没有类型字节) 后面跟着值
+ * 偏移是 uint32, 单个容器的编码不能超过 4GB; 容器最多嵌套 LEPT_BINARY_MAX_DEPTH 层
+ * 超过限制时 lept_encode_binary 什么也不写, 返回 LEPT_STRINGIFY_TOO_LARGE, *data 为 NULL; 加载时当作格式不对
+ */
+#ifndef LEPT_BINARY_MAX_DEPTH
+#define LEPT_BINARY_MAX_DEPTH 1024
+#endif
+int lept_encode_binary(const lept_value *v, char **data, size_t *length); //成功时返回 LEPT_STRINGIFY_OK, *data 由调用者 free
+/* 先检查整个编码, 再按已知的个数一次分配每个容器; 失败时返回 LEPT_PARSE_INVALID_BINARY, v 为 null */
+int lept_decode_binary(lept_value *v, const void *data, size_t len);
+int lept_document_decode_binary(lept_document *d, const void *data, size_t len);
+
+/* 不构建树, 直接在编码上读取 (比如 mmap 进来的缓存文件): 值用指向它类型字节的指针表示
+ * lept_binary_root 检查整个编码, 失败时返回 NULL; 之后的读取不再检查, 容器按下标访问是 O(1) 的
+ * 字符串和 key 都以 '\0' 结尾, 直接指向编码, 和 data 一样长久
+ */
+const char *lept_binary_root(const void *data, size_t len);
+lept_type lept_binary_get_type(const char *b);
+int lept_binary_get_boolean(const char *b);
+double lept_binary_get_number(const char *b);
+const char *lept_binary_get_string(const char *b);
+size_t lept_binary_get_string_length(const char *b);
+size_t lept_binary_get_size(const char *b); //数组的元素个数或对象的成员个数
+const char *lept_binary_get_element(const char *b, size_t index);
+const char *lept_binary_get_object_key(const char *b, size_t index);
+size_t lept_binary_get_object_key_length(const char *b, size_t index);
+const char *lept_binary_get_object_value(const char *b, size_t index);
+const char *lept_binary_find_object_value(const char *b, const char *key, size_t klen); //顺序比较, 找不到时返回 NULL
+
+#ifdef LEPT_STATS
+/* 统计: 只在定义 LEPT_STATS 时编译, 否则没有任何开销
+ * 每个线程一份, 每次 DOM 解析 (lept_parse* / lept_document_parse*) 和 lept_stringify / lept_stringify_to 开始时清零
+ * 并行和 NDJSON 解析在工作线程里完成, 调用线程上的统计不完整
+ * 周期数在 x86 上是 rdtsc, 其他平台是纳秒
+ */
+typedef struct {
+    size_t bytes; //解析消耗的输入 / stringify 输出的字节数
+    size_t nodes[7]; //按 lept_type 统计的值的个数, 对象的 key 不算
+    size_t mallocs, malloc_bytes; //包括 arena 新分配的 chunk
+    size_t reallocs, realloc_bytes; //realloc_bytes 是每次 realloc 之后的大小之和
+    size_t stack_peak; //lept_context 栈的最大用量
+    size_t stack_growths;
+    size_t max_depth; //数组/对象的最大嵌套层数, 根是容器时为 1
+    uint64_t cycles; //整个调用
+    uint64_t string_cycles; //解析: 字符串和 key 的反转义; stringify: 转义
+    uint64_t number_cycles; //解析: 数字转换; stringify: 数字格式化
+    uint64_t alloc_cycles; //解析时为值分配内存
+} lept_stats;
+
+const lept_stats *lept_get_stats(void); //当前线程最近一次调用的统计
+#endif
 #endif /* LEPTJSON_H__ */
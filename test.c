@@ -2,6 +2,9 @@
 #include <string.h>
 #include <stdlib.h>
 #include "leptjson.h"
+#if !defined(LEPT_NO_THREADS) && !defined(_WIN32)
+#include <pthread.h>
+#endif
 
 static int main_ret = 0;
 static int test_count = 0;
@@ -158,11 +161,32 @@ static void test_parse_number() {
     TEST_NUMBER(-1.7976931348623157e+308, "-1.7976931348623157e+308");
 }
 
+static void test_parse_number_rounding() {
+
+    //超过 19 位有效数字, 正好一半时向偶数舍入
+    TEST_NUMBER(9007199254740992.0, "9007199254740993");
+    TEST_NUMBER(9007199254740996.0, "9007199254740995");
+    TEST_NUMBER(1.0, "1.00000000000000011102230246251565404236316680908203125");
+    TEST_NUMBER(1.0000000000000002, "1.00000000000000011102230246251565404236316680908203126");
+    TEST_NUMBER(1.2345678901234568e+29, "123456789012345678901234567890");
+    TEST_NUMBER(0.1, "0.1000000000000000000000000000000000000000001");
+    TEST_NUMBER(2.2250738585072011e-308, "2.2250738585072011e-308");
+    TEST_NUMBER(0.0, "0.0000000000000000000000000000000000000000000e999999");
+    TEST_NUMBER(1e-300, "0.000000000000000000000000000000000000000000000001e-252");
+    TEST_NUMBER(4.9406564584124654e-324, "2.4703282292062328e-324"); /* 刚刚大于最小非规格化数的一半 */
+    TEST_NUMBER(0.0, "2.4703282292062327e-324");
+    TEST_NUMBER(1.7976931348623157e+308, "1.7976931348623158e+308");
+    TEST_NUMBER(123456.789, "123456.789");
+    TEST_NUMBER(-0.0, "-0");
+}
+
 static void test_parse_number_too_big() {
 
 #if 1
     TEST_ERROR(LEPT_PARSE_NUMBER_TOO_BIG, "1e309");
     TEST_ERROR(LEPT_PARSE_NUMBER_TOO_BIG, "-1e309");
+    TEST_ERROR(LEPT_PARSE_NUMBER_TOO_BIG, "1.7976931348623159e+308");
+    TEST_ERROR(LEPT_PARSE_NUMBER_TOO_BIG, "100000000000000000000000e99999");
 #endif
 }
 
@@ -411,6 +435,1318 @@ static void test_access_string() {
     lept_free(&v);
 }
 
+/* 不超过 LEPT_INLINE_MAX 的字符串存放在值里面 */
+static void test_access_inline_string() {
+
+    lept_value v, *e;
+    size_t i;
+    static const char s[] = "0123456789abcdef";
+
+    EXPECT_EQ_SIZE_T(16, sizeof(lept_value));
+    EXPECT_EQ_SIZE_T(32, sizeof(lept_member));
+    lept_init(&v);
+    for (i = 0; i <= 16; i++) {
+        lept_set_string(&v, s, i);
+        EXPECT_EQ_SIZE_T(i, lept_get_string_length(&v));
+        EXPECT_TRUE(memcmp(s, lept_get_string(&v), i) == 0);
+        EXPECT_EQ_INT('\0', lept_get_string(&v)[i]);
+        EXPECT_EQ_INT(i <= LEPT_INLINE_MAX, (v.flags & LEPT_VALUE_INLINE) != 0);
+    }
+    lept_set_string(&v, "a\0b", 3);
+    lept_set_string(&v, lept_get_string(&v) + 1, 2); //用自己的内容重新设置
+    EXPECT_EQ_STRING("\0b", lept_get_string(&v), lept_get_string_length(&v));
+    lept_free(&v);
+
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "[\"123456789012\",\"1234567890123\",\"\\u0000\\n\"]"));
+    e = lept_get_array_element(&v, 0);
+    EXPECT_TRUE(e->flags & LEPT_VALUE_INLINE);
+    EXPECT_EQ_STRING("123456789012", lept_get_string(e), lept_get_string_length(e));
+    e = lept_get_array_element(&v, 1);
+    EXPECT_FALSE(e->flags & LEPT_VALUE_INLINE);
+    EXPECT_EQ_STRING("1234567890123", lept_get_string(e), lept_get_string_length(e));
+    e = lept_get_array_element(&v, 2);
+    EXPECT_TRUE(e->flags & LEPT_VALUE_INLINE);
+    EXPECT_EQ_STRING("\0\n", lept_get_string(e), lept_get_string_length(e));
+    lept_free(&v);
+}
+
+static void test_access_find_object() {
+
+    lept_value v, *e;
+    lept_document d;
+    char json[32 * 1024], key[16];
+    static const size_t sizes[] = { 1, 15, 16, 17, 100, 1000 };
+    size_t i, k;
+
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "{\"a\":1,\"\":2,\"a\\u0000b\":3,\"a\":4}"));
+    EXPECT_EQ_SIZE_T(0, lept_find_object_index(&v, "a", 1));
+    EXPECT_EQ_SIZE_T(1, lept_find_object_index(&v, "", 0));
+    EXPECT_EQ_SIZE_T(2, lept_find_object_index(&v, "a\0b", 3));
+    EXPECT_EQ_SIZE_T(LEPT_KEY_NOT_EXIST, lept_find_object_index(&v, "b", 1));
+    EXPECT_EQ_SIZE_T(LEPT_KEY_NOT_EXIST, lept_find_object_index(&v, "a\0", 2));
+    EXPECT_TRUE((e = lept_find_object_value(&v, "a", 1)) != NULL);
+    EXPECT_EQ_DOUBLE(1.0, lept_get_number(e));
+    EXPECT_TRUE(lept_find_object_value(&v, "ab", 2) == NULL);
+    lept_free(&v);
+
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "{}"));
+    EXPECT_TRUE(lept_find_object_value(&v, "a", 1) == NULL);
+    lept_free(&v);
+
+    /* 大对象走哈希索引, 最后有一个重复的 key */
+    for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+        size_t len = 1, n = sizes[k];
+        json[0] = '{';
+        for (i = 0; i < n; i++)
+            len += sprintf(json + len, "%s\"key%u\":%u", i ? "," : "", (unsigned) i, (unsigned) i);
+        if (n)
+            len += sprintf(json + len, ",\"key0\":-1");
+        json[len++] = '}';
+        json[len] = '\0';
+
+        lept_init(&v);
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json));
+        for (i = 0; i < n; i++) {
+            sprintf(key, "key%u", (unsigned) i);
+            EXPECT_EQ_SIZE_T(i, lept_find_object_index(&v, key, strlen(key)));
+        }
+        EXPECT_EQ_SIZE_T(LEPT_KEY_NOT_EXIST, lept_find_object_index(&v, "key", 3));
+        sprintf(key, "key%u", (unsigned) n);
+        EXPECT_EQ_SIZE_T(LEPT_KEY_NOT_EXIST, lept_find_object_index(&v, key, strlen(key)));
+        lept_free(&v);
+
+        lept_document_init(&d);
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_document_parse_insitu(&d, json));
+        for (i = 0; i < n; i += 7) {
+            sprintf(key, "key%u", (unsigned) i);
+            EXPECT_TRUE((e = lept_find_object_value(&d.root, key, strlen(key))) != NULL);
+            EXPECT_EQ_DOUBLE((double) i, lept_get_number(e));
+        }
+        lept_document_free(&d);
+    }
+}
+
+static double pointer_number(const lept_value *v, const char *path) {
+
+    lept_pointer *p = lept_pointer_compile(path, strlen(path));
+    lept_value *e = lept_pointer_get(p, v);
+    lept_pointer_free(p);
+    return e && lept_get_type(e) == LEPT_NUMBER ? lept_get_number(e) : -1.0;
+}
+
+static void test_access_pointer() {
+
+    /* RFC 6901 第 5 节的例子 */
+    static const char json[] = "{\"foo\":[\"bar\",\"baz\"],\"\":0,\"a/b\":1,\"c%d\":2,\"e^f\":3,\"g|h\":4,"
+                               "\"i\\\\j\":5,\"k\\\"l\":6,\" \":7,\"m~n\":8,\"nested\":{\"x\":[{\"y\":9}]},"
+                               "\"other\":[{}]}";
+    static const char *const paths[] = {
+        "/", "/a~1b", "/c%d", "/e^f", "/g|h", "/i\\j", "/k\"l", "/ ", "/m~0n", "/nested/x/0/y",
+        "/foo/2", "/foo/-", "/foo/01", "/foo/+1", "/foo/18446744073709551616", "/foo/0/x", "/nope", "/nested/x/0/y/z",
+        "/a~1b", "/nested/x/0", ""
+    };
+    static const double numbers[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, -1, -1, -1, -1, -1, -1, -1, -1, 1, -1, -1 };
+    lept_pointer *ps[sizeof(paths) / sizeof(paths[0])];
+    lept_value *results[sizeof(paths) / sizeof(paths[0])];
+    lept_value v, *e;
+    lept_document d;
+    size_t i;
+
+    EXPECT_TRUE(lept_pointer_compile("a", 1) == NULL);
+    EXPECT_TRUE(lept_pointer_compile("/a~", 3) == NULL);
+    EXPECT_TRUE(lept_pointer_compile("/a~2", 4) == NULL);
+    EXPECT_TRUE((ps[0] = lept_pointer_compile("/a~01", 2)) != NULL); //只看前 len 个字节
+    lept_pointer_free(ps[0]);
+
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json));
+    for (i = 0; i < sizeof(paths) / sizeof(paths[0]); i++)
+        EXPECT_EQ_DOUBLE(numbers[i], pointer_number(&v, paths[i]));
+    ps[0] = lept_pointer_compile("", 0);
+    EXPECT_TRUE(lept_pointer_get(ps[0], &v) == &v);
+    lept_pointer_free(ps[0]);
+    ps[0] = lept_pointer_compile("/foo/1", 6);
+    EXPECT_TRUE((e = lept_pointer_get(ps[0], &v)) != NULL);
+    EXPECT_EQ_STRING("baz", lept_get_string(e), lept_get_string_length(e));
+    lept_pointer_free(ps[0]);
+
+    /* 批量求值和逐个求值的结果一样 */
+    for (i = 0; i < sizeof(paths) / sizeof(paths[0]); i++)
+        ps[i] = lept_pointer_compile(paths[i], strlen(paths[i]));
+    lept_pointer_get_all(ps, sizeof(paths) / sizeof(paths[0]), &v, results);
+    for (i = 0; i < sizeof(paths) / sizeof(paths[0]); i++)
+        EXPECT_TRUE(results[i] == lept_pointer_get(ps[i], &v));
+    lept_free(&v);
+
+    /* 延迟解析的文档: 只展开路径经过的容器 */
+    lept_document_init(&d);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_document_parse_lazy(&d, json, sizeof(json) - 1));
+    lept_pointer_get_all(ps, sizeof(paths) / sizeof(paths[0]), &d.root, results);
+    for (i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+        if (numbers[i] >= 0)
+            EXPECT_EQ_DOUBLE(numbers[i], lept_get_number(results[i]));
+        EXPECT_TRUE(results[i] == lept_pointer_get(ps[i], &d.root));
+    }
+    EXPECT_TRUE(lept_find_object_value(&d.root, "other", 5)->flags & LEPT_VALUE_LAZY);
+    lept_document_free(&d);
+    for (i = 0; i < sizeof(paths) / sizeof(paths[0]); i++)
+        lept_pointer_free(ps[i]);
+
+    /* 有哈希索引的大对象 */
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "{\"k0\":0,\"k1\":1,\"k2\":2,\"k3\":3,\"k4\":4,\"k5\":5,\"k6\":6,"
+                                             "\"k7\":7,\"k8\":8,\"k9\":9,\"k10\":10,\"k11\":11,\"k12\":12,\"k13\":13,"
+                                             "\"k14\":14,\"k15\":15,\"k16\":[16,{\"k17\":17}]}"));
+    EXPECT_EQ_DOUBLE(14.0, pointer_number(&v, "/k14"));
+    EXPECT_EQ_DOUBLE(17.0, pointer_number(&v, "/k16/1/k17"));
+    EXPECT_EQ_DOUBLE(-1.0, pointer_number(&v, "/k17"));
+    lept_free(&v);
+}
+
+#define INTERN_KEYS 1000
+
+#if !defined(LEPT_NO_THREADS) && !defined(_WIN32)
+static void *intern_worker(void *arg) {
+
+    lept_intern_table *t = (lept_intern_table *) arg;
+    const char **keys = (const char **) malloc(INTERN_KEYS * sizeof(const char *));
+    char key[32];
+    for (int i = 0; i < INTERN_KEYS; i++) {
+        sprintf(key, "interned key %d", i);
+        keys[i] = lept_intern(t, key, strlen(key));
+    }
+    return keys;
+}
+#endif
+
+static void test_parse_intern() {
+
+    static const char json1[] = "{\"a rather long key\":1,\"short\":2,\"x\":{\"a rather long key\":3}}";
+    static const char json2[] = "[{\"short\":4,\"a rather long key\":5,\"another long key\":6}]";
+    lept_intern_table *t = lept_intern_table_new();
+    lept_document d1, d2;
+    const char *k, *k2;
+    char key[32];
+
+    k = lept_intern(t, "a rather long key", 17);
+    EXPECT_EQ_STRING("a rather long key", k, strlen(k));
+    EXPECT_TRUE(lept_intern(t, "a rather long key", 17) == k);
+    EXPECT_TRUE(lept_intern(t, "a rather long ke", 16) != k);
+    EXPECT_TRUE(lept_intern(t, "", 0) == lept_intern(t, "", 0));
+    EXPECT_TRUE((k2 = lept_intern(t, "a\0b", 3)) != lept_intern(t, "a\0c", 3));
+    EXPECT_TRUE(memcmp(k2, "a\0b", 4) == 0);
+
+    lept_document_init(&d1);
+    lept_document_init(&d2);
+    d1.keys = d2.keys = t;
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_document_parse(&d1, json1));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_document_parse_lazy(&d2, json2, sizeof(json2) - 1));
+    /* 长 key 在不同的文档之间共享, 短 key 仍然在成员里 */
+    EXPECT_TRUE(lept_get_object_key(&d1.root, 0) == k);
+    EXPECT_TRUE(lept_get_object_key(lept_get_object_value(&d1.root, 2), 0) == k);
+    EXPECT_TRUE(lept_get_object_key(lept_get_array_element(&d2.root, 0), 1) == k);
+    EXPECT_TRUE(lept_get_object_key(lept_get_array_element(&d2.root, 0), 2) ==
+                lept_intern(t, "another long key", 16));
+    EXPECT_TRUE(lept_get_object_key(&d1.root, 1) != lept_intern(t, "short", 5));
+    EXPECT_EQ_DOUBLE(3.0, lept_get_number(lept_find_object_value(lept_get_object_value(&d1.root, 2), k, 17)));
+    EXPECT_EQ_DOUBLE(5.0, lept_get_number(lept_find_object_value(lept_get_array_element(&d2.root, 0),
+                                                                 "a rather long key", 17)));
+    EXPECT_EQ_DOUBLE(2.0, lept_get_number(lept_find_object_value(&d1.root, "short", 5)));
+    lept_document_free(&d1);
+    lept_document_free(&d2);
+
+#if !defined(LEPT_NO_THREADS) && !defined(_WIN32)
+    {
+        pthread_t threads[4];
+        const char **keys[4];
+        int i, j;
+        for (i = 0; i < 4; i++)
+            pthread_create(&threads[i], NULL, intern_worker, t);
+        for (i = 0; i < 4; i++)
+            pthread_join(threads[i], (void **) &keys[i]);
+        for (j = 0; j < INTERN_KEYS; j++) {
+            sprintf(key, "interned key %d", j);
+            k = lept_intern(t, key, strlen(key));
+            for (i = 0; i < 4; i++)
+                EXPECT_TRUE(keys[i][j] == k);
+        }
+        for (i = 0; i < 4; i++)
+            free((void *) keys[i]);
+    }
+#else
+    (void) key;
+#endif
+    lept_intern_table_free(t);
+}
+
+/* 二进制编码: 解码后 stringify 的结果和编码前一样 */
+static void test_binary_roundtrip(const char *json) {
+
+    lept_value v, v2;
+    lept_document d;
+    char *data, *json2;
+    size_t len, len2;
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json));
+    EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_encode_binary(&v, &data, &len));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_decode_binary(&v2, data, len));
+    EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_stringify(&v2, &json2, &len2));
+    EXPECT_EQ_SIZE_T(strlen(json), len2);
+    EXPECT_TRUE(memcmp(json, json2, len2) == 0);
+    free(json2);
+    lept_free(&v2);
+    lept_document_init(&d);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_document_decode_binary(&d, data, len));
+    EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_stringify(&d.root, &json2, &len2));
+    EXPECT_EQ_SIZE_T(strlen(json), len2);
+    EXPECT_TRUE(memcmp(json, json2, len2) == 0);
+    free(json2);
+    lept_document_free(&d);
+    free(data);
+    lept_free(&v);
+}
+
+static void test_parse_binary() {
+
+    static const char json[] = "{\"n\":null,\"f\":false,\"t\":true,\"i\":123,\"s\":\"abc\","
+                               "\"a\":[1,2,3],\"o\":{\"1\":1,\"2\":2,\"3\":3},\"\":\"a long string \\u0000 with a nul\"}";
+    lept_value v;
+    lept_document d;
+    const char *b, *e;
+    char *data;
+    size_t len, i;
+
+    test_binary_roundtrip("null");
+    test_binary_roundtrip("false");
+    test_binary_roundtrip("-1.5e-300");
+    test_binary_roundtrip("\"\"");
+    test_binary_roundtrip("\"Hello\\nWorld\\u0000!\"");
+    test_binary_roundtrip("[]");
+    test_binary_roundtrip("{}");
+    test_binary_roundtrip("[[],[{}],[[[1]]]]");
+    test_binary_roundtrip(json);
+    test_binary_roundtrip("{\"k0\":0,\"k1\":1,\"k2\":2,\"k3\":3,\"k4\":4,\"k5\":5,\"k6\":6,\"k7\":7,\"k8\":8,"
+                          "\"k9\":9,\"k10\":10,\"k11\":11,\"k12\":12,\"k13\":13,\"k14\":14,\"k15\":15,\"k16\":16}");
+
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json));
+    EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_encode_binary(&v, &data, &len));
+    lept_free(&v);
+
+    /* 直接在编码上读取 */
+    EXPECT_TRUE((b = lept_binary_root(data, len)) != NULL);
+    EXPECT_EQ_INT(LEPT_OBJECT, lept_binary_get_type(b));
+    EXPECT_EQ_SIZE_T(8, lept_binary_get_size(b));
+    EXPECT_EQ_INT(LEPT_NULL, lept_binary_get_type(lept_binary_get_object_value(b, 0)));
+    EXPECT_FALSE(lept_binary_get_boolean(lept_binary_get_object_value(b, 1)));
+    EXPECT_TRUE(lept_binary_get_boolean(lept_binary_get_object_value(b, 2)));
+    EXPECT_EQ_DOUBLE(123.0, lept_binary_get_number(lept_binary_find_object_value(b, "i", 1)));
+    e = lept_binary_find_object_value(b, "s", 1);
+    EXPECT_EQ_STRING("abc", lept_binary_get_string(e), lept_binary_get_string_length(e));
+    EXPECT_EQ_STRING("a", lept_binary_get_object_key(b, 5), lept_binary_get_object_key_length(b, 5));
+    e = lept_binary_get_object_value(b, 5);
+    EXPECT_EQ_SIZE_T(3, lept_binary_get_size(e));
+    for (i = 0; i < 3; i++)
+        EXPECT_EQ_DOUBLE(i + 1.0, lept_binary_get_number(lept_binary_get_element(e, i)));
+    EXPECT_EQ_DOUBLE(3.0, lept_binary_get_number(lept_binary_find_object_value(lept_binary_get_object_value(b, 6), "3", 1)));
+    e = lept_binary_find_object_value(b, "", 0);
+    EXPECT_EQ_SIZE_T(26, lept_binary_get_string_length(e));
+    EXPECT_EQ_INT('\0', lept_binary_get_string(e)[14]);
+    EXPECT_EQ_INT('\0', lept_binary_get_string(e)[26]);
+    EXPECT_TRUE(lept_binary_find_object_value(b, "x", 1) == NULL);
+
+    /* 截断在任何位置都能发现, 失败时 v 为 null */
+    for (i = 0; i < len; i++) {
+        lept_init(&v);
+        EXPECT_EQ_INT(LEPT_PARSE_INVALID_BINARY, lept_decode_binary(&v, data, i));
+        EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+    }
+    EXPECT_TRUE(lept_binary_root("LEPTBIN1\x07", 9) == NULL); //未知的类型
+    EXPECT_TRUE(lept_binary_root("LEPTBIN1\x00\x00", 10) == NULL); //根后面还有内容
+    EXPECT_TRUE(lept_binary_root("LEPTBIN0\x00", 9) == NULL);
+    EXPECT_TRUE(lept_binary_root("LEPTBIN1\x04\x02\x00\x00\x00" "ab", 15) == NULL); //缺少 '\0'
+    EXPECT_TRUE(lept_binary_root("LEPTBIN1\x03\x00\x00\x00\x00\x00\x00\xf0\x7f", 17) == NULL); //inf
+    EXPECT_TRUE(lept_binary_root("LEPTBIN1\x05\x01\x00\x00\x00\x0a\x00\x00\x00\x00", 18) == NULL); //偏移不对
+    EXPECT_TRUE(lept_binary_root("LEPTBIN1\x05\x01\x00\x00\x00\x09\x00\x00\x00\x00", 18) != NULL);
+    EXPECT_TRUE(lept_binary_root("LEPTBIN1\x05\xff\xff\xff\xff", 13) == NULL);
+
+    /* 解码到文档时长 key 同样驻留 */
+    lept_document_init(&d);
+    d.keys = lept_intern_table_new();
+    lept_free(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "{\"a rather long key\":null}"));
+    free(data);
+    EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_encode_binary(&v, &data, &len));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_document_decode_binary(&d, data, len));
+    EXPECT_TRUE(lept_get_object_key(&d.root, 0) == lept_intern(d.keys, "a rather long key", 17));
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_BINARY, lept_document_decode_binary(&d, data, len - 1));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&d.root));
+    lept_document_free(&d);
+    lept_intern_table_free(d.keys);
+    lept_free(&v);
+    free(data);
+}
+
+#ifndef _WIN32
+static void write_file(const char *path, const char *data, size_t len) {
+
+    FILE *fp = fopen(path, "wb");
+    fwrite(data, 1, len, fp);
+    fclose(fp);
+}
+
+static void test_parse_file() {
+
+    static const char path[] = "leptjson_test_file.json";
+    static const char json[] = "{\"a rather long key\":[1,\"a long string \\\"escaped\\\"\",\"short\",\"a long plain string\"],"
+                               "\"b\":true}";
+    lept_value v;
+    lept_document d;
+    const lept_value *a;
+    const char *s;
+    char *page;
+
+    write_file(path, json, sizeof(json) - 1);
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_file(&v, path));
+    EXPECT_EQ_STRING("a long string \"escaped\"",
+                     lept_get_string(lept_get_array_element(lept_get_object_value(&v, 0), 1)),
+                     lept_get_string_length(lept_get_array_element(lept_get_object_value(&v, 0), 1)));
+    lept_free(&v);
+
+    /* 文档: 没有转义的长字符串和 key 直接指向只读的映射, 带转义的在 arena 里, 映射不会被写 */
+    lept_document_init(&d);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_document_parse_file(&d, path));
+    EXPECT_TRUE(lept_get_object_key(&d.root, 0) == (const char *) d.map + 2);
+    a = lept_get_object_value(&d.root, 0);
+    s = lept_get_string(lept_get_array_element(a, 1));
+    EXPECT_EQ_STRING("a long string \"escaped\"", s, lept_get_string_length(lept_get_array_element(a, 1)));
+    EXPECT_TRUE(s < (const char *) d.map || s >= (const char *) d.map + d.map_size);
+    s = lept_get_string(lept_get_array_element(a, 3));
+    EXPECT_TRUE(s == (const char *) d.map + (strstr(json, "a long plain") - json));
+    EXPECT_EQ_STRING("a long plain string", s, lept_get_string_length(lept_get_array_element(a, 3)));
+    EXPECT_EQ_STRING("short", lept_get_string(lept_get_array_element(a, 2)), 5);
+    EXPECT_TRUE(memcmp(d.map, json, sizeof(json) - 1) == 0);
+    EXPECT_TRUE(lept_get_boolean(lept_find_object_value(&d.root, "b", 1)));
+    lept_document_free(&d);
+    EXPECT_TRUE(d.map == NULL);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_file(&v, path));
+    lept_free(&v);
+
+    /* 文件正好是整页, 最后一个字节后面没有 '\0' 也不能多读 */
+    page = (char *) malloc(4096);
+    memset(page, ' ', 4096);
+    page[0] = '[';
+    page[4095] = ']';
+    write_file(path, page, 4096);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_document_parse_file(&d, path));
+    EXPECT_EQ_INT(LEPT_ARRAY, lept_get_type(&d.root));
+    page[4095] = '1';
+    write_file(path, page, 4096);
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, lept_document_parse_file(&d, path));
+    page[0] = '"';
+    write_file(path, page, 4096);
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_QUOTATION_MARK, lept_parse_file(&v, path));
+    free(page);
+
+    write_file(path, "", 0);
+    EXPECT_EQ_INT(LEPT_PARSE_EXPECT_VALUE, lept_parse_file(&v, path));
+    EXPECT_EQ_INT(LEPT_PARSE_EXPECT_VALUE, lept_document_parse_file(&d, path));
+    lept_document_free(&d);
+    remove(path);
+
+    EXPECT_EQ_INT(LEPT_PARSE_FILE_ERROR, lept_parse_file(&v, path));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+    EXPECT_EQ_INT(LEPT_PARSE_FILE_ERROR, lept_document_parse_file(&d, "."));
+}
+#endif
+
+#ifdef LEPT_STATS
+static void test_parse_stats() {
+
+    static const char json[] = " [1, \"abc\", {\"k\": [true, null, 2.5]}, \"a string too long to be inlined\"] ";
+    const lept_stats *st = lept_get_stats();
+    lept_value v;
+    lept_document d;
+    char *out;
+    size_t len;
+
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json));
+    EXPECT_EQ_SIZE_T(sizeof(json) - 1, st->bytes);
+    EXPECT_EQ_SIZE_T(1, st->nodes[LEPT_NULL]);
+    EXPECT_EQ_SIZE_T(1, st->nodes[LEPT_TRUE]);
+    EXPECT_EQ_SIZE_T(2, st->nodes[LEPT_NUMBER]);
+    EXPECT_EQ_SIZE_T(2, st->nodes[LEPT_STRING]);
+    EXPECT_EQ_SIZE_T(2, st->nodes[LEPT_ARRAY]);
+    EXPECT_EQ_SIZE_T(1, st->nodes[LEPT_OBJECT]);
+    EXPECT_EQ_SIZE_T(3, st->max_depth);
+    EXPECT_EQ_SIZE_T(4, st->mallocs); //长字符串, 两个数组, 一个成员块
+    EXPECT_TRUE(st->stack_peak >= 4 * sizeof(lept_value));
+    EXPECT_TRUE(st->stack_growths >= 1 && st->reallocs == st->stack_growths);
+    EXPECT_TRUE(st->cycles >= st->string_cycles + st->number_cycles);
+
+    EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_stringify(&v, &out, &len));
+    EXPECT_EQ_SIZE_T(len, st->bytes);
+    EXPECT_EQ_SIZE_T(2, st->nodes[LEPT_NUMBER]);
+    EXPECT_EQ_SIZE_T(3, st->max_depth);
+    EXPECT_EQ_SIZE_T(1, st->mallocs);
+    free(out);
+    lept_free(&v);
+
+    /* 每次调用重新开始; 文档只在新建 chunk 时 malloc */
+    lept_document_init(&d);
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, lept_document_parse(&d, "[[1] 2]"));
+    EXPECT_EQ_SIZE_T(5, st->bytes); //停在 "2" 前面
+    EXPECT_EQ_SIZE_T(1, st->nodes[LEPT_ARRAY]);
+    EXPECT_EQ_SIZE_T(2, st->max_depth);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_document_parse(&d, json));
+    EXPECT_EQ_SIZE_T(1, st->mallocs);
+    lept_document_free(&d);
+}
+#endif
+
+/* 计数的分配器: live 是还没有释放的块数 */
+typedef struct {
+    size_t calls, live;
+} counting;
+
+static void *counting_malloc(void *user, size_t size) {
+
+    ((counting *) user)->calls++;
+    ((counting *) user)->live++;
+    return malloc(size);
+}
+
+static void *counting_realloc(void *user, void *p, size_t size) {
+
+    ((counting *) user)->calls++;
+    if (p == NULL)
+        ((counting *) user)->live++;
+    return realloc(p, size);
+}
+
+static void counting_free(void *user, void *p) {
+
+    ((counting *) user)->live--;
+    free(p);
+}
+
+static int discard_write(void *user, const char *data, size_t len) {
+
+    (void) user;
+    (void) data;
+    (void) len;
+    return 0;
+}
+
+static void test_parse_allocator() {
+
+    static const char json[] = "[1, \"a string too long to be inlined\", {\"a rather long key\": [true, null]}]";
+    counting n = { 0, 0 };
+    lept_allocator a = { counting_malloc, counting_realloc, counting_free, NULL };
+    lept_value v;
+    lept_document d;
+    char *out;
+    size_t len;
+    a.user = &n;
+
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_with(&v, json, sizeof(json) - 1, &a));
+    EXPECT_TRUE(n.calls >= 5); //栈, 两个数组, 长字符串, 长 key, 成员块
+    EXPECT_EQ_SIZE_T(5, n.live);
+    EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_stringify_with(&v, &out, &len, &a));
+    EXPECT_EQ_SIZE_T(6, n.live);
+    EXPECT_EQ_STRING("[1,\"a string too long to be inlined\",{\"a rather long key\":[true,null]}]", out, len);
+    counting_free(&n, out);
+    lept_free_with(&v, &a);
+    EXPECT_EQ_SIZE_T(0, n.live);
+
+    /* 修改也走同一个分配器: 旧的字符串交还给 a, 新的长字符串从 a 分配 */
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_with(&v, json, sizeof(json) - 1, &a));
+    n.calls = 0;
+    lept_set_string_with(lept_get_array_element(&v, 0), "another string too long to be inlined", 37, &a);
+    EXPECT_EQ_SIZE_T(1, n.calls);
+    EXPECT_EQ_SIZE_T(6, n.live);
+    lept_set_number_with(lept_get_array_element(&v, 1), 2.0, &a);
+    EXPECT_EQ_SIZE_T(5, n.live);
+    lept_set_boolean_with(lept_get_object_value(lept_get_array_element(&v, 2), 0), 0, &a);
+    EXPECT_EQ_SIZE_T(4, n.live); //外层数组, 新字符串, key, 成员块
+    lept_set_string_with(lept_get_array_element(&v, 0), "short", 5, &a);
+    EXPECT_EQ_SIZE_T(3, n.live);
+    n.calls = 0;
+    EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_stringify_to_with(&v, discard_write, NULL, &a));
+    EXPECT_EQ_SIZE_T(1, n.calls);
+    EXPECT_EQ_SIZE_T(3, n.live);
+    lept_free_with(&v, &a);
+    EXPECT_EQ_SIZE_T(0, n.live);
+
+    /* 出错时已经分配的部分也交还给同一个分配器 */
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, lept_parse_with(&v, "[\"a string too long to be inlined\" 1]", 37, &a));
+    EXPECT_EQ_SIZE_T(0, n.live);
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COLON, lept_parse_with(&v, "{\"a rather long key\" 1}", 23, &a));
+    EXPECT_EQ_SIZE_T(0, n.live);
+
+    /* 文档: chunk 和临时栈都走 arena 的分配器, 延迟展开也一样 */
+    n.calls = 0;
+    lept_document_init(&d);
+    d.arena.alloc = &a;
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_document_parse(&d, json));
+    EXPECT_TRUE(n.calls >= 2);
+    EXPECT_EQ_SIZE_T(1, n.live); //只剩一个 chunk
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_document_parse_lazy(&d, json, sizeof(json) - 1));
+    EXPECT_EQ_SIZE_T(2, lept_get_array_size(lept_find_object_value(lept_get_array_element(&d.root, 2),
+                                                                   "a rather long key", 17)));
+    EXPECT_EQ_SIZE_T(1, n.live);
+    lept_document_free(&d);
+    EXPECT_EQ_SIZE_T(0, n.live);
+}
+
+static void test_parse_workspace() {
+
+    lept_workspace *w = lept_workspace_new(16, 1024);
+    lept_value v;
+    lept_document d;
+    const char *out, *first;
+    char *big;
+    size_t len, i;
+
+    /* 反复使用同一个工作区, 结果和普通的调用一样 */
+    for (i = 0; i < 3; i++) {
+        lept_init(&v);
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_workspace_parse(w, &v, "[1,[\"abc\"],{\"k\":null}]", 22));
+        EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_workspace_stringify(w, &v, &out, &len));
+        EXPECT_EQ_STRING("[1,[\"abc\"],{\"k\":null}]", out, len);
+        EXPECT_EQ_INT('\0', out[len]);
+        if (i == 0)
+            first = out;
+        EXPECT_TRUE(out == first); //栈没有再增长, 缓冲区一直是同一块
+        lept_free(&v);
+    }
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, lept_workspace_parse(w, &v, "[1,[2", 5));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+
+    lept_document_init(&d);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_workspace_parse_document(w, &d, "{\"a\":[true,false]}", 18));
+    EXPECT_TRUE(lept_get_boolean(lept_get_array_element(lept_find_object_value(&d.root, "a", 1), 0)));
+    lept_document_free(&d);
+
+    /* 超过 shrink_size 的栈在下一次调用时缩回去; 在那之前结果仍然有效 */
+    big = (char *) malloc(4004);
+    big[0] = '[';
+    for (i = 0; i < 1000; i++)
+        memcpy(big + 1 + 4 * i, "[1],", 4);
+    big[4001] = '1';
+    big[4002] = ']';
+    big[4003] = '\0';
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_workspace_parse(w, &v, big, 4003));
+    EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_workspace_stringify(w, &v, &out, &len));
+    EXPECT_EQ_SIZE_T(4003, len);
+    EXPECT_TRUE(memcmp(big, out, len + 1) == 0);
+    lept_free(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_workspace_parse(w, &v, "[]", 2));
+    lept_free(&v);
+    free(big);
+    lept_workspace_free(w);
+
+    w = lept_workspace_new(0, 0);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_workspace_parse(w, &v, "\"x\"", 3));
+    lept_free(&v);
+    lept_workspace_free(w);
+    lept_workspace_free(NULL);
+}
+
+static void test_parse_document() {
+
+    lept_document d;
+    size_t i;
+
+    lept_document_init(&d);
+    d.arena.chunk_size = 64; //让小 chunk 和单独分配的大块都走到
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_document_parse(&d,
+                                                     " { "
+                                                             "\"n\" : null , "
+                                                             "\"s\" : \"abc\", "
+                                                             "\"l\" : \"a long string that does not fit into a small chunk\", "
+                                                             "\"a\" : [ 1, 2, 3 ],"
+                                                             "\"o\" : { \"1\" : 1, \"2\" : 2, \"3\" : 3 }"
+                                                             " } "
+    ));
+    EXPECT_EQ_INT(LEPT_OBJECT, lept_get_type(&d.root));
+    EXPECT_EQ_SIZE_T(5, lept_get_object_size(&d.root));
+    EXPECT_EQ_STRING("n", lept_get_object_key(&d.root, 0), lept_get_object_key_length(&d.root, 0));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(lept_get_object_value(&d.root, 0)));
+    EXPECT_EQ_STRING("abc", lept_get_string(lept_get_object_value(&d.root, 1)),
+                     lept_get_string_length(lept_get_object_value(&d.root, 1)));
+    EXPECT_EQ_STRING("a long string that does not fit into a small chunk",
+                     lept_get_string(lept_get_object_value(&d.root, 2)),
+                     lept_get_string_length(lept_get_object_value(&d.root, 2)));
+    for (i = 0; i < 3; i++) {
+        lept_value *e = lept_get_array_element(lept_get_object_value(&d.root, 3), i);
+        EXPECT_EQ_DOUBLE(i + 1.0, lept_get_number(e));
+    }
+    EXPECT_EQ_SIZE_T(3, lept_get_object_size(lept_get_object_value(&d.root, 4)));
+
+    //修改文档中的值: 自己分配的内存要在 lept_document_free 之前释放
+    lept_set_string(lept_get_object_value(&d.root, 1), "xyz", 3);
+    EXPECT_EQ_STRING("xyz", lept_get_string(lept_get_object_value(&d.root, 1)), 3);
+    lept_free(lept_get_object_value(&d.root, 1));
+
+    //同一个 document 可以重复解析, 出错时 root 为 null
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, lept_document_parse(&d, "[\"a\", [1, 2}"));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&d.root));
+    EXPECT_EQ_INT(LEPT_PARSE_ROOT_NOT_SINGULAR, lept_document_parse(&d, "[\"a\"] x"));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&d.root));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_document_parse(&d, "[\"a\"]"));
+    EXPECT_EQ_STRING("a", lept_get_string(lept_get_array_element(&d.root, 0)), 1);
+    lept_document_free(&d);
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&d.root));
+}
+
+static void test_parse_insitu() {
+
+    lept_value v;
+    char json[] = "{ \"k\\u0041\" : [ \"Hello\\nWorld\", \"\\uD834\\uDD1E\", \"\" ], \"plain\" : \"abc\" }";
+    char bad[] = "[ \"abc\", \"\\v\" ]";
+    lept_document d;
+
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_insitu(&v, json));
+    EXPECT_EQ_INT(LEPT_OBJECT, lept_get_type(&v));
+    EXPECT_EQ_SIZE_T(2, lept_get_object_size(&v));
+    EXPECT_EQ_STRING("kA", lept_get_object_key(&v, 0), lept_get_object_key_length(&v, 0));
+    {
+        lept_value *a = lept_get_object_value(&v, 0);
+        EXPECT_EQ_SIZE_T(3, lept_get_array_size(a));
+        EXPECT_EQ_STRING("Hello\nWorld", lept_get_string(lept_get_array_element(a, 0)),
+                         lept_get_string_length(lept_get_array_element(a, 0)));
+        EXPECT_EQ_STRING("\xF0\x9D\x84\x9E", lept_get_string(lept_get_array_element(a, 1)),
+                         lept_get_string_length(lept_get_array_element(a, 1)));
+        EXPECT_EQ_STRING("", lept_get_string(lept_get_array_element(a, 2)),
+                         lept_get_string_length(lept_get_array_element(a, 2)));
+    }
+    EXPECT_EQ_STRING("plain", lept_get_object_key(&v, 1), lept_get_object_key_length(&v, 1));
+    //字符串直接指向输入缓冲区
+    EXPECT_TRUE(lept_get_string(lept_get_object_value(&v, 1)) > json &&
+                lept_get_string(lept_get_object_value(&v, 1)) < json + sizeof(json));
+    EXPECT_EQ_STRING("abc", lept_get_string(lept_get_object_value(&v, 1)),
+                     lept_get_string_length(lept_get_object_value(&v, 1)));
+    lept_free(&v);
+
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_STRING_ESCAPE, lept_parse_insitu(&v, bad));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+
+    {
+        char json2[] = "{ \"a\" : [ \"x\\ty\" ] }";
+        lept_document_init(&d);
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_document_parse_insitu(&d, json2));
+        EXPECT_EQ_STRING("a", lept_get_object_key(&d.root, 0), lept_get_object_key_length(&d.root, 0));
+        EXPECT_EQ_STRING("x\ty", lept_get_string(lept_get_array_element(lept_get_object_value(&d.root, 0), 0)),
+                         lept_get_string_length(lept_get_array_element(lept_get_object_value(&d.root, 0), 0)));
+        lept_document_free(&d);
+    }
+}
+
+#define TEST_ERROR_N(error, json, len)\
+    do {\
+        lept_value v;\
+        lept_init(&v);\
+        EXPECT_EQ_INT(error, lept_parse_n(&v, json, len));\
+        EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));\
+        lept_free(&v);\
+    } while(0)
+
+static void test_parse_length() {
+
+    lept_value v;
+    lept_document d;
+
+    //只看前 len 个字节, 后面的内容不影响解析
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_n(&v, "[1, \"ab\"]garbage", 9));
+    EXPECT_EQ_SIZE_T(2, lept_get_array_size(&v));
+    EXPECT_EQ_STRING("ab", lept_get_string(lept_get_array_element(&v, 1)), 2);
+    lept_free(&v);
+
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_n(&v, "123456", 3));
+    EXPECT_EQ_DOUBLE(123.0, lept_get_number(&v));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_n(&v, "1.5e3999", 5));
+    EXPECT_EQ_DOUBLE(1500.0, lept_get_number(&v));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_n(&v, "truefalse", 4));
+    EXPECT_EQ_INT(LEPT_TRUE, lept_get_type(&v));
+
+    TEST_ERROR_N(LEPT_PARSE_EXPECT_VALUE, "null", 0);
+    TEST_ERROR_N(LEPT_PARSE_EXPECT_VALUE, "  null", 2);
+    TEST_ERROR_N(LEPT_PARSE_INVALID_VALUE, "true", 3);
+    TEST_ERROR_N(LEPT_PARSE_INVALID_VALUE, "1.5", 2);
+    TEST_ERROR_N(LEPT_PARSE_INVALID_VALUE, "1e5", 2);
+    TEST_ERROR_N(LEPT_PARSE_MISS_QUOTATION_MARK, "\"abc\"", 4);
+    TEST_ERROR_N(LEPT_PARSE_MISS_QUOTATION_MARK, "\"abc\\n\"", 5);
+    TEST_ERROR_N(LEPT_PARSE_INVALID_UNICODE_HEX, "\"\\u0041\"", 6);
+    TEST_ERROR_N(LEPT_PARSE_INVALID_UNICODE_SURROGATE, "\"\\uD834\\uDD1E\"", 8);
+    TEST_ERROR_N(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, "[1, 2]", 5);
+    TEST_ERROR_N(LEPT_PARSE_MISS_KEY, "{\"a\":1,\"b\":2}", 7);
+    TEST_ERROR_N(LEPT_PARSE_MISS_COLON, "{\"a\":1}", 4);
+    TEST_ERROR_N(LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":1}", 6);
+
+    //长度范围内的 '\0' 是非法字符
+    TEST_ERROR_N(LEPT_PARSE_ROOT_NOT_SINGULAR, "null\0", 5);
+    TEST_ERROR_N(LEPT_PARSE_INVALID_VALUE, "[1,\0]", 5);
+    TEST_ERROR_N(LEPT_PARSE_INVALID_STRING_CHAR, "\"a\0b\"", 5);
+    TEST_ERROR_N(LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":1\0}", 8);
+
+    lept_document_init(&d);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_document_parse_n(&d, "{\"a\":[]}{", 8));
+    EXPECT_EQ_SIZE_T(1, lept_get_object_size(&d.root));
+    lept_document_free(&d);
+}
+
+static void test_parse_long_string() {
+
+    //特殊字符出现在长字符串的各个位置上, 覆盖 SIMD 的各种块边界和尾部
+    static const char *specials[] = {"\\n", "\\\"", "\\u00e9", "\x01", NULL};
+    static const char *decoded[] = {"\n", "\"", "\xC3\xA9", NULL};
+    char json[128], expect[128], insitu[128];
+    lept_value v;
+    for (size_t k = 0; specials[k]; k++) {
+        for (size_t len = 0; len < 80; len += 3) {
+            for (size_t pos = 0; pos <= len; pos += 5) {
+                size_t n = 0, m = 0, i;
+                json[n++] = '"';
+                for (i = 0; i < len; i++) {
+                    if (i == pos) {
+                        n += sprintf(json + n, "%s", specials[k]);
+                        if (decoded[k])
+                            m += sprintf(expect + m, "%s", decoded[k]);
+                    }
+                    json[n++] = expect[m++] = (char) ('a' + i % 26);
+                }
+                json[n++] = '"';
+                expect[m] = '\0';
+                {
+                    //精确大小的缓冲区, 越界读能被 sanitizer 发现
+                    char *buf = (char *) malloc(n);
+                    memcpy(buf, json, n);
+                    lept_init(&v);
+                    if (decoded[k] || pos == len) {
+                        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_n(&v, buf, n));
+                        EXPECT_EQ_SIZE_T(m, lept_get_string_length(&v));
+                        EXPECT_TRUE(memcmp(expect, lept_get_string(&v), m) == 0);
+                    } else {
+                        EXPECT_EQ_INT(LEPT_PARSE_INVALID_STRING_CHAR, lept_parse_n(&v, buf, n));
+                    }
+                    lept_free(&v);
+                    if (decoded[k] || pos == len)
+                        EXPECT_EQ_INT(LEPT_PARSE_MISS_QUOTATION_MARK, lept_parse_n(&v, buf, n - 1));
+                    free(buf);
+                }
+                memcpy(insitu, json, n);
+                insitu[n] = '\0';
+                if (decoded[k] || pos == len) {
+                    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_insitu(&v, insitu));
+                    EXPECT_EQ_SIZE_T(m, lept_get_string_length(&v));
+                    EXPECT_TRUE(memcmp(expect, lept_get_string(&v), m) == 0);
+                    lept_free(&v);
+                }
+            }
+        }
+    }
+}
+
+static void test_parse_whitespace() {
+
+    //各种长度的空白, 覆盖 SIMD 的块边界和尾部
+    static const char ws[] = " \t\n\r";
+    char json[512];
+    lept_value v;
+    for (size_t len = 0; len < 100; len++) {
+        size_t n = 0, i, k;
+        for (k = 0; k < 3; k++) {
+            for (i = 0; i < len; i++)
+                json[n++] = ws[(i * 7 + k) % 4];
+            json[n++] = "[1]"[k];
+        }
+        for (i = 0; i < len; i++)
+            json[n++] = ' ';
+        {
+            char *buf = (char *) malloc(n);
+            memcpy(buf, json, n);
+            lept_init(&v);
+            EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_n(&v, buf, n));
+            EXPECT_EQ_SIZE_T(1, lept_get_array_size(&v));
+            EXPECT_EQ_DOUBLE(1.0, lept_get_number(lept_get_array_element(&v, 0)));
+            lept_free(&v);
+            //空白后面紧跟着非空白
+            buf[n - 1] = 'x';
+            if (len > 0)
+                EXPECT_EQ_INT(LEPT_PARSE_ROOT_NOT_SINGULAR, lept_parse_n(&v, buf, n));
+            free(buf);
+        }
+    }
+}
+
+/* SAX: 把事件记录成一个字符串, 方便比较 */
+typedef struct {
+    char buf[256];
+    size_t len;
+    int abort_after; //第几个事件返回非 0, 0 表示不停止
+    int count;
+} sax_recorder;
+
+static int sax_record(sax_recorder *r, const char *fmt, const char *s, size_t len) {
+
+    char tmp[64];
+    int n = sprintf(tmp, fmt, (int) len, s);
+    if (r->len + n < sizeof(r->buf)) {
+        memcpy(r->buf + r->len, tmp, n + 1);
+        r->len += n;
+    }
+    return ++r->count == r->abort_after;
+}
+
+static int sax_null(void *user) { return sax_record(user, "n ", "", 0); }
+static int sax_boolean(void *user, int b) { return sax_record(user, b ? "t " : "f ", "", 0); }
+static int sax_string(void *user, const char *s, size_t len) { return sax_record(user, "s:%.*s ", s, len); }
+static int sax_key(void *user, const char *s, size_t len) { return sax_record(user, "k:%.*s ", s, len); }
+static int sax_start_object(void *user) { return sax_record(user, "{ ", "", 0); }
+static int sax_start_array(void *user) { return sax_record(user, "[ ", "", 0); }
+
+static int sax_number(void *user, double n) {
+
+    char tmp[32];
+    sprintf(tmp, "%g", n);
+    return sax_record(user, "%.*s ", tmp, strlen(tmp));
+}
+
+static int sax_end_object(void *user, size_t size) {
+
+    char tmp[32];
+    sprintf(tmp, "}%u", (unsigned) size);
+    return sax_record(user, "%.*s ", tmp, strlen(tmp));
+}
+
+static int sax_end_array(void *user, size_t size) {
+
+    char tmp[32];
+    sprintf(tmp, "]%u", (unsigned) size);
+    return sax_record(user, "%.*s ", tmp, strlen(tmp));
+}
+
+static const lept_handler sax_handler = {
+    sax_null, sax_boolean, sax_number, sax_string, sax_key,
+    sax_start_object, sax_end_object, sax_start_array, sax_end_array
+};
+
+#define TEST_SAX(expect, json, stop, error)\
+    do {\
+        sax_recorder r;\
+        r.len = 0;\
+        r.buf[0] = '\0';\
+        r.count = 0;\
+        r.abort_after = stop;\
+        EXPECT_EQ_INT(error, lept_sax_parse(&sax_handler, &r, json));\
+        EXPECT_EQ_STRING(expect, r.buf, r.len);\
+    } while(0)
+
+static void test_parse_sax() {
+
+    lept_handler empty = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+
+    TEST_SAX("n ", " null ", 0, LEPT_PARSE_OK);
+    TEST_SAX("t ", "true", 0, LEPT_PARSE_OK);
+    TEST_SAX("-1.5 ", "-1.5", 0, LEPT_PARSE_OK);
+    TEST_SAX("s:abc ", "\"abc\"", 0, LEPT_PARSE_OK);
+    TEST_SAX("s:a\nb ", "\"a\\nb\"", 0, LEPT_PARSE_OK);
+    TEST_SAX("[ ]0 ", "[ ]", 0, LEPT_PARSE_OK);
+    TEST_SAX("{ }0 ", "{ }", 0, LEPT_PARSE_OK);
+    TEST_SAX("[ n f t 123 s:abc [ 1 2 ]2 ]6 ", "[ null , false , true , 123 , \"abc\", [ 1, 2 ] ]", 0, LEPT_PARSE_OK);
+    TEST_SAX("{ k:n n k:a [ 1 ]1 k:o { k:\\ s: }1 }3 ",
+             " { \"n\" : null , \"a\" : [ 1 ], \"o\" : { \"\\\\\" : \"\" } } ", 0, LEPT_PARSE_OK);
+
+    /* 回调返回非 0 时立即停止 */
+    TEST_SAX("[ n ", "[null, 1, 2]", 2, LEPT_PARSE_ABORTED);
+    TEST_SAX("{ k:a ", "{\"a\":1,\"b\":2}", 2, LEPT_PARSE_ABORTED);
+    TEST_SAX("[ 1 ]1 ", "[1]", 3, LEPT_PARSE_ABORTED);
+
+    /* 错误码和 lept_parse 一致, 出错之前的事件已经回调 */
+    TEST_SAX("", "", 0, LEPT_PARSE_EXPECT_VALUE);
+    TEST_SAX("n ", "null x", 0, LEPT_PARSE_ROOT_NOT_SINGULAR);
+    TEST_SAX("[ 1 ", "[1 2]", 0, LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET);
+    TEST_SAX("[ 1 ", "[1,]", 0, LEPT_PARSE_INVALID_VALUE);
+    TEST_SAX("{ ", "{1:1}", 0, LEPT_PARSE_MISS_KEY);
+    TEST_SAX("{ ", "{\"a", 0, LEPT_PARSE_MISS_KEY);
+    TEST_SAX("{ k:a ", "{\"a\" 1}", 0, LEPT_PARSE_MISS_COLON);
+    TEST_SAX("{ k:a 1 ", "{\"a\":1 ]", 0, LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET);
+    TEST_SAX("[ ", "[\"\\x\"]", 0, LEPT_PARSE_INVALID_STRING_ESCAPE);
+    TEST_SAX("", "1e309", 0, LEPT_PARSE_NUMBER_TOO_BIG);
+
+    /* 没有回调时只做验证 */
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_sax_parse(&empty, NULL, "{\"a\":[1,\"\\u00e9\",{}]}"));
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET, lept_sax_parse(&empty, NULL, "{\"a\":1"));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_sax_parse_n(&empty, NULL, "[1]]", 3));
+}
+
+/* 增量解析: 在每个位置切成两块, 以及逐字节输入, 结果和错误码都要和 lept_parse_n 一样 */
+static int push_parse(lept_push_parser *p, lept_value *v, const char *json, size_t len, size_t split, size_t step) {
+
+    int ret = lept_push_parse(p, json, split);
+    for (size_t i = split; i < len && (ret == LEPT_PARSE_OK || ret == LEPT_PARSE_NEED_MORE); i += step)
+        ret = lept_push_parse(p, json + i, i + step < len ? step : len - i);
+    ret = lept_push_finish(p, v);
+    return ret;
+}
+
+static void test_push(lept_push_parser *p, const char *json) {
+
+    lept_value expect, v;
+    char *s1 = NULL, *s2 = NULL;
+    size_t len = strlen(json), l1 = 0, l2 = 0, split;
+    int ret;
+
+    lept_init(&expect);
+    ret = lept_parse_n(&expect, json, len);
+    if (ret == LEPT_PARSE_OK)
+        lept_stringify(&expect, &s1, &l1);
+    for (split = 0; split <= len + 1; split++) {
+        if (split <= len)
+            EXPECT_EQ_INT(ret, push_parse(p, &v, json, len, split, len + 1));
+        else
+            EXPECT_EQ_INT(ret, push_parse(p, &v, json, len, 0, 1));
+        if (ret == LEPT_PARSE_OK) {
+            lept_stringify(&v, &s2, &l2);
+            EXPECT_EQ_SIZE_T(l1, l2);
+            EXPECT_TRUE(memcmp(s1, s2, l1) == 0);
+            free(s2);
+        } else {
+            EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+        }
+        lept_free(&v);
+    }
+    free(s1);
+    lept_free(&expect);
+}
+
+static void test_parse_push() {
+
+    static const char *const cases[] = {
+        "null", " true ", "false", "nul", "nulx", "truex", "[truex]",
+        "0", "-0.0", "123", " 1.5e-10 ", "-1E+2", "1e309", "01", "1.", "-", "1e", "[1.2e3,4]", "[1 2]",
+        "\"\"", "\"abc\"", " \"a\\nb\\\"c\\\\\" ", "\"\\u20AC\\uD834\\uDD1E\"", "\"\\u12\"", "\"\\x\"", "\"abc", "\"a\\",
+        "\"\x01\"", "\"long string with no escapes at all, long enough for the vector scanner...\"",
+        "[]", "[ ]", "{}", " { } ", "[", "[1", "[1,", "[1,]", "[,", "[\"a\"", "[1}", "[[[]]]", "[[1],[2,[3]]]",
+        "{\"a\"", "{\"a\":", "{\"a\":1", "{\"a\" 1}", "{1:1}", "{\"a\":1,}", "{\"a\":1]", "{\"a\":{\"b\":[{}]}}",
+        " { \"n\" : null , \"f\" : false , \"t\" : true , \"i\" : 123 , \"s\" : \"abc\", \"a\" : [ 1, 2, 3 ],"
+        "\"o\" : { \"1\" : 1, \"2\" : 2, \"3\" : 3 } } ",
+        "{\"k0\":0,\"k1\":1,\"k2\":2,\"k3\":3,\"k4\":4,\"k5\":5,\"k6\":6,\"k7\":7,\"k8\":8,\"k9\":9,"
+        "\"k10\":10,\"k11\":11,\"k12\":12,\"k13\":13,\"k14\":14,\"k15\":15,\"k16\":\"\\u00e9\"}",
+        "", " ", "null x", "[] []", "1 2", "\"a\" \"b\"", "\"a\"b", "?", "[?]", "{\"a\":?}"
+    };
+    lept_push_parser *p = lept_push_parser_new();
+    lept_value v;
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+        test_push(p, cases[i]);
+
+    /* 根值完整后返回 OK, 之后的空白不影响, 其他内容是 ROOT_NOT_SINGULAR 并且一直保持 */
+    EXPECT_EQ_INT(LEPT_PARSE_NEED_MORE, lept_push_parse(p, "[1,", 3));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_push_parse(p, "2] ", 3));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_push_parse(p, "  ", 2));
+    EXPECT_EQ_INT(LEPT_PARSE_ROOT_NOT_SINGULAR, lept_push_parse(p, " x", 2));
+    EXPECT_EQ_INT(LEPT_PARSE_ROOT_NOT_SINGULAR, lept_push_parse(p, "", 0));
+    EXPECT_EQ_INT(LEPT_PARSE_ROOT_NOT_SINGULAR, lept_push_finish(p, &v));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+
+    /* 没有 finish 就释放, 未完成的值也要释放 */
+    EXPECT_EQ_INT(LEPT_PARSE_NEED_MORE, lept_push_parse(p, "{\"a\":[\"x\",{\"b\":\"abc", 19));
+    lept_push_parser_free(p);
+}
+
+static void test_lazy(const char *json) {
+
+    lept_value expect;
+    lept_document d;
+    char *s1 = NULL, *s2 = NULL;
+    size_t len = strlen(json), l1 = 0, l2 = 0;
+    int ret;
+
+    lept_init(&expect);
+    ret = lept_parse_n(&expect, json, len);
+    lept_document_init(&d);
+    EXPECT_EQ_INT(ret, lept_document_parse_lazy(&d, json, len));
+    if (ret == LEPT_PARSE_OK) {
+        lept_stringify(&expect, &s1, &l1);
+        lept_stringify(&d.root, &s2, &l2); //整棵树都展开
+        EXPECT_EQ_SIZE_T(l1, l2);
+        EXPECT_TRUE(memcmp(s1, s2, l1) == 0);
+        free(s1);
+        free(s2);
+    } else {
+        EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&d.root));
+    }
+    lept_document_free(&d);
+    lept_free(&expect);
+}
+
+static void test_parse_lazy() {
+
+    static const char *const cases[] = {
+        "null", " true ", "false", "nul", "truex", "[truex]",
+        "0", "-0.0", "123", " 1.5e-10 ", "-1E+2", "1e309", "[1e309]", "[-1e-400]", "01", "1.", "-", "1e", "[1 2]",
+        "\"\"", " \"a\\nb\\\"c\\\\\" ", "\"\\u20AC\\uD834\\uDD1E\"", "[\"\\u12\"]", "[\"\\x\"]", "[\"abc",
+        "[\"\\uD834\"]", "[\"\x01\"]", "{\"\x01\":1}", "{\"a\\\":1}",
+        "[]", "[ ]", "{}", " { } ", "[", "[1", "[1,", "[1,]", "[,", "[1}", "[[[]]]", "[[1],[2,[3]]]", "[[1],[2,[3]]",
+        "{\"a\"", "{\"a\":", "{\"a\":1", "{\"a\" 1}", "{1:1}", "{\"a\":1,}", "{\"a\":1]", "{\"a\":{\"b\":[{}]}}",
+        " { \"n\" : null , \"f\" : false , \"t\" : true , \"i\" : 123 , \"s\" : \"abc\", \"a\" : [ 1, 2, 3 ],"
+        "\"o\" : { \"1\" : 1, \"2\" : [], \"3\" : { } }, \"e\" : [ [ ], { \"x\" : [ { } ] } ] } ",
+        "{\"k0\":0,\"k1\":1,\"k2\":2,\"k3\":3,\"k4\":4,\"k5\":5,\"k6\":6,\"k7\":7,\"k8\":8,\"k9\":9,"
+        "\"k10\":10,\"k11\":11,\"k12\":12,\"k13\":13,\"k14\":14,\"k15\":15,\"k16\":[\"\\u00e9\"]}",
+        "", " ", "null x", "[] []", "[] x", "{\"a\":[1]}}", "\"a\"b", "?", "[?]", "{\"a\":?}"
+    };
+    char big[400];
+    const char *json;
+    lept_document d;
+    lept_value *a, *o;
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+        test_lazy(cases[i]);
+
+    /* 没有指数时, 整数部分超过 308 位才可能溢出 */
+    memset(big, '9', 309);
+    big[309] = '\0';
+    test_lazy(big + 1);
+    test_lazy(big);
+    big[0] = '1';
+    memset(big + 1, '0', 308);
+    strcpy(big + 309, ".5");
+    test_lazy(big);
+
+    /* 只有访问到的容器才展开, 展开只有一层 */
+    lept_document_init(&d);
+    json = "[{\"a\":[1,2],\"b\":{\"c\":\"x\"}},[3],{}]";
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_document_parse_lazy(&d, json, strlen(json)));
+    EXPECT_TRUE(d.root.flags & LEPT_VALUE_LAZY);
+    EXPECT_EQ_SIZE_T(3, lept_get_array_size(&d.root));
+    EXPECT_TRUE(d.root.flags & LEPT_VALUE_LAZY);
+    o = lept_get_array_element(&d.root, 0);
+    EXPECT_FALSE(d.root.flags & LEPT_VALUE_LAZY);
+    EXPECT_EQ_INT(LEPT_OBJECT, lept_get_type(o));
+    EXPECT_EQ_SIZE_T(2, lept_get_object_size(o));
+    EXPECT_TRUE(o->flags & LEPT_VALUE_LAZY);
+    EXPECT_TRUE(lept_get_array_element(&d.root, 1)->flags & LEPT_VALUE_LAZY);
+    EXPECT_TRUE((a = lept_find_object_value(o, "b", 1)) != NULL);
+    EXPECT_TRUE(lept_get_object_value(o, 0)->flags & LEPT_VALUE_LAZY);
+    EXPECT_EQ_STRING("x", lept_get_string(lept_find_object_value(a, "c", 1)), 1);
+    EXPECT_EQ_DOUBLE(3.0, lept_get_number(lept_get_array_element(lept_get_array_element(&d.root, 1), 0)));
+    EXPECT_TRUE(lept_get_object_value(o, 0)->flags & LEPT_VALUE_LAZY);
+    EXPECT_EQ_SIZE_T(0, lept_get_object_size(lept_get_array_element(&d.root, 2)));
+    EXPECT_TRUE(lept_find_object_value(lept_get_array_element(&d.root, 2), "a", 1) == NULL);
+    lept_free(&d.root); //延迟的值没有分配过内存
+    lept_document_free(&d);
+}
+
+static void test_parse_ndjson() {
+
+    lept_batch b;
+    char *json = (char *) malloc(64 * 1024), *s1, *s2;
+    size_t len = 0, i, l1, l2;
+    unsigned threads;
+
+    lept_batch_init(&b);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ndjson(&b, "", 0, 0));
+    EXPECT_EQ_SIZE_T(0, b.count);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ndjson(&b, "\n \r\n\n", 5, 0));
+    EXPECT_EQ_SIZE_T(0, b.count);
+
+    /* 空行跳过, 行号从 1 开始, 最后一行可以没有 '\n', 支持 "\r\n" */
+    strcpy(json, "{\"a\":1}\r\n\n[1 2]\n \"x\" \ntrue");
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, lept_parse_ndjson(&b, json, strlen(json), 2));
+    EXPECT_EQ_SIZE_T(4, b.count);
+    EXPECT_EQ_SIZE_T(1, b.lines[0]);
+    EXPECT_EQ_SIZE_T(3, b.lines[1]);
+    EXPECT_EQ_SIZE_T(4, b.lines[2]);
+    EXPECT_EQ_SIZE_T(5, b.lines[3]);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, b.errors[0]);
+    EXPECT_EQ_INT(LEPT_OBJECT, lept_get_type(&b.values[0]));
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, b.errors[1]);
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&b.values[1]));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, b.errors[2]);
+    EXPECT_EQ_STRING("x", lept_get_string(&b.values[2]), lept_get_string_length(&b.values[2]));
+    EXPECT_EQ_INT(LEPT_TRUE, lept_get_type(&b.values[3]));
+    lept_batch_free(&b);
+
+    /* 多线程的结果和单线程一样, 并且保持输入顺序 */
+    for (i = 0; i < 3000; i++)
+        len += sprintf(json + len, i % 1000 == 999 ? "[%u}\n" : "{\"id\":%u}\n", (unsigned) i);
+    for (threads = 1; threads <= 8; threads *= 2) {
+        EXPECT_EQ_INT(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, lept_parse_ndjson(&b, json, len, threads));
+        EXPECT_EQ_SIZE_T(3000, b.count);
+        for (i = 0; i < b.count; i++) {
+            if (i % 1000 == 999) {
+                EXPECT_EQ_INT(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, b.errors[i]);
+                continue;
+            }
+            EXPECT_EQ_INT(LEPT_PARSE_OK, b.errors[i]);
+            EXPECT_EQ_SIZE_T(i + 1, b.lines[i]);
+            EXPECT_EQ_DOUBLE((double) i, lept_get_number(lept_get_object_value(&b.values[i], 0)));
+        }
+        if (threads == 1) {
+            lept_stringify(&b.values[1234], &s1, &l1);
+        } else {
+            lept_stringify(&b.values[1234], &s2, &l2);
+            EXPECT_EQ_SIZE_T(l1, l2);
+            EXPECT_TRUE(memcmp(s1, s2, l1) == 0);
+            free(s2);
+        }
+    }
+    free(s1);
+    lept_batch_free(&b);
+    free(json);
+}
+
+/* 并行解析: 结果和错误码都要和 lept_parse_n 一样 */
+static void test_parallel(const char *json, size_t len) {
+
+    lept_value expect, v;
+    char *s1, *s2;
+    size_t l1, l2;
+    int ret;
+
+    lept_init(&expect);
+    lept_init(&v);
+    ret = lept_parse_n(&expect, json, len);
+    EXPECT_EQ_INT(ret, lept_parse_parallel(&v, json, len, 4));
+    if (ret == LEPT_PARSE_OK) {
+        lept_stringify(&expect, &s1, &l1);
+        lept_stringify(&v, &s2, &l2);
+        EXPECT_EQ_SIZE_T(l1, l2);
+        EXPECT_TRUE(memcmp(s1, s2, l1) == 0);
+        free(s1);
+        free(s2);
+    } else {
+        EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+    }
+    lept_free(&expect);
+    lept_free(&v);
+}
+
+static void test_parse_parallel() {
+
+    /* 字符串里的引号, 反斜线, 括号和逗号不能被当成结构字符, 记录的长度不同使它们落在 64 字节块的各个位置 */
+    static const char *const records[] = {
+        "{\"id\":%u,\"s\":\"a,b]c}\",\"t\":[1,{\"u\":\"\\\\\"}]}",
+        "\"\\\\\\\"[{,\"",
+        "[%u, \"\\\\\\\\\", [], {}, [[\"]\"]]]",
+        "%u.5e-3",
+        "\"\\u00e9\\\\\"",
+        "null", "{}", "[ ]"
+    };
+    size_t cap = 1024 * 1024, len = 0, i, mid;
+    char *json = (char *) malloc(cap);
+
+    json[len++] = ' ';
+    json[len++] = '[';
+    for (i = 0; len < cap - 256; i++) {
+        len += sprintf(json + len, i ? ",\n  " : "\n  ");
+        len += sprintf(json + len, records[i % (sizeof(records) / sizeof(records[0]))], (unsigned) i);
+    }
+    len += sprintf(json + len, "\n] ");
+    test_parallel(json, len);
+
+    /* 出错的位置在中间的某个元素里, 或者在根数组之后 */
+    mid = len / 2;
+    while (json[mid] != ',')
+        mid++;
+    json[mid] = ' ';
+    test_parallel(json, len);
+    json[mid] = ',';
+    json[len - 1] = 'x';
+    test_parallel(json, len);
+    json[len - 1] = ' ';
+    test_parallel(json, len - 2);
+    json[len - 2] = '}'; //第一阶段不区分 ']' 和 '}', 根数组用哪个结束要另外检查
+    test_parallel(json, len);
+    json[len - 2] = ']';
+    json[mid + 3] = '"'; //未闭合的字符串会打乱第一阶段的字符串状态
+    test_parallel(json, len);
+
+    /* 空数组, 根不是数组, 以及小文档都退化为顺序解析 */
+    memset(json, ' ', cap);
+    json[0] = '[';
+    json[cap - 1] = ']';
+    test_parallel(json, cap);
+    json[cap - 1] = '}';
+    test_parallel(json, cap);
+    json[0] = '{';
+    json[cap - 1] = '}';
+    test_parallel(json, cap);
+    test_parallel("[1,2,3]", 7);
+    free(json);
+}
+
+/* depth 层只有一个元素的数组 (类型, 个数 1, 偏移 9), 最里面是 null */
+static char *binary_nested(size_t depth, size_t *len) {
+
+    char *data;
+    *len = 8 + 9 * depth + 1;
+    data = (char *) malloc(*len);
+    memcpy(data, "LEPTBIN1", 8);
+    for (size_t i = 0; i < depth; i++)
+        memcpy(data + 8 + 9 * i, "\x05\x01\x00\x00\x00\x09\x00\x00\x00", 9);
+    data[*len - 1] = '\0';
+    return data;
+}
+
+static void test_parse_binary_limits() {
+
+    lept_value v, big[2], a;
+    char *data, *json;
+    size_t len, i;
+
+    /* 加载时嵌套太深的编码当作格式不对, 恶意的深层嵌套不会把栈用完 */
+    data = binary_nested(LEPT_BINARY_MAX_DEPTH, &len);
+    EXPECT_TRUE(lept_binary_root(data, len) != NULL);
+    free(data);
+    data = binary_nested(LEPT_BINARY_MAX_DEPTH + 1, &len);
+    EXPECT_TRUE(lept_binary_root(data, len) == NULL);
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_BINARY, lept_decode_binary(&v, data, len));
+    free(data);
+    data = binary_nested(1000000, &len);
+    EXPECT_TRUE(lept_binary_root(data, len) == NULL);
+    free(data);
+
+    /* 编码时同样检查, 不写出加载不了的编码 */
+    json = (char *) malloc(2 * LEPT_BINARY_MAX_DEPTH + 3);
+    for (i = 0; i <= LEPT_BINARY_MAX_DEPTH; i++) {
+        json[i] = '[';
+        json[2 * LEPT_BINARY_MAX_DEPTH + 1 - i] = ']';
+    }
+    json[2 * LEPT_BINARY_MAX_DEPTH + 2] = '\0';
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json));
+    EXPECT_EQ_INT(LEPT_STRINGIFY_TOO_LARGE, lept_encode_binary(&v, &data, &len));
+    EXPECT_TRUE(data == NULL);
+    EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_encode_binary(lept_get_array_element(&v, 0), &data, &len));
+    EXPECT_TRUE(lept_binary_root(data, len) != NULL);
+    free(data);
+    lept_free(&v);
+    free(json);
+
+    /* 第二个元素的偏移超过 32 位: 在写之前只看长度, 字符串的内容不会被读到 */
+    for (i = 0; i < 2; i++) {
+        big[i].u.s = (char *) "";
+        big[i].size = UINT32_MAX;
+        big[i].flags = LEPT_VALUE_BORROWED;
+        big[i].type = LEPT_STRING;
+    }
+    a.u.e = big;
+    a.size = 2;
+    a.flags = LEPT_VALUE_BORROWED;
+    a.type = LEPT_ARRAY;
+    EXPECT_EQ_INT(LEPT_STRINGIFY_TOO_LARGE, lept_encode_binary(&a, &data, &len));
+    EXPECT_TRUE(data == NULL);
+}
 
 static void test_parse() {
 
@@ -421,6 +1757,7 @@ static void test_parse() {
     test_parse_invalid_value();
     test_parse_root_not_singular();
     test_parse_number();
+    test_parse_number_rounding();
     test_parse_number_too_big();
     test_parse_string();
     test_parse_missing_quotation_mark();
@@ -436,6 +1773,27 @@ static void test_parse() {
     test_parse_miss_colon();
     test_parse_miss_comma_or_curly_bracket();
 #endif
+    test_parse_document();
+    test_parse_insitu();
+    test_parse_length();
+    test_parse_long_string();
+    test_parse_whitespace();
+    test_parse_sax();
+    test_parse_push();
+    test_parse_lazy();
+    test_parse_intern();
+    test_parse_binary();
+    test_parse_binary_limits();
+    test_parse_allocator();
+    test_parse_workspace();
+#ifndef _WIN32
+    test_parse_file();
+#endif
+#ifdef LEPT_STATS
+    test_parse_stats();
+#endif
+    test_parse_ndjson();
+    test_parse_parallel();
 }
 
 static void test_access() {
@@ -444,6 +1802,9 @@ static void test_access() {
     test_access_boolean();
     test_access_number();
     test_access_string();
+    test_access_inline_string();
+    test_access_find_object();
+    test_access_pointer();
 }
 
 #define TEST_ROUNDTRIP(json)\
@@ -452,9 +1813,26 @@ static void test_access() {
         lept_init(&v);\
         char* json2;\
         size_t length;\
+        char buffer[sizeof(json)];\
         EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json));\
         EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_stringify(&v, &json2, &length));\
         EXPECT_EQ_STRING(json, json2, length);\
+        EXPECT_EQ_SIZE_T(sizeof(json) - 1, lept_stringify_length(&v));\
+        EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_stringify_buffer(&v, buffer, sizeof(json) - 1, &length));\
+        EXPECT_EQ_STRING(json, buffer, length);\
+        lept_free(&v);\
+        free(json2);\
+    } while(0)
+
+#define TEST_STRINGIFY_NUMBER(expect, json)\
+    do {\
+        lept_value v;\
+        lept_init(&v);\
+        char* json2;\
+        size_t length;\
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json));\
+        EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_stringify(&v, &json2, &length));\
+        EXPECT_EQ_STRING(expect, json2, length);\
         lept_free(&v);\
         free(json2);\
     } while(0)
@@ -473,14 +1851,34 @@ static void test_stringify_number() {
     TEST_ROUNDTRIP("1.234e-20");
 
     TEST_ROUNDTRIP("1.0000000000000002"); /* the smallest number > 1 */
-    TEST_ROUNDTRIP("4.9406564584124654e-324"); /* minimum denormal */
-    TEST_ROUNDTRIP("-4.9406564584124654e-324");
-    TEST_ROUNDTRIP("2.2250738585072009e-308");  /* Max subnormal double */
-    TEST_ROUNDTRIP("-2.2250738585072009e-308");
+    TEST_ROUNDTRIP("5e-324"); /* minimum denormal */
+    TEST_ROUNDTRIP("-5e-324");
+    TEST_ROUNDTRIP("2.225073858507201e-308");  /* Max subnormal double */
+    TEST_ROUNDTRIP("-2.225073858507201e-308");
     TEST_ROUNDTRIP("2.2250738585072014e-308");  /* Min normal positive double */
     TEST_ROUNDTRIP("-2.2250738585072014e-308");
     TEST_ROUNDTRIP("1.7976931348623157e+308");  /* Max double */
     TEST_ROUNDTRIP("-1.7976931348623157e+308");
+
+    /* 输出能 round-trip 的最短形式 */
+    TEST_ROUNDTRIP("0.1");
+    TEST_ROUNDTRIP("0.3");
+    TEST_ROUNDTRIP("0.0001");
+    TEST_ROUNDTRIP("1e-05");
+    TEST_ROUNDTRIP("123456789");
+    TEST_ROUNDTRIP("9007199254740992");
+    TEST_ROUNDTRIP("12345678901234568");
+    TEST_ROUNDTRIP("1e+17");
+    TEST_ROUNDTRIP("5e+22");
+    TEST_ROUNDTRIP("9.5e-05");
+    TEST_ROUNDTRIP("2.5e-310");
+    TEST_STRINGIFY_NUMBER("5e-324", "4.9406564584124654e-324");
+    TEST_STRINGIFY_NUMBER("2.225073858507201e-308", "2.2250738585072009e-308");
+    TEST_STRINGIFY_NUMBER("0.30000000000000004", "0.30000000000000004");
+    TEST_STRINGIFY_NUMBER("1e+21", "1000000000000000000000");
+    TEST_STRINGIFY_NUMBER("100", "1E2");
+    TEST_STRINGIFY_NUMBER("9007199254740992", "9007199254740993"); /* 2^53 + 1 rounds to 2^53 */
+    TEST_STRINGIFY_NUMBER("-0", "-0.0e5");
 }
 
 static void test_stringify_string() {
@@ -492,6 +1890,39 @@ static void test_stringify_string() {
     TEST_ROUNDTRIP("\"Hello\\u0000World\"");
 }
 
+/* 转义字符前后是不同长度的普通字符, 覆盖整块扫描的 8/16/32/64 字节边界 */
+static void test_stringify_string_runs() {
+
+    static const char special[] = {'"', '\\', '\n', '\x01', '\x1F'};
+    static const char *escaped[] = {"\\\"", "\\\\", "\\n", "\\u0001", "\\u001F"};
+    char s[200], expect[220];
+    for (size_t k = 0; k < sizeof(special); k++)
+        for (size_t before = 0; before < 70; before++) {
+            size_t after = 137 - before, n = 0, len = 0;
+            lept_value v;
+            char *json;
+            size_t length;
+            expect[n++] = '"';
+            for (size_t i = 0; i < before; i++)
+                s[len++] = expect[n++] = (char) ('a' + i % 26);
+            s[len++] = special[k];
+            memcpy(expect + n, escaped[k], strlen(escaped[k]));
+            n += strlen(escaped[k]);
+            for (size_t i = 0; i < after; i++)
+                s[len++] = expect[n++] = (char) ('A' + i % 26);
+            expect[n++] = '"';
+            expect[n] = '\0';
+            lept_init(&v);
+            lept_set_string(&v, s, len);
+            EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_stringify(&v, &json, &length));
+            EXPECT_EQ_SIZE_T(n, length);
+            EXPECT_TRUE(memcmp(expect, json, n) == 0);
+            EXPECT_EQ_SIZE_T(n, lept_stringify_length(&v));
+            free(json);
+            lept_free(&v);
+        }
+}
+
 static void test_stringify_array() {
 
     TEST_ROUNDTRIP("[]");
@@ -505,6 +1936,131 @@ static void test_stringify_object() {
             "{\"n\":null,\"f\":false,\"t\":true,\"i\":123,\"s\":\"abc\",\"a\":[1,2,3],\"o\":{\"1\":1,\"2\":2,\"3\":3}}");
 }
 
+/* 流式输出: 收集所有块, 和 lept_stringify 的结果比较 */
+typedef struct {
+    char *s;
+    size_t len, max_chunk;
+    int fail_after; //第几次写入时返回错误, 0 表示不出错
+    int writes;
+} stream_sink;
+
+static int stream_write(void *user, const char *data, size_t len) {
+
+    stream_sink *sink = (stream_sink *) user;
+    if (++sink->writes == sink->fail_after)
+        return -1;
+    sink->s = (char *) realloc(sink->s, sink->len + len);
+    memcpy(sink->s + sink->len, data, len);
+    sink->len += len;
+    if (len > sink->max_chunk)
+        sink->max_chunk = len;
+    return 0;
+}
+
+static void test_stringify_stream_value(const lept_value *v) {
+
+    stream_sink sink = { NULL, 0, 0, 0, 0 };
+    char *json;
+    size_t length;
+    EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_stringify(v, &json, &length));
+    EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_stringify_to(v, stream_write, &sink));
+    EXPECT_EQ_SIZE_T(length, sink.len);
+    EXPECT_TRUE(memcmp(json, sink.s, length) == 0);
+    EXPECT_TRUE(sink.max_chunk <= 80 * 1024); //缓冲区有上限
+    free(json);
+    free(sink.s);
+}
+
+static void test_stringify_stream() {
+
+    lept_value v;
+    stream_sink sink = { NULL, 0, 0, 2, 0 };
+    size_t len = 3 * 1024 * 1024, i;
+    char *s = (char *) malloc(len), *json;
+    FILE *fp;
+
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "{\"a\":[1,2.5,\"x\\ny\",null,true,false,{}],\"\":\"\"}"));
+    test_stringify_stream_value(&v);
+    lept_free(&v);
+
+    /* 很长的字符串分段转义 */
+    for (i = 0; i < len; i++)
+        s[i] = i % 97 == 0 ? '\n' : i % 89 == 0 ? '"' : (char) ('a' + i % 26);
+    lept_set_string(&v, s, len);
+    test_stringify_stream_value(&v);
+    lept_free(&v);
+
+    /* 很多小的值和深层嵌套 */
+    json = s;
+    len = 0;
+    json[len++] = '[';
+    for (i = 0; i < 200000; i++)
+        len += sprintf(json + len, "%u,", (unsigned) i);
+    for (i = 0; i < 5000; i++)
+        json[len++] = '[';
+    for (i = 0; i < 5000; i++)
+        json[len++] = ']';
+    json[len++] = ']';
+    json[len] = '\0';
+    len = 3 * 1024 * 1024;
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json));
+    test_stringify_stream_value(&v);
+
+    /* write 出错时停止 */
+    EXPECT_EQ_INT(LEPT_STRINGIFY_WRITE_ERROR, lept_stringify_to(&v, stream_write, &sink));
+    EXPECT_EQ_INT(2, sink.writes);
+    free(sink.s);
+
+    /* FILE* */
+    if ((fp = tmpfile()) != NULL) {
+        char *expect;
+        size_t length;
+        lept_stringify(&v, &expect, &length);
+        EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_stringify_file(&v, fp));
+        EXPECT_EQ_SIZE_T(length, (size_t) ftell(fp));
+        rewind(fp);
+        EXPECT_EQ_SIZE_T(length, fread(s, 1, len, fp));
+        EXPECT_TRUE(memcmp(expect, s, length) == 0);
+        fclose(fp);
+#ifndef _WIN32
+        if ((fp = tmpfile()) != NULL) {
+            EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_stringify_fd(&v, fileno(fp)));
+            fseek(fp, 0, SEEK_SET);
+            EXPECT_EQ_SIZE_T(length, fread(s, 1, len, fp));
+            EXPECT_TRUE(memcmp(expect, s, length) == 0);
+            fclose(fp);
+        }
+#endif
+        free(expect);
+    }
+    lept_free(&v);
+    free(s);
+}
+
+static void test_stringify_buffer() {
+
+    lept_value v;
+    char buffer[64];
+    size_t length = 0;
+
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "{\"a\\u0001\":[1.5,\"\\t\\\"\",null]}"));
+    EXPECT_EQ_SIZE_T(29, lept_stringify_length(&v));
+    memset(buffer, '#', sizeof(buffer));
+    EXPECT_EQ_INT(LEPT_STRINGIFY_BUFFER_TOO_SMALL, lept_stringify_buffer(&v, buffer, 28, &length));
+    EXPECT_EQ_SIZE_T(29, length);
+    EXPECT_EQ_INT('#', buffer[0]);
+    EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_stringify_buffer(&v, buffer, 29, &length));
+    EXPECT_EQ_STRING("{\"a\\u0001\":[1.5,\"\\t\\\"\",null]}", buffer, length);
+    EXPECT_EQ_INT('#', buffer[29]); //不写 '\0'
+    lept_free(&v);
+
+    EXPECT_EQ_INT(LEPT_STRINGIFY_BUFFER_TOO_SMALL, lept_stringify_buffer(&v, NULL, 0, &length));
+    EXPECT_EQ_SIZE_T(4, length);
+}
+
 static void test_stringify() {
 
     TEST_ROUNDTRIP("null");
@@ -512,8 +2068,11 @@ static void test_stringify() {
     TEST_ROUNDTRIP("true");
     test_stringify_number();
     test_stringify_string();
+    test_stringify_string_runs();
     test_stringify_array();
     test_stringify_object();
+    test_stringify_stream();
+    test_stringify_buffer();
 }
 
 int main() {